@@ -820,6 +820,99 @@ int mbedtls_mpi_mod_mpi( mbedtls_mpi *R, const mbedtls_mpi *A,
 int mbedtls_mpi_mod_int( mbedtls_mpi_uint *r, const mbedtls_mpi *A,
                          mbedtls_mpi_sint b );
 
+/**
+ * \brief          Modulus structure, holding the constants that speed up
+ *                 repeated reductions by the same modulus.
+ *
+ *                 With \c k the number of limbs of the modulus, \c mu is
+ *                 the Barrett constant floor( 2^(2 k biL) / N ) used by
+ *                 mbedtls_mpi_modulus_reduce(), and \c RR is the Montgomery
+ *                 constant 2^(2 k biL) mod N, which can be passed as the
+ *                 \c _RR argument of mbedtls_mpi_exp_mod() together with
+ *                 \c N.
+ */
+typedef struct mbedtls_mpi_modulus
+{
+    mbedtls_mpi N;      /*!<  The modulus                      */
+    mbedtls_mpi mu;     /*!<  Barrett constant                 */
+    mbedtls_mpi RR;     /*!<  Montgomery constant R^2 mod N    */
+}
+mbedtls_mpi_modulus;
+
+/**
+ * \brief          Initialize a modulus structure.
+ *
+ * \param M        The modulus structure to initialize. This must not
+ *                 be \c NULL.
+ */
+void mbedtls_mpi_modulus_init( mbedtls_mpi_modulus *M );
+
+/**
+ * \brief          Set up a modulus structure for a given modulus, and
+ *                 compute its constants.
+ *
+ *                 This costs about as much as one call to
+ *                 mbedtls_mpi_mod_mpi(), and is worth it as soon as the
+ *                 structure is used for a few reductions.
+ *
+ * \param M        The modulus structure to set up. This must be
+ *                 initialized.
+ * \param N        The modulus. This must be positive.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is not positive.
+ */
+int mbedtls_mpi_modulus_setup( mbedtls_mpi_modulus *M, const mbedtls_mpi *N );
+
+/**
+ * \brief          Free the components of a modulus structure.
+ *
+ * \param M        The modulus structure to free. This may be \c NULL,
+ *                 in which case this function is a no-op.
+ */
+void mbedtls_mpi_modulus_free( mbedtls_mpi_modulus *M );
+
+/**
+ * \brief          Perform a modular reduction with a set-up modulus
+ *                 structure: X = A mod N.
+ *
+ *                 This gives the same result as mbedtls_mpi_mod_mpi(),
+ *                 using Barrett reduction instead of a division for any
+ *                 \p A less than N^2 in absolute value. The final
+ *                 correction of the Barrett reduction takes a fixed number
+ *                 of steps, whatever the value of \p A.
+ *
+ * \param X        The destination MPI. This may alias \p A.
+ * \param A        The MPI to reduce. This may be negative.
+ * \param M        The modulus structure, set up by
+ *                 mbedtls_mpi_modulus_setup().
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         Another negative error code on different kinds of failure.
+ */
+int mbedtls_mpi_modulus_reduce( mbedtls_mpi *X, const mbedtls_mpi *A,
+                                const mbedtls_mpi_modulus *M );
+
+/**
+ * \brief          Perform a modular multiplication with a set-up modulus
+ *                 structure: X = A * B mod N.
+ *
+ * \param X        The destination MPI. This may alias \p A or \p B.
+ * \param A        The first factor.
+ * \param B        The second factor.
+ * \param M        The modulus structure, set up by
+ *                 mbedtls_mpi_modulus_setup().
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         Another negative error code on different kinds of failure.
+ */
+int mbedtls_mpi_modulus_mul( mbedtls_mpi *X, const mbedtls_mpi *A,
+                             const mbedtls_mpi *B,
+                             const mbedtls_mpi_modulus *M );
+
 /**
  * \brief          Perform a sliding-window exponentiation: X = A^E mod N
  *
@@ -904,6 +997,36 @@ int mbedtls_mpi_gcd( mbedtls_mpi *G, const mbedtls_mpi *A,
 int mbedtls_mpi_inv_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
                          const mbedtls_mpi *N );
 
+/**
+ * \brief          Compute the modular inverse modulo an odd number in
+ *                 constant time: X = A^-1 mod N
+ *
+ *                 This uses the Bernstein-Yang divstep algorithm. The
+ *                 sequence of operations only depends on the bit length
+ *                 of \p N, which makes this function suitable for secret
+ *                 values of \p A. It is also faster than
+ *                 mbedtls_mpi_inv_mod().
+ *
+ * \note           The computation is constant-time with respect to \p A
+ *                 only when `0 <= A < N`. Other values are first reduced
+ *                 modulo \p N with mbedtls_mpi_mod_mpi().
+ *
+ * \param X        The destination MPI. This must point to an initialized MPI.
+ * \param A        The MPI to calculate the modular inverse of. This must point
+ *                 to an initialized MPI.
+ * \param N        The base of the modular inversion. This must point to an
+ *                 initialized MPI and be odd.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is even, or less
+ *                 than or equal to one.
+ * \return         #MBEDTLS_ERR_MPI_NOT_ACCEPTABLE if \p A has no modular
+ *                 inverse with respect to \p N.
+ */
+int mbedtls_mpi_inv_mod_ct( mbedtls_mpi *X, const mbedtls_mpi *A,
+                            const mbedtls_mpi *N );
+
 #if !defined(MBEDTLS_DEPRECATED_REMOVED)
 #if defined(MBEDTLS_DEPRECATED_WARNING)
 #define MBEDTLS_DEPRECATED      __attribute__((deprecated))
@@ -99,6 +99,10 @@
 #error "MBEDTLS_ECDH_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_ED25519_C) && !defined(MBEDTLS_SHA512_C)
+#error "MBEDTLS_ED25519_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_ECDSA_C) &&            \
     ( !defined(MBEDTLS_ECP_C) ||           \
       !( defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED) || \
@@ -139,6 +143,16 @@
 #error "MBEDTLS_ECP_RESTARTABLE defined, but not MBEDTLS_ECDH_LEGACY_CONTEXT"
 #endif
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) )
+#error "MBEDTLS_ECP_SHARED_TABLES defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) )
+#error "MBEDTLS_ECP_PUBKEY_TABLES defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_ECDH_VARIANT_EVEREST_ENABLED)           && \
     defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
 #error "MBEDTLS_ECDH_VARIANT_EVEREST_ENABLED defined, but MBEDTLS_ECDH_LEGACY_CONTEXT not disabled"
@@ -629,6 +643,11 @@
 #error "MBEDTLS_RSA_C defined, but none of the PKCS1 versions enabled"
 #endif
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE) &&                         \
+    ( !defined(MBEDTLS_RSA_C) || MBEDTLS_RSA_BLINDING_POOL_SIZE < 1 )
+#error "MBEDTLS_RSA_BLINDING_POOL_SIZE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT) &&                        \
     ( !defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_PKCS1_V21) )
 #error "MBEDTLS_X509_RSASSA_PSS_SUPPORT defined, but not all prerequisites"
@@ -771,10 +790,33 @@
 #error "MBEDTLS_SSL_EXTENDED_MASTER_SECRET defined, but not all prerequsites"
 #endif
 
+#if defined(MBEDTLS_SSL_KTLS) && !defined(MBEDTLS_SSL_PROTO_TLS1_2)
+#error "MBEDTLS_SSL_KTLS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_C) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_CACHE_SHM_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_KEY_POOL_C) && !defined(MBEDTLS_ECP_C)
+#error "MBEDTLS_SSL_KEY_POOL_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_TICKET_C) && !defined(MBEDTLS_CIPHER_C)
 #error "MBEDTLS_SSL_TICKET_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_TICKET_MAX_KEYS) && \
+    MBEDTLS_SSL_TICKET_MAX_KEYS < 1
+#error "MBEDTLS_SSL_TICKET_MAX_KEYS must be at least 1"
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C) && \
+    defined(MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE) && \
+    MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE < 1
+#error "MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE must be at least 1"
+#endif
+
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING) && \
     !defined(MBEDTLS_SSL_PROTO_SSL3) && !defined(MBEDTLS_SSL_PROTO_TLS1)
 #error "MBEDTLS_SSL_CBC_RECORD_SPLITTING defined, but not all prerequisites"
@@ -799,6 +841,23 @@
 #define MBEDTLS_THREADING_IMPL
 #endif
 
+#if defined(MBEDTLS_THREADING_THREADS) && !defined(MBEDTLS_THREADING_IMPL)
+#error "MBEDTLS_THREADING_THREADS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_RSA_GEN_KEY_THREADS) &&                                   \
+    ( !defined(MBEDTLS_THREADING_THREADS) || !defined(MBEDTLS_RSA_C) ||       \
+      !defined(MBEDTLS_GENPRIME) || !defined(MBEDTLS_MD_C) ||                 \
+      !defined(MBEDTLS_SHA256_C) || MBEDTLS_RSA_GEN_KEY_THREADS < 1 )
+#error "MBEDTLS_RSA_GEN_KEY_THREADS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS) &&                                   \
+    ( !defined(MBEDTLS_THREADING_THREADS) || !defined(MBEDTLS_RSA_C) ||       \
+      defined(MBEDTLS_RSA_NO_CRT) )
+#error "MBEDTLS_RSA_PRIVATE_THREADS defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_THREADING_C) && !defined(MBEDTLS_THREADING_IMPL)
 #error "MBEDTLS_THREADING_C defined, single threading implementation required"
 #endif
@@ -889,6 +948,20 @@
 #error "MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_BUFFER_POOL defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_C) && defined(MBEDTLS_SSL_CACHE_SHARDS) && \
+    MBEDTLS_SSL_CACHE_SHARDS < 1
+#error "MBEDTLS_SSL_CACHE_SHARDS must be at least 1"
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_C) && \
+    defined(MBEDTLS_SSL_CACHE_SHM_MUTEXES) && MBEDTLS_SSL_CACHE_SHM_MUTEXES < 1
+#error "MBEDTLS_SSL_CACHE_SHM_MUTEXES must be at least 1"
+#endif
+
 /*
  * Avoid warning from -pedantic. This is a convenient place for this
  * workaround since this is included by every single file before the
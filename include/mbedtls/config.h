@@ -840,6 +840,63 @@
  */
 //#define MBEDTLS_ECP_RESTARTABLE
 
+/**
+ * \def MBEDTLS_ECP_SHARED_TABLES
+ *
+ * Share the pre-computed multiples of the base point between all groups.
+ *
+ * By default, each ::mbedtls_ecp_group computes its own table of multiples
+ * of the generator on the first fixed-point multiplication, so every ECDH or
+ * ECDSA context pays for that computation and holds its own copy of the
+ * table. When this option is enabled, the table for each built-in curve is
+ * computed once per process and all groups loaded with
+ * mbedtls_ecp_group_load() refer to it. The curve constants of built-in
+ * curves are already static, so groups then hold no per-context bignum data
+ * besides this reference.
+ *
+ * Shared tables live until mbedtls_ecp_shared_tables_free() is called.
+ * If MBEDTLS_THREADING_C is enabled, the tables are computed under a global
+ * mutex, so groups may be used concurrently from multiple threads.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * \note  This option only works with the default software implementation of
+ *        elliptic curve functionality. It is incompatible with
+ *        MBEDTLS_ECP_ALT.
+ *
+ * Uncomment this macro to share base point tables between groups.
+ */
+//#define MBEDTLS_ECP_SHARED_TABLES
+
+/**
+ * \def MBEDTLS_ECP_PUBKEY_TABLES
+ *
+ * Allow pre-computing multiples of long-lived public keys.
+ *
+ * ECDSA verification computes u1 * G + u2 * Q. Multiples of the base point G
+ * can be pre-computed once per group, but multiples of the public key Q are
+ * normally computed again for each signature. When this option is enabled,
+ * mbedtls_ecp_keypair_precompute() (or mbedtls_pk_precompute() for a PK
+ * context) stores a table of multiples of Q in the key pair, and
+ * verifications with that key then use both tables with a single shared
+ * chain of doublings, which is about twice as fast. This is most useful for
+ * trusted CA keys and other keys that verify many signatures.
+ *
+ * This adds two fields to ::mbedtls_ecp_keypair. Tables are only built on
+ * request, so keys that are not pre-computed don't use more memory.
+ * Verifications that go through PSA (MBEDTLS_USE_PSA_CRYPTO) don't use the
+ * tables.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * \note  This option only works with the default software implementation of
+ *        elliptic curve functionality. It is incompatible with
+ *        MBEDTLS_ECP_ALT.
+ *
+ * Uncomment this macro to allow pre-computing public key tables.
+ */
+//#define MBEDTLS_ECP_PUBKEY_TABLES
+
 /**
  * \def MBEDTLS_ECDH_LEGACY_CONTEXT
  *
@@ -1441,6 +1498,25 @@
  */
 //#define MBEDTLS_RSA_NO_CRT
 
+/**
+ * \def MBEDTLS_RSA_PRIVATE_THREADS
+ *
+ * Compute the two half-size exponentiations of the CRT RSA private
+ * operation on two threads, the calling thread and a worker started with
+ * mbedtls_thread_create(), before recombining them. This roughly halves
+ * the latency of an RSA private operation on an otherwise idle machine,
+ * at the cost of starting a thread for every operation. Blinding is
+ * applied as without this option.
+ *
+ * If the worker thread cannot be started, both exponentiations run on
+ * the calling thread.
+ *
+ * Requires: MBEDTLS_RSA_C, MBEDTLS_THREADING_THREADS, !MBEDTLS_RSA_NO_CRT
+ *
+ * Uncomment this macro to split RSA private operations across two threads.
+ */
+//#define MBEDTLS_RSA_PRIVATE_THREADS
+
 /**
  * \def MBEDTLS_SELF_TEST
  *
@@ -1960,6 +2036,24 @@
  */
 #define MBEDTLS_SSL_EXPORT_KEYS
 
+/**
+ * \def MBEDTLS_SSL_KTLS
+ *
+ * Enable handing the record protection of established TLS 1.2 connections
+ * using AES-GCM or ChaCha20-Poly1305 over to the Linux kernel (kTLS), with
+ * mbedtls_ssl_export_record_keys(), mbedtls_net_ktls_enable() and
+ * mbedtls_ssl_set_ktls(). The kernel then encrypts and decrypts the
+ * records, which lets the application use sendfile() on the socket.
+ *
+ * This keeps a copy of the traffic keys in each SSL transform. On platforms
+ * other than Linux, mbedtls_net_ktls_enable() always fails.
+ *
+ * Requires: MBEDTLS_SSL_PROTO_TLS1_2
+ *
+ * Uncomment this macro to enable kernel TLS offload.
+ */
+//#define MBEDTLS_SSL_KTLS
+
 /**
  * \def MBEDTLS_SSL_SERVER_NAME_INDICATION
  *
@@ -2014,6 +2108,20 @@
  */
 //#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
 
+/**
+ * \def MBEDTLS_SSL_BUFFER_POOL
+ *
+ * Enable mbedtls_ssl_conf_buffer_pool(): SSL contexts give their input and
+ * output buffers back to a shared pool whenever the connection is idle,
+ * and take them from the pool again when there is data to process. This
+ * cuts the memory used by a large number of mostly idle connections.
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * Uncomment this macro to enable the SSL buffer pool.
+ */
+//#define MBEDTLS_SSL_BUFFER_POOL
+
 /**
  * \def MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN
  *
@@ -2092,6 +2200,24 @@
  */
 //#define MBEDTLS_THREADING_PTHREAD
 
+/**
+ * \def MBEDTLS_THREADING_THREADS
+ *
+ * Let the library start worker threads through the threading layer, with
+ * mbedtls_thread_create() and mbedtls_thread_join(). Modules only do so
+ * when separately configured to, e.g. with MBEDTLS_RSA_GEN_KEY_THREADS, or
+ * asked to at run time, e.g. with mbedtls_ssl_key_pool_start_refill().
+ *
+ * With MBEDTLS_THREADING_ALT, you must also define the
+ * mbedtls_threading_thread_t type in threading_alt.h and call
+ * mbedtls_threading_set_thread_alt().
+ *
+ * Requires: MBEDTLS_THREADING_C
+ *
+ * Uncomment this to enable thread creation in the threading layer.
+ */
+//#define MBEDTLS_THREADING_THREADS
+
 /**
  * \def MBEDTLS_USE_PSA_CRYPTO
  *
@@ -2772,6 +2898,24 @@
  */
 #define MBEDTLS_ECP_C
 
+/**
+ * \def MBEDTLS_ED25519_C
+ *
+ * Enable the Ed25519 signature algorithm (RFC 8032).
+ *
+ * This module uses its own arithmetic on edwards25519 and does not depend
+ * on MBEDTLS_ECP_C. When MBEDTLS_PK_C is enabled, it also enables
+ * Ed25519 keys in the PK layer, Ed25519 signatures in X.509 certificates,
+ * CRLs and CSRs (RFC 8410), and the ed25519 signature algorithm in the
+ * TLS 1.2 signature_algorithms extension (RFC 8422).
+ *
+ * Module:  library/ed25519.c
+ * Caller:  library/pk_wrap.c
+ *
+ * Requires: MBEDTLS_SHA512_C
+ */
+#define MBEDTLS_ED25519_C
+
 /**
  * \def MBEDTLS_ENTROPY_C
  *
@@ -3305,6 +3449,22 @@
  */
 #define MBEDTLS_SSL_CACHE_C
 
+/**
+ * \def MBEDTLS_SSL_CACHE_SHM_C
+ *
+ * Enable an SSL session cache kept in a memory-mapped file, which the
+ * processes of a preforking server can share.
+ *
+ * Module:  library/ssl_cache_shm.c
+ * Caller:
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * This module only works on Unix, as it uses mmap() and fcntl() record
+ * locks.
+ */
+//#define MBEDTLS_SSL_CACHE_SHM_C
+
 /**
  * \def MBEDTLS_SSL_COOKIE_C
  *
@@ -3315,6 +3475,19 @@
  */
 #define MBEDTLS_SSL_COOKIE_C
 
+/**
+ * \def MBEDTLS_SSL_KEY_POOL_C
+ *
+ * Enable a pool of pre-generated ephemeral ECDHE key pairs, for servers to
+ * use with mbedtls_ssl_conf_ecdhe_key_cb().
+ *
+ * Module:  library/ssl_key_pool.c
+ * Caller:
+ *
+ * Requires: MBEDTLS_ECP_C
+ */
+#define MBEDTLS_SSL_KEY_POOL_C
+
 /**
  * \def MBEDTLS_SSL_TICKET_C
  *
@@ -3573,6 +3746,10 @@
 //#define MBEDTLS_ECP_WINDOW_SIZE            6 /**< Maximum window size used */
 //#define MBEDTLS_ECP_FIXED_POINT_OPTIM      1 /**< Enable fixed-point speed-up */
 
+/* RSA options */
+//#define MBEDTLS_RSA_GEN_KEY_THREADS        4 /**< Number of threads for mbedtls_rsa_gen_key(), requires MBEDTLS_THREADING_THREADS */
+//#define MBEDTLS_RSA_BLINDING_POOL_SIZE     4 /**< Number of blinding values mbedtls_rsa_blinding_refill() precomputes per context */
+
 /* Entropy options */
 //#define MBEDTLS_ENTROPY_MAX_SOURCES                20 /**< Maximum number of sources supported */
 //#define MBEDTLS_ENTROPY_MAX_GATHER                128 /**< Maximum amount requested from entropy sources */
@@ -3675,6 +3852,13 @@
 /* SSL Cache options */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT       86400 /**< 1 day  */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50 /**< Maximum entries in cache */
+//#define MBEDTLS_SSL_CACHE_SHARDS                    8 /**< Maximum number of independently locked shards */
+//#define MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT   86400 /**< 1 day  */
+//#define MBEDTLS_SSL_CACHE_SHM_MUTEXES           16 /**< Number of mutexes the sets of the shared cache are spread over */
+
+/* SSL Ticket options */
+//#define MBEDTLS_SSL_TICKET_MAX_KEYS                 4 /**< Maximum number of session ticket keys kept at once */
+//#define MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE         4 /**< Number of prepared cipher contexts kept per session ticket key */
 
 /* SSL options */
 
@@ -3817,6 +4001,13 @@
  */
 //#define MBEDTLS_SSL_DTLS_MAX_BUFFERING             32768
 
+/** \def MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE
+ *
+ * Default maximum number of unused record buffers kept by a buffer pool,
+ * see mbedtls_ssl_buffer_pool_set_max_free().
+ */
+//#define MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE   32
+
 //#define MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME     86400 /**< Lifetime of session tickets (if enabled) */
 //#define MBEDTLS_PSK_MAX_LEN               32 /**< Max size of TLS pre-shared keys, in bytes (default 256 bits) */
 //#define MBEDTLS_SSL_COOKIE_TIMEOUT        60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
@@ -284,6 +284,35 @@ int mbedtls_ecdh_make_params( mbedtls_ecdh_context *ctx, size_t *olen,
                       int (*f_rng)(void *, unsigned char *, size_t),
                       void *p_rng );
 
+/**
+ * \brief           This function exports the EC key pair already held by
+ *                  the context in the format used in a TLS
+ *                  ServerKeyExchange handshake message.
+ *
+ *                  This is an alternative to mbedtls_ecdh_make_params() for
+ *                  a server that draws its ephemeral key pair from a pool
+ *                  of pre-generated keys: the key pair is imported with
+ *                  mbedtls_ecdh_get_params() and #MBEDTLS_ECDH_OURS, then
+ *                  exported with this function.
+ *
+ * \see             ecp.h
+ *
+ * \param ctx       The ECDH context to use. This must be initialized
+ *                  and hold our key pair.
+ * \param olen      The address at which to store the number of Bytes written.
+ * \param buf       The destination buffer. This must be a writable buffer of
+ *                  length \p blen Bytes.
+ * \param blen      The length of the destination buffer \p buf in Bytes.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if the context uses
+ *                  an ECDH implementation that does not support importing
+ *                  a key pair.
+ * \return          Another \c MBEDTLS_ERR_ECP_XXX error code on failure.
+ */
+int mbedtls_ecdh_write_params( mbedtls_ecdh_context *ctx, size_t *olen,
+                               unsigned char *buf, size_t blen );
+
 /**
  * \brief           This function parses the ECDHE parameters in a
  *                  TLS ServerKeyExchange handshake message.
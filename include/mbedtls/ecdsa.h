@@ -319,6 +319,69 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
                           const mbedtls_ecp_point *Q, const mbedtls_mpi *r,
                           const mbedtls_mpi *s);
 
+/**
+ * \brief           A signature to verify with mbedtls_ecdsa_verify_batch().
+ */
+typedef struct mbedtls_ecdsa_batch_entry
+{
+    const unsigned char *buf;   /*!< The hashed content that was signed. */
+    size_t blen;                /*!< The length of \c buf in Bytes. */
+    const mbedtls_ecp_point *Q; /*!< The public key to use for verification. */
+    const mbedtls_mpi *r;       /*!< The first integer of the signature. */
+    const mbedtls_mpi *s;       /*!< The second integer of the signature. */
+    int ret;                    /*!< Output: the result of verifying this
+                                     signature, as mbedtls_ecdsa_verify()
+                                     would return it. */
+}
+mbedtls_ecdsa_batch_entry;
+
+/**
+ * \brief           This function verifies many ECDSA signatures of
+ *                  previously-hashed messages at once.
+ *
+ *                  Signatures are checked in groups of up to
+ *                  #MBEDTLS_ECP_BATCH_MAX_SIZE with a random linear
+ *                  combination of their verification equations, which
+ *                  shares the scalar multiplications by the base point and
+ *                  the doublings between all the signatures of a group, and
+ *                  needs a single modular inversion. If a group fails, each
+ *                  of its signatures is verified individually to find out
+ *                  which ones are invalid.
+ *
+ * \note            The signatures may use different public keys, but they
+ *                  must all belong to \p grp.
+ *
+ * \note            Batch verification needs curves whose prime is congruent
+ *                  to 3 modulo 4, such as the NIST, Brainpool and Koblitz
+ *                  curves except secp224r1 and secp224k1. On other curves,
+ *                  the signatures are verified individually.
+ *
+ * \see             mbedtls_ecdsa_verify()
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param entries   The signatures to verify. On return, the \c ret field of
+ *                  each entry holds the result for that signature.
+ * \param count     The number of entries.
+ * \param f_rng     The RNG function used to generate the random
+ *                  coefficients of the linear combinations. This must not
+ *                  be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context.
+ *
+ * \return          \c 0 if all signatures are valid.
+ * \return          The \c ret field of the first entry that failed
+ *                  otherwise, typically #MBEDTLS_ERR_ECP_VERIFY_FAILED.
+ *                  If \p grp cannot be used for ECDSA, every entry gets
+ *                  #MBEDTLS_ERR_ECP_BAD_INPUT_DATA.
+ */
+int mbedtls_ecdsa_verify_batch( mbedtls_ecp_group *grp,
+                                mbedtls_ecdsa_batch_entry *entries,
+                                size_t count,
+                                int (*f_rng)(void *, unsigned char *, size_t),
+                                void *p_rng );
+
 /**
  * \brief           This function computes the ECDSA signature and writes it
  *                  to a buffer, serialized as defined in <em>RFC-4492:
@@ -232,7 +232,9 @@ typedef struct mbedtls_ecp_group
     int (*t_pre)(mbedtls_ecp_point *, void *);  /*!< Unused. */
     int (*t_post)(mbedtls_ecp_point *, void *); /*!< Unused. */
     void *t_data;               /*!< Unused. */
-    mbedtls_ecp_point *T;       /*!< Pre-computed points for ecp_mul_comb(). */
+    mbedtls_ecp_point *T;       /*!< Pre-computed points for ecp_mul_comb().
+                                     With #MBEDTLS_ECP_SHARED_TABLES, this
+                                     may refer to a process-wide table. */
     size_t T_size;              /*!< The number of pre-computed points. */
 }
 mbedtls_ecp_group;
@@ -376,6 +378,11 @@ typedef struct mbedtls_ecp_keypair
     mbedtls_ecp_group grp;      /*!<  Elliptic curve and base point     */
     mbedtls_mpi d;              /*!<  our secret value                  */
     mbedtls_ecp_point Q;        /*!<  our public value                  */
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    mbedtls_ecp_point *T;       /*!<  pre-computed multiples of \c Q, see
+                                      mbedtls_ecp_keypair_precompute()  */
+    size_t T_size;              /*!<  the number of pre-computed points */
+#endif
 }
 mbedtls_ecp_keypair;
 
@@ -578,6 +585,22 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp );
  */
 void mbedtls_ecp_keypair_free( mbedtls_ecp_keypair *key );
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+/**
+ * \brief           This function frees the process-wide tables of
+ *                  pre-computed base point multiples.
+ *
+ * \note            This is only needed to release memory before the
+ *                  process exits, for example to keep leak checkers quiet.
+ *                  Tables are computed again on demand afterwards.
+ *
+ * \warning         This function must only be called when no ECP group
+ *                  that has been used for a multiplication is still in use,
+ *                  since such groups may refer to the shared tables.
+ */
+void mbedtls_ecp_shared_tables_free( void );
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
 /**
  * \brief           Initialize a restart context.
@@ -1023,6 +1046,137 @@ int mbedtls_ecp_muladd_restartable(
              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
              const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
              mbedtls_ecp_restart_ctx *rs_ctx );
+
+/** The maximum number of points given by their x coordinate
+ *  in mbedtls_ecp_muladd_batch_check(). */
+#define MBEDTLS_ECP_BATCH_MAX_SIZE  8
+
+/**
+ * \brief           This function checks whether the linear combination
+ *                  sum( \p k[i] * \p P[i] ) is equal to
+ *                  sum( +/- \p a[j] * R[j] ) for some choice of signs,
+ *                  where R[j] is a point with x coordinate \p x[j].
+ *
+ *                  This is the core of batch verification of ECDSA
+ *                  signatures, where only the x coordinate of the point R
+ *                  of each signature is known: with random \p a[j], the
+ *                  relation holds for the sum of the verification equations
+ *                  of all signatures only if each of them holds, with
+ *                  overwhelming probability.
+ *
+ * \note            The sum over \p P is computed with a single
+ *                  multi-scalar multiplication, so it costs little more
+ *                  than one scalar multiplication per point. The search
+ *                  over signs costs 2^( \p x_count - 1 ) point additions.
+ *
+ * \note            This function is NOT constant-time and must only be
+ *                  used with public data.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *                  It may not be included in builds without any short
+ *                  Weierstrass curve.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param count     The number of points \p P, which may be \c 0.
+ * \param k         The integers by which to multiply the points \p P.
+ *                  They may be negative or larger than \c N.
+ * \param P         The points to multiply. They must be valid public keys.
+ * \param x_count   The number of points given by their x coordinate,
+ *                  between \c 1 and #MBEDTLS_ECP_BATCH_MAX_SIZE.
+ * \param a         The positive integers by which to multiply the points
+ *                  given by \p x. They are meant to be small random values.
+ * \param x         The x coordinates of the points R[j].
+ *
+ * \return          \c 0 if the relation holds.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if it doesn't, or if a
+ *                  value in \p x is not the x coordinate of a point.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if a point in \p P is not a
+ *                  valid public key.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp does not
+ *                  designate a short Weierstrass curve whose prime is
+ *                  congruent to 3 modulo 4.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p x_count is out of
+ *                  range.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_muladd_batch_check( mbedtls_ecp_group *grp,
+                                    size_t count,
+                                    const mbedtls_mpi * const k[],
+                                    const mbedtls_ecp_point * const P[],
+                                    size_t x_count,
+                                    const mbedtls_mpi * const a[],
+                                    const mbedtls_mpi * const x[] );
+
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+/**
+ * \brief           This function pre-computes multiples of the public key
+ *                  of a key pair, in order to speed up the verification of
+ *                  many signatures made with the same key.
+ *
+ *                  The table is kept in \p key and used automatically by
+ *                  mbedtls_ecp_keypair_muladd(), hence by ECDSA verification
+ *                  with mbedtls_ecdsa_read_signature() and everything built
+ *                  on it, such as X.509 certificate verification.
+ *                  The multiples of the base point are also pre-computed in
+ *                  \c key->grp if they weren't already.
+ *
+ * \note            This is worth it for long-lived keys that verify many
+ *                  signatures, such as trusted CA keys: the table costs
+ *                  about as much as one verification to build, and takes
+ *                  the same amount of memory as the base point table.
+ *
+ * \note            If \c key->Q or \c key->grp are changed afterwards, the
+ *                  table is ignored until this function is called again.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *
+ * \param key       The key pair to use. This must be initialized and hold
+ *                  a valid public key.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \c key->Q is not a valid
+ *                  public key.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \c key->grp does
+ *                  not designate a short Weierstrass curve.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED on memory-allocation failure.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_keypair_precompute( mbedtls_ecp_keypair *key );
+
+/**
+ * \brief           This function computes \p R = \p m * \c G + \p n * \c Q,
+ *                  where \c G is the base point of \c key->grp and \c Q is
+ *                  the public key \c key->Q.
+ *
+ *                  If a table was pre-computed for \p key with
+ *                  mbedtls_ecp_keypair_precompute(), it is used. Otherwise,
+ *                  this is equivalent to mbedtls_ecp_muladd().
+ *
+ * \note            This function is intended for signature verification:
+ *                  it is NOT constant-time and must not be used with
+ *                  secret scalars.
+ *
+ * \param key       The key pair to use. This must be initialized.
+ * \param R         The point in which to store the result of the calculation.
+ *                  This must be initialized.
+ * \param m         The integer by which to multiply \c G.
+ *                  This must be initialized.
+ * \param n         The integer by which to multiply \c Q.
+ *                  This must be initialized.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p m or \p n are not
+ *                  valid private keys, or \c key->Q is not a valid public key.
+ * \return          #MBEDTLS_ERR_MPI_ALLOC_FAILED on memory-allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \c key->grp does
+ *                  not designate a short Weierstrass curve.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_keypair_muladd( mbedtls_ecp_keypair *key, mbedtls_ecp_point *R,
+                                const mbedtls_mpi *m, const mbedtls_mpi *n );
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 /**
@@ -0,0 +1,220 @@
+/**
+ * \file ed25519.h
+ *
+ * \brief This file contains Ed25519 definitions and functions.
+ *
+ * Ed25519 is the Edwards-curve Digital Signature Algorithm (EdDSA) over
+ * edwards25519, the twisted Edwards curve that is birationally equivalent
+ * to Curve25519. It is defined in <em>RFC-8032: Edwards-Curve Digital
+ * Signature Algorithm (EdDSA)</em>. Its use in X.509 certificates is
+ * defined in <em>RFC-8410</em> and its use in TLS 1.2 in <em>RFC-8422</em>.
+ *
+ * This module implements the pure variant of Ed25519 (no context, no
+ * prehash) on its own field and group arithmetic, independently of the
+ * generic elliptic curve code in ecp.h.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef MBEDTLS_ED25519_H
+#define MBEDTLS_ED25519_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+/* Ed25519 shares its error codes with the ECP module, as ECDSA does. */
+#include "mbedtls/ecp.h"
+
+#include <stddef.h>
+
+/** The size of an Ed25519 public key in Bytes. */
+#define MBEDTLS_ED25519_KEY_SIZE        32
+/** The size of an Ed25519 private key (seed) in Bytes. */
+#define MBEDTLS_ED25519_SEED_SIZE       32
+/** The size of an Ed25519 signature in Bytes. */
+#define MBEDTLS_ED25519_SIG_SIZE        64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief           The Ed25519 context structure.
+ *
+ *                  A context holds either a public key only, or a private
+ *                  key together with the public key derived from it.
+ */
+typedef struct mbedtls_ed25519_context
+{
+    unsigned char pub[MBEDTLS_ED25519_KEY_SIZE];    /*!< The encoded public key A. */
+    unsigned char seed[MBEDTLS_ED25519_SEED_SIZE];  /*!< The private key, if any. */
+    int has_pub;                                    /*!< Whether \c pub is set. */
+    int has_priv;                                   /*!< Whether \c seed is set. */
+}
+mbedtls_ed25519_context;
+
+/**
+ * \brief           This function initializes an Ed25519 context.
+ *
+ * \param ctx       The context to initialize. This must not be \c NULL.
+ */
+void mbedtls_ed25519_init( mbedtls_ed25519_context *ctx );
+
+/**
+ * \brief           This function frees an Ed25519 context and wipes the
+ *                  private key it may hold.
+ *
+ * \param ctx       The context to free. This may be \c NULL, in which
+ *                  case this function does nothing.
+ */
+void mbedtls_ed25519_free( mbedtls_ed25519_context *ctx );
+
+/**
+ * \brief           This function generates an Ed25519 key pair.
+ *
+ * \param ctx       The context to store the key pair in. This must be
+ *                  initialized.
+ * \param f_rng     The RNG function used to draw the private key. This
+ *                  must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_RANDOM_FAILED if \p f_rng failed.
+ * \return          Another \c MBEDTLS_ERR_SHA512_XXX error code on failure.
+ */
+int mbedtls_ed25519_genkey( mbedtls_ed25519_context *ctx,
+                            int (*f_rng)(void *, unsigned char *, size_t),
+                            void *p_rng );
+
+/**
+ * \brief           This function sets the private key of a context and
+ *                  derives the matching public key.
+ *
+ * \param ctx       The context to use. This must be initialized.
+ * \param seed      The 32-Byte private key, as encoded in RFC 8032.
+ * \param seed_len  The length of \p seed in Bytes. This must be
+ *                  #MBEDTLS_ED25519_SEED_SIZE.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p seed_len is wrong.
+ * \return          Another \c MBEDTLS_ERR_SHA512_XXX error code on failure.
+ */
+int mbedtls_ed25519_set_private_key( mbedtls_ed25519_context *ctx,
+                                     const unsigned char *seed,
+                                     size_t seed_len );
+
+/**
+ * \brief           This function sets the public key of a context. Any
+ *                  private key it held is wiped.
+ *
+ * \param ctx       The context to use. This must be initialized.
+ * \param pub       The 32-Byte encoded public key.
+ * \param pub_len   The length of \p pub in Bytes.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p pub_len is wrong or
+ *                  \p pub does not encode a point of the curve.
+ */
+int mbedtls_ed25519_set_public_key( mbedtls_ed25519_context *ctx,
+                                    const unsigned char *pub,
+                                    size_t pub_len );
+
+/**
+ * \brief           This function checks that the public key of \p pub
+ *                  matches the private key of \p prv.
+ *
+ * \param pub       The context holding the public key.
+ * \param prv       The context holding the private key.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if the keys don't match.
+ */
+int mbedtls_ed25519_check_pub_priv( const mbedtls_ed25519_context *pub,
+                                    const mbedtls_ed25519_context *prv );
+
+/**
+ * \brief           This function computes the Ed25519 signature of a
+ *                  message.
+ *
+ *                  EdDSA signs the message itself rather than a hash of
+ *                  it, and the signature is deterministic: it does not
+ *                  need an RNG.
+ *
+ * \param ctx       The context holding the private key.
+ * \param msg       The message to sign. This may be \c NULL if
+ *                  \p msg_len is zero.
+ * \param msg_len   The length of \p msg in Bytes.
+ * \param sig       The buffer to write the #MBEDTLS_ED25519_SIG_SIZE
+ *                  Bytes of the signature to.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p ctx has no
+ *                  private key.
+ * \return          Another \c MBEDTLS_ERR_SHA512_XXX error code on failure.
+ */
+int mbedtls_ed25519_sign( const mbedtls_ed25519_context *ctx,
+                          const unsigned char *msg, size_t msg_len,
+                          unsigned char sig[MBEDTLS_ED25519_SIG_SIZE] );
+
+/**
+ * \brief           This function verifies the Ed25519 signature of a
+ *                  message.
+ *
+ *                  This function runs in variable time: it must only be
+ *                  given public data.
+ *
+ * \param ctx       The context holding the public key.
+ * \param msg       The signed message. This may be \c NULL if \p msg_len
+ *                  is zero.
+ * \param msg_len   The length of \p msg in Bytes.
+ * \param sig       The signature to verify.
+ * \param sig_len   The length of \p sig in Bytes.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if the signature is
+ *                  invalid.
+ * \return          #MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH if \p sig_len is
+ *                  larger than #MBEDTLS_ED25519_SIG_SIZE.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p ctx has no
+ *                  public key.
+ * \return          Another \c MBEDTLS_ERR_SHA512_XXX error code on failure.
+ */
+int mbedtls_ed25519_verify( const mbedtls_ed25519_context *ctx,
+                            const unsigned char *msg, size_t msg_len,
+                            const unsigned char *sig, size_t sig_len );
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/**
+ * \brief           The Ed25519 checkup routine.
+ *
+ * \return          \c 0 on success.
+ * \return          \c 1 on failure.
+ */
+int mbedtls_ed25519_self_test( int verbose );
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ed25519.h */
@@ -62,6 +62,7 @@
 #define MBEDTLS_ERR_NET_INVALID_CONTEXT                   -0x0045  /**< The context is invalid, eg because it was free()ed. */
 #define MBEDTLS_ERR_NET_POLL_FAILED                       -0x0047  /**< Polling the net context failed. */
 #define MBEDTLS_ERR_NET_BAD_INPUT_DATA                    -0x0049  /**< Input invalid. */
+#define MBEDTLS_ERR_NET_KTLS_UNAVAILABLE                  -0x004B  /**< Kernel TLS offload is not available for this socket or cipher. */
 
 #define MBEDTLS_NET_LISTEN_BACKLOG         10 /**< The backlog that listen() should use. */
 
@@ -238,6 +239,69 @@ int mbedtls_net_recv( void *ctx, unsigned char *buf, size_t len );
  */
 int mbedtls_net_send( void *ctx, const unsigned char *buf, size_t len );
 
+/**
+ * \brief          Write the content of several buffers with a single
+ *                 system call (writev() or WSASend()). If no error occurs,
+ *                 the actual amount written is returned.
+ *
+ * \param ctx      Socket
+ * \param iov      The buffers to read from, in order
+ * \param iovcnt   The number of buffers
+ *
+ * \return         the number of bytes sent, which may stop in the middle
+ *                 of a buffer, or a non-zero error code; with a
+ *                 non-blocking socket, MBEDTLS_ERR_SSL_WANT_WRITE indicates
+ *                 the write would block.
+ *
+ * \note           This is suitable for use with mbedtls_ssl_set_bio_vec().
+ */
+int mbedtls_net_send_vec( void *ctx, const mbedtls_ssl_iovec *iov,
+                          size_t iovcnt );
+
+#if defined(MBEDTLS_SSL_KTLS)
+/**
+ * \brief          Let the kernel protect the records of one direction of a
+ *                 TLS connection (Linux kTLS).
+ *
+ * \param ctx      Socket of a TLS connection whose handshake is over
+ * \param direction MBEDTLS_SSL_KTLS_TX or MBEDTLS_SSL_KTLS_RX
+ * \param keys     Output of mbedtls_ssl_export_record_keys() for that
+ *                 direction
+ *
+ * \note           On success, call mbedtls_ssl_set_ktls() before using the
+ *                 SSL context again. On failure, the socket can still be
+ *                 used as before.
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_NET_KTLS_UNAVAILABLE if the kernel or
+ *                 platform does not support it for this cipher,
+ *                 or another MBEDTLS_ERR_NET_xxx error code.
+ */
+int mbedtls_net_ktls_enable( mbedtls_net_context *ctx, int direction,
+                             const mbedtls_ssl_record_keys *keys );
+
+/**
+ * \brief          Read at most 'len' characters of application data from
+ *                 a socket whose receive direction was passed to
+ *                 mbedtls_net_ktls_enable(). This is the receive callback
+ *                 to use from then on.
+ *
+ * \note           Warning alerts other than close_notify are skipped.
+ *
+ * \param ctx      Socket
+ * \param buf      The buffer to write to
+ * \param len      Maximum length of the buffer
+ *
+ * \return         the number of bytes received, 0 if the connection
+ *                 was closed, MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY on a
+ *                 close_notify alert, MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE
+ *                 on a fatal alert, MBEDTLS_ERR_SSL_UNEXPECTED_MESSAGE on a
+ *                 record that is neither application data nor an alert, or
+ *                 another non-zero error code as for mbedtls_net_recv().
+ */
+int mbedtls_net_ktls_recv( void *ctx, unsigned char *buf, size_t len );
+#endif /* MBEDTLS_SSL_KTLS */
+
 /**
  * \brief          Read at most 'len' characters, blocking for at most
  *                 'timeout' seconds. If no error occurs, the actual amount
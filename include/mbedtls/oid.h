@@ -338,6 +338,14 @@
  *     schemes(1) ecdh(12) } */
 #define MBEDTLS_OID_EC_ALG_ECDH                 MBEDTLS_OID_CERTICOM "\x01\x0c"
 
+/*
+ * EdDSA algorithm identifiers, from RFC 8410. The same OID identifies the
+ * key type and the signature algorithm.
+ */
+
+/* id-Ed25519 OBJECT IDENTIFIER ::= { 1 3 101 112 } */
+#define MBEDTLS_OID_ED25519                     "\x2B\x65\x70"
+
 /*
  * ECParameters namedCurve identifiers, from RFC 5480, RFC 5639, and SEC2
  */
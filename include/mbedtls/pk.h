@@ -43,6 +43,10 @@
 #include "mbedtls/ecdsa.h"
 #endif
 
+#if defined(MBEDTLS_ED25519_C)
+#include "mbedtls/ed25519.h"
+#endif
+
 #if defined(MBEDTLS_USE_PSA_CRYPTO)
 #include "psa/crypto.h"
 #endif
@@ -86,6 +90,7 @@ typedef enum {
     MBEDTLS_PK_RSA_ALT,
     MBEDTLS_PK_RSASSA_PSS,
     MBEDTLS_PK_OPAQUE,
+    MBEDTLS_PK_ED25519,
 } mbedtls_pk_type_t;
 
 /**
@@ -228,6 +233,19 @@ static inline mbedtls_ecp_keypair *mbedtls_pk_ec( const mbedtls_pk_context pk )
 }
 #endif /* MBEDTLS_ECP_C */
 
+#if defined(MBEDTLS_ED25519_C)
+/**
+ * Quick access to an Ed25519 context inside a PK context.
+ *
+ * \warning You must make sure the PK context actually holds an Ed25519
+ * context before using this function!
+ */
+static inline mbedtls_ed25519_context *mbedtls_pk_ed25519( const mbedtls_pk_context pk )
+{
+    return( (mbedtls_ed25519_context *) (pk).pk_ctx );
+}
+#endif /* MBEDTLS_ED25519_C */
+
 #if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
 /**
  * \brief           Types for RSA-alt abstraction
@@ -612,6 +630,35 @@ int mbedtls_pk_encrypt( mbedtls_pk_context *ctx,
  */
 int mbedtls_pk_check_pair( const mbedtls_pk_context *pub, const mbedtls_pk_context *prv );
 
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+/**
+ * \brief           Pre-compute data to speed up signature verification with
+ *                  a long-lived public key, such as a trusted CA key.
+ *
+ *                  For EC keys, this calls mbedtls_ecp_keypair_precompute().
+ *                  Subsequent calls to mbedtls_pk_verify() with this context,
+ *                  including those made during X.509 certificate chain
+ *                  verification, then use the pre-computed data.
+ *
+ * \note            If #MBEDTLS_USE_PSA_CRYPTO is enabled, mbedtls_pk_verify()
+ *                  verifies all EC keys through PSA, which does not use the
+ *                  pre-computed data. Only direct calls to the ECDSA module,
+ *                  such as mbedtls_ecdsa_read_signature(), benefit from it.
+ *
+ * \note            Restartable verification, once enabled with
+ *                  mbedtls_ecp_set_max_ops(), does not use the pre-computed
+ *                  data.
+ *
+ * \param ctx       The PK context to use. It must have been set up.
+ *
+ * \return          \c 0 on success, including for key types for which
+ *                  there is nothing to pre-compute, which are left unchanged.
+ * \return          #MBEDTLS_ERR_PK_BAD_INPUT_DATA if the context is invalid.
+ * \return          Another non-zero value on other kinds of failure.
+ */
+int mbedtls_pk_precompute( mbedtls_pk_context *ctx );
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
+
 /**
  * \brief           Export debug information
  *
@@ -122,6 +122,22 @@ typedef struct mbedtls_rsa_context
     mbedtls_mpi Vi;             /*!<  The cached blinding value. */
     mbedtls_mpi Vf;             /*!<  The cached un-blinding value. */
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    mbedtls_mpi blinding_Vi[MBEDTLS_RSA_BLINDING_POOL_SIZE]; /*!< Precomputed blinding values. */
+    mbedtls_mpi blinding_Vf[MBEDTLS_RSA_BLINDING_POOL_SIZE]; /*!< Precomputed un-blinding values. */
+    size_t blinding_count;      /*!<  The number of precomputed pairs. */
+#if defined(MBEDTLS_THREADING_THREADS)
+    int (*blinding_f_rng)(void *, unsigned char *, size_t); /*!< RNG for
+                                     background refills, or NULL. */
+    void *blinding_p_rng;       /*!<  The RNG context for background refills. */
+    int blinding_background;    /*!<  Refill the pool in the background. */
+    int blinding_refill_pending; /*!< A background refill was requested. */
+    mbedtls_threading_thread_t blinding_thread; /*!< The refill thread. */
+    int blinding_thread_state;  /*!<  Whether \c blinding_thread is running
+                                      or must be joined. */
+#endif
+#endif
+
     int padding;                /*!< Selects padding mode:
                                      #MBEDTLS_RSA_PKCS_V15 for 1.5 padding and
                                      #MBEDTLS_RSA_PKCS_V21 for OAEP or PSS. */
@@ -428,6 +444,14 @@ size_t mbedtls_rsa_get_len( const mbedtls_rsa_context *ctx );
  * \note           mbedtls_rsa_init() must be called before this function,
  *                 to set up the RSA context.
  *
+ * \note           If #MBEDTLS_RSA_GEN_KEY_THREADS is defined, the primes are
+ *                 searched for on that many threads, the calling thread
+ *                 included. \p f_rng is only called from the calling
+ *                 thread, and the key only depends on its output, not on
+ *                 the number of threads. It differs from the key that
+ *                 would be generated from the same output without
+ *                 #MBEDTLS_RSA_GEN_KEY_THREADS.
+ *
  * \param ctx      The initialized RSA context used to hold the key.
  * \param f_rng    The RNG function to be used for key generation.
  *                 This must not be \c NULL.
@@ -545,6 +569,10 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
  *                 and the exponent are blinded, providing protection
  *                 against some side-channel attacks.
  *
+ * \note           If #MBEDTLS_RSA_PRIVATE_THREADS is defined, the
+ *                 exponentiation modulo \c Q runs on a separate thread.
+ *                 \p f_rng is only called from the calling thread.
+ *
  * \warning        It is deprecated and a security risk to not provide
  *                 a PRNG here and thereby prevent the use of blinding.
  *                 Future versions of the library may enforce the presence
@@ -573,6 +601,81 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
                  const unsigned char *input,
                  unsigned char *output );
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+/**
+ * \brief          This function precomputes blinding values for
+ *                 mbedtls_rsa_private(), until the context holds
+ *                 #MBEDTLS_RSA_BLINDING_POOL_SIZE of them.
+ *
+ *                 Each private key operation with blinding takes a
+ *                 precomputed pair if there is one, instead of deriving
+ *                 one from the previous pair or, on the first operation,
+ *                 drawing one with a modular inversion and exponentiation.
+ *                 Call this function when idle or from another thread, so
+ *                 that private key operations don't have to wait for
+ *                 blinding values to be drawn.
+ *
+ * \note           The context mutex is only held to add each pair to the
+ *                 pool, not while it is computed.
+ *
+ * \note           The pool is emptied by mbedtls_rsa_import(),
+ *                 mbedtls_rsa_import_raw() and mbedtls_rsa_complete().
+ *
+ * \param ctx      The initialized RSA context holding a private key.
+ * \param f_rng    The RNG function. This must not be \c NULL.
+ * \param p_rng    The RNG context to pass to \p f_rng. This may be \c NULL
+ *                 if \p f_rng doesn't need a context.
+ *
+ * \return         \c 0 on success.
+ * \return         An \c MBEDTLS_ERR_RSA_XXX error code on failure.
+ */
+int mbedtls_rsa_blinding_refill( mbedtls_rsa_context *ctx,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+
+#if defined(MBEDTLS_THREADING_THREADS)
+/**
+ * \brief          This function refills the pool of blinding values from a
+ *                 background thread from now on.
+ *
+ *                 A thread started with mbedtls_thread_create() refills
+ *                 the pool at once, and again whenever mbedtls_rsa_private()
+ *                 leaves half of #MBEDTLS_RSA_BLINDING_POOL_SIZE pairs or
+ *                 less. At most one such thread runs per context at a time.
+ *
+ * \note           \p f_rng is called from the background thread while
+ *                 other threads may use it too, so it must be thread-safe,
+ *                 as mbedtls_ctr_drbg_random() is with MBEDTLS_THREADING_C.
+ *
+ * \param ctx      The initialized RSA context holding a private key.
+ * \param f_rng    The RNG function. This must not be \c NULL.
+ * \param p_rng    The RNG context to pass to \p f_rng. This may be \c NULL
+ *                 if \p f_rng doesn't need a context.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_RSA_BAD_INPUT_DATA if \p ctx doesn't hold
+ *                 a private key.
+ * \return         #MBEDTLS_ERR_THREADING_THREAD_ERROR if the thread could
+ *                 not be started.
+ * \return         #MBEDTLS_ERR_THREADING_MUTEX_ERROR on a mutex failure.
+ */
+int mbedtls_rsa_blinding_start_refill( mbedtls_rsa_context *ctx,
+                                       int (*f_rng)(void *, unsigned char *,
+                                                    size_t),
+                                       void *p_rng );
+
+/**
+ * \brief          This function stops refilling the pool of blinding values
+ *                 in the background, after waiting for the refills already
+ *                 requested to finish. This is also done by
+ *                 mbedtls_rsa_free().
+ *
+ * \param ctx      The initialized RSA context.
+ */
+void mbedtls_rsa_blinding_stop_refill( mbedtls_rsa_context *ctx );
+#endif /* MBEDTLS_THREADING_THREADS */
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE */
+
 /**
  * \brief          This function adds the message padding, then performs an RSA
  *                 operation.
@@ -1087,6 +1190,48 @@ int mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context *ctx,
                       const unsigned char *hash,
                       const unsigned char *sig );
 
+/**
+ * \brief          A signature to verify with mbedtls_rsa_pkcs1_verify_batch().
+ */
+typedef struct mbedtls_rsa_batch_entry
+{
+    mbedtls_rsa_context *ctx;   /*!< The public key to use for verification. */
+    mbedtls_md_type_t md_alg;   /*!< The message-digest algorithm used to
+                                     hash the original data. */
+    unsigned int hashlen;       /*!< The length of \c hash, if \c md_alg is
+                                     #MBEDTLS_MD_NONE. */
+    const unsigned char *hash;  /*!< The message digest or raw data. */
+    const unsigned char *sig;   /*!< The signature, \c ctx->len Bytes long. */
+    int ret;                    /*!< Output: the result of verifying this
+                                     signature, as mbedtls_rsa_pkcs1_verify()
+                                     would return it in public mode. */
+}
+mbedtls_rsa_batch_entry;
+
+/**
+ * \brief          This function verifies many PKCS#1 signatures at once.
+ *
+ *                 Each signature is checked as mbedtls_rsa_pkcs1_verify()
+ *                 does in #MBEDTLS_RSA_PUBLIC mode, using the padding mode
+ *                 of its context, so PKCS#1 v1.5 and PSS signatures can be
+ *                 mixed. Consecutive entries that use the same context are
+ *                 processed together: the context is locked once for all of
+ *                 them and they share the setup of the exponentiation.
+ *                 Sorting the entries by key therefore helps.
+ *
+ * \see            mbedtls_rsa_pkcs1_verify()
+ *
+ * \param entries  The signatures to verify. On return, the \c ret field of
+ *                 each entry holds the result for that signature.
+ * \param count    The number of entries.
+ *
+ * \return         \c 0 if all signatures are valid.
+ * \return         The \c ret field of the first entry that failed
+ *                 otherwise, typically #MBEDTLS_ERR_RSA_VERIFY_FAILED.
+ */
+int mbedtls_rsa_pkcs1_verify_batch( mbedtls_rsa_batch_entry *entries,
+                                    size_t count );
+
 /**
  * \brief          This function performs a PKCS#1 v1.5 verification
  *                 operation (RSASSA-PKCS1-v1_5-VERIFY).
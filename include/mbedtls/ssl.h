@@ -72,6 +72,10 @@
 #include "psa/crypto.h"
 #endif /* MBEDTLS_USE_PSA_CRYPTO */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL) && defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
 /*
  * SSL Error codes
  */
@@ -176,6 +180,9 @@
 #define MBEDTLS_SSL_ETM_DISABLED                0
 #define MBEDTLS_SSL_ETM_ENABLED                 1
 
+#define MBEDTLS_SSL_KTLS_TX                     1
+#define MBEDTLS_SSL_KTLS_RX                     2
+
 #define MBEDTLS_SSL_COMPRESS_NULL               0
 #define MBEDTLS_SSL_COMPRESS_DEFLATE            1
 
@@ -210,6 +217,9 @@
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED    0
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_ENABLED     1
 
+#define MBEDTLS_SSL_READ_AHEAD_DISABLED         0
+#define MBEDTLS_SSL_READ_AHEAD_ENABLED          1
+
 #define MBEDTLS_SSL_ARC4_ENABLED                0
 #define MBEDTLS_SSL_ARC4_DISABLED               1
 
@@ -291,6 +301,14 @@
 #define MBEDTLS_SSL_TLS1_3_PADDING_GRANULARITY 1
 #endif
 
+/*
+ * Maximum number of idle record buffers kept by a buffer pool,
+ * see mbedtls_ssl_buffer_pool_set_max_free().
+ */
+#if !defined(MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE)
+#define MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE 32
+#endif
+
 /* \} name SECTION: Module settings */
 
 /*
@@ -324,6 +342,13 @@
 #define MBEDTLS_SSL_SIG_RSA                  1
 #define MBEDTLS_SSL_SIG_ECDSA                3
 
+/*
+ * The ed25519 signature scheme of RFC 8422 section 5.1.3, 0x0807. It has
+ * no separate hash: its first byte is not a HashAlgorithm value.
+ */
+#define MBEDTLS_SSL_HASH_INTRINSIC           8
+#define MBEDTLS_SSL_SIG_ED25519              7
+
 /*
  * Client Certificate Types
  * RFC 5246 section 7.4.4 plus RFC 4492 section 5.5
@@ -526,6 +551,40 @@ typedef int mbedtls_ssl_send_t( void *ctx,
                                 const unsigned char *buf,
                                 size_t len );
 
+/**
+ * \brief          Scatter-gather entry for \c mbedtls_ssl_send_vec_t.
+ */
+typedef struct mbedtls_ssl_iovec
+{
+    const unsigned char *base;  /*!< start of the data to send */
+    size_t len;                 /*!< length of the data to send */
+}
+mbedtls_ssl_iovec;
+
+/**
+ * \brief          Callback type: send several buffers to the network in a
+ *                 single operation (e.g. \c writev() or \c sendmsg()).
+ *
+ * \note           That callback may be either blocking or non-blocking.
+ *
+ * \param ctx      Context for the send callback (typically a file descriptor)
+ * \param iov      Array of buffers holding the data to send, in order
+ * \param iovcnt   Number of entries in \p iov
+ *
+ * \return         The callback must return the total number of bytes sent
+ *                 if any, or a non-zero error code.
+ *                 If performing non-blocking I/O, \c MBEDTLS_ERR_SSL_WANT_WRITE
+ *                 must be returned when the operation would block.
+ *
+ * \note           The callback is allowed to send fewer bytes than requested,
+ *                 including stopping in the middle of an entry. It must always
+ *                 return the number of bytes actually sent, counted from the
+ *                 start of the first entry.
+ */
+typedef int mbedtls_ssl_send_vec_t( void *ctx,
+                                    const mbedtls_ssl_iovec *iov,
+                                    size_t iovcnt );
+
 /**
  * \brief          Callback type: receive data from the network.
  *
@@ -623,6 +682,7 @@ typedef struct mbedtls_ssl_config  mbedtls_ssl_config;
 typedef struct mbedtls_ssl_transform mbedtls_ssl_transform;
 typedef struct mbedtls_ssl_handshake_params mbedtls_ssl_handshake_params;
 typedef struct mbedtls_ssl_sig_hash_set_t mbedtls_ssl_sig_hash_set_t;
+typedef struct mbedtls_ssl_out_queue mbedtls_ssl_out_queue;
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 typedef struct mbedtls_ssl_key_cert mbedtls_ssl_key_cert;
 #endif
@@ -896,6 +956,27 @@ mbedtls_dtls_srtp_info;
 
 #endif /* MBEDTLS_SSL_DTLS_SRTP */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+/**
+ * \brief          Pool of record buffers shared by SSL contexts, see
+ *                 mbedtls_ssl_conf_buffer_pool().
+ *
+ * \note           The fields are internal: use the
+ *                 mbedtls_ssl_buffer_pool_xxx() functions.
+ */
+typedef struct mbedtls_ssl_buffer_pool
+{
+    void *free_list;            /*!< buffers not in use, linked through
+                                     their first bytes                */
+    size_t free_count;          /*!< number of buffers in free_list   */
+    size_t max_free;            /*!< maximum number of buffers kept   */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex for free_list      */
+#endif
+}
+mbedtls_ssl_buffer_pool;
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 /*
  * This structure is used for storing current session data.
  *
@@ -977,6 +1058,18 @@ struct mbedtls_ssl_config
     int (*f_set_cache)(void *, const mbedtls_ssl_session *);
     void *p_cache;                  /*!< context for cache callbacks        */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool *buffer_pool; /*!< pool for the record buffers
+                                               of idle connections      */
+#endif
+
+#if defined(MBEDTLS_SSL_SRV_C) && \
+    defined(MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED)
+    /** Callback to retrieve a pre-generated ephemeral ECDHE key pair       */
+    int (*f_get_ecdhe_key)(void *, mbedtls_ecp_group_id, mbedtls_ecp_keypair *);
+    void *p_ecdhe_key;              /*!< context for ECDHE key callback     */
+#endif
+
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     /** Callback for setting cert according to SNI extension                */
     int (*f_sni)(void *, mbedtls_ssl_context *, const unsigned char *, size_t);
@@ -1194,6 +1287,7 @@ struct mbedtls_ssl_config
     unsigned int dtls_srtp_mki_support : 1; /* support having mki_value
                                                in the use_srtp extension     */
 #endif
+    unsigned int read_ahead : 1;    /*!< read past the current record (TLS)? */
 };
 
 struct mbedtls_ssl_context
@@ -1228,6 +1322,8 @@ struct mbedtls_ssl_context
     mbedtls_ssl_recv_t *f_recv; /*!< Callback for network receive */
     mbedtls_ssl_recv_timeout_t *f_recv_timeout;
                                 /*!< Callback for network receive with timeout */
+    mbedtls_ssl_send_vec_t *f_send_vec;
+                                /*!< Callback for vectored network send */
 
     void *p_bio;                /*!< context for I/O operations   */
 
@@ -1283,13 +1379,18 @@ struct mbedtls_ssl_context
 #endif
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     uint16_t in_epoch;          /*!< DTLS epoch for incoming records  */
-    size_t next_record_offset;  /*!< offset of the next record in datagram
-                                     (equal to in_left if none)       */
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
+    size_t next_record_offset;  /*!< offset of the next record in datagram
+                                     (DTLS) or in the bytes read ahead
+                                     (TLS), equal to in_left if none  */
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
     uint64_t in_window_top;     /*!< last validated record seq_num    */
     uint64_t in_window;         /*!< bitmask for replay detection     */
 #endif /* MBEDTLS_SSL_DTLS_ANTI_REPLAY */
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    unsigned char in_ctr_idle[8]; /*!< copy of in_ctr while in_buf is
+                                       back in the buffer pool        */
+#endif
 
     size_t in_hslen;            /*!< current handshake message length,
                                      including the handshake header   */
@@ -1320,6 +1421,7 @@ struct mbedtls_ssl_context
     int out_msgtype;            /*!< record header: message type      */
     size_t out_msglen;          /*!< record header: message length    */
     size_t out_left;            /*!< amount of data not yet written   */
+    mbedtls_ssl_out_queue *out_queue; /*!< records held back for f_send_vec */
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
     size_t out_buf_len;         /*!< length of output buffer          */
 #endif
@@ -1336,6 +1438,10 @@ struct mbedtls_ssl_context
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     signed char split_done;     /*!< current record already splitted? */
 #endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+#if defined(MBEDTLS_SSL_KTLS)
+    unsigned char ktls;         /*!< directions whose record protection is
+                                     done by the transport (kTLS)       */
+#endif /* MBEDTLS_SSL_KTLS */
 
     /*
      * PKI layer
@@ -1637,6 +1743,114 @@ void mbedtls_ssl_set_bio( mbedtls_ssl_context *ssl,
                           mbedtls_ssl_recv_t *f_recv,
                           mbedtls_ssl_recv_timeout_t *f_recv_timeout );
 
+/**
+ * \brief          Set an optional vectored write callback, sharing the
+ *                 context \c p_bio set with \c mbedtls_ssl_set_bio().
+ *
+ * \param ssl      SSL context
+ * \param f_send_vec vectored write callback, or NULL to disable it
+ *
+ * \note           When this callback is set, the records of a TLS handshake
+ *                 flight (including ChangeCipherSpec) are held back and sent
+ *                 together, in as few calls to \p f_send_vec as the
+ *                 callback allows, when the flight is complete: that is
+ *                 before waiting for the peer's answer, or at the end of the
+ *                 handshake. Likewise, an application data write longer
+ *                 than the maximum fragment length is sealed into up to
+ *                 nine records, which are sent together and reported as a
+ *                 single write by \c mbedtls_ssl_write(). Other records
+ *                 are still sent with the \c f_send callback, unless queued
+ *                 records are pending, in which case they go out in the same
+ *                 vectored write.
+ *
+ * \note           This has no effect with DTLS, which already packs several
+ *                 records per datagram.
+ *
+ * \note           See the documentation of \c mbedtls_ssl_send_vec_t for
+ *                 the conventions the callback must follow. On some
+ *                 platforms, net_sockets.c provides \c mbedtls_net_send_vec()
+ *                 which is suitable to be used here.
+ */
+void mbedtls_ssl_set_bio_vec( mbedtls_ssl_context *ssl,
+                              mbedtls_ssl_send_vec_t *f_send_vec );
+
+#if defined(MBEDTLS_SSL_KTLS)
+/**
+ * \brief          Record protection parameters of one direction of a TLS 1.2
+ *                 connection, as needed to hand it over to another
+ *                 implementation of the record layer (e.g. Linux kTLS).
+ */
+typedef struct mbedtls_ssl_record_keys
+{
+    mbedtls_cipher_type_t cipher;   /*!< #MBEDTLS_CIPHER_AES_128_GCM,
+                                         #MBEDTLS_CIPHER_AES_256_GCM or
+                                         #MBEDTLS_CIPHER_CHACHA20_POLY1305 */
+    unsigned char key[32];          /*!< traffic key                      */
+    size_t key_len;                 /*!< length of \c key in bytes        */
+    unsigned char iv[12];           /*!< fixed part of the nonce: the
+                                         4-byte salt for GCM, the 12-byte
+                                         IV for ChaCha20-Poly1305          */
+    size_t iv_len;                  /*!< length of \c iv in bytes         */
+    unsigned char seq[8];           /*!< sequence number of the next
+                                         record, big endian                */
+}
+mbedtls_ssl_record_keys;
+
+/**
+ * \brief          Export the record protection parameters of one direction
+ *                 of an established TLS 1.2 connection.
+ *
+ * \param ssl      SSL context, after the handshake is over
+ * \param direction #MBEDTLS_SSL_KTLS_TX for the records we send, or
+ *                 #MBEDTLS_SSL_KTLS_RX for the records we receive
+ * \param keys     Structure to fill. It holds secret keys and should be
+ *                 zeroized after use.
+ *
+ * \note           For GCM, the explicit part of the nonce of each record is
+ *                 its sequence number, as the library does it.
+ *
+ * \return         0 on success,
+ *                 #MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE if the connection
+ *                 does not use TLS 1.2 with one of the ciphers above, or
+ *                 uses compression,
+ *                 #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the handshake is not
+ *                 over, or if some data is still pending in that direction
+ *                 (see mbedtls_ssl_check_pending()).
+ */
+int mbedtls_ssl_export_record_keys( const mbedtls_ssl_context *ssl,
+                                    int direction,
+                                    mbedtls_ssl_record_keys *keys );
+
+/**
+ * \brief          Declare that the record protection of some directions is
+ *                 now done by the transport, typically after passing the
+ *                 output of mbedtls_ssl_export_record_keys() to
+ *                 mbedtls_net_ktls_enable().
+ *
+ *                 With #MBEDTLS_SSL_KTLS_TX, mbedtls_ssl_write() hands the
+ *                 plaintext to the send callback. With #MBEDTLS_SSL_KTLS_RX,
+ *                 mbedtls_ssl_read() returns what the receive callback
+ *                 reads, which should be mbedtls_net_ktls_recv() so that
+ *                 alerts from the peer are reported.
+ *
+ * \param ssl      SSL context, after the handshake is over
+ * \param directions #MBEDTLS_SSL_KTLS_TX, #MBEDTLS_SSL_KTLS_RX, or both
+ *
+ * \note           Once a direction is offloaded, the connection cannot be
+ *                 renegotiated, mbedtls_ssl_write_in_place()
+ *                 and mbedtls_ssl_read_record_view() are unavailable in
+ *                 that direction, and alerts (including close_notify) can
+ *                 no longer be sent by the library, so
+ *                 mbedtls_ssl_close_notify() returns
+ *                 #MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE.
+ *
+ * \return         0 on success,
+ *                 #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the handshake is not
+ *                 over or \p directions is invalid.
+ */
+int mbedtls_ssl_set_ktls( mbedtls_ssl_context *ssl, int directions );
+#endif /* MBEDTLS_SSL_KTLS */
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 
 #if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
@@ -2435,6 +2649,38 @@ void mbedtls_ssl_conf_session_cache( mbedtls_ssl_config *conf,
         void *p_cache,
         int (*f_get_cache)(void *, mbedtls_ssl_session *),
         int (*f_set_cache)(void *, const mbedtls_ssl_session *) );
+
+#if defined(MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED)
+/**
+ * \brief          Set the callback used by the server to retrieve a
+ *                 pre-generated ephemeral ECDHE key pair, instead of
+ *                 generating one during the handshake.
+ *                 (Default: none, keys are generated during the handshake.)
+ *
+ *                 The callback has the following parameters:
+ *                 (void *parameter, mbedtls_ecp_group_id grp_id,
+ *                 mbedtls_ecp_keypair *key). It is called with the curve
+ *                 negotiated for the handshake and an initialized \c key.
+ *                 If it has a key pair for that curve, it should move it
+ *                 into \c key and return 0, return 1 otherwise, in which
+ *                 case the key pair is generated as usual. Each key pair
+ *                 must be handed out only once: reusing ephemeral keys
+ *                 breaks forward secrecy.
+ *
+ * \note           The SSL/TLS layer frees \c key once it has imported it.
+ *
+ * \note           See \c mbedtls_ssl_key_pool_get() in ssl_key_pool.h
+ *                 for a ready-made implementation.
+ *
+ * \param conf           SSL configuration
+ * \param f_get_ecdhe_key key pair retrieval callback
+ * \param p_ecdhe_key    parameter (context) for the callback
+ */
+void mbedtls_ssl_conf_ecdhe_key_cb( mbedtls_ssl_config *conf,
+        int (*f_get_ecdhe_key)(void *, mbedtls_ecp_group_id,
+                               mbedtls_ecp_keypair *),
+        void *p_ecdhe_key );
+#endif /* MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED */
 #endif /* MBEDTLS_SSL_SRV_C */
 
 #if defined(MBEDTLS_SSL_CLI_C)
@@ -3473,6 +3719,88 @@ void mbedtls_ssl_conf_truncated_hmac( mbedtls_ssl_config *conf, int truncate );
 void mbedtls_ssl_conf_cbc_record_splitting( mbedtls_ssl_config *conf, char split );
 #endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
 
+/**
+ * \brief          Enable / Disable read-ahead with TLS
+ *                 (Default: MBEDTLS_SSL_READ_AHEAD_DISABLED)
+ *
+ *                 By default, each record is received with (at least) two
+ *                 calls to the receive callback: one for the record header
+ *                 and one for the rest of the record. With read-ahead, each
+ *                 call asks for as many bytes as fit in the input buffer,
+ *                 and the records that come in with the current one are
+ *                 processed from the buffer later on, saving calls to the
+ *                 receive callback when many small records are received.
+ *
+ * \note           This has no effect with DTLS, where whole datagrams are
+ *                 always received at once, nor when MBEDTLS_ZLIB_SUPPORT is
+ *                 enabled.
+ *
+ * \note           With read-ahead, received data may be pending in the SSL
+ *                 context while the underlying transport has nothing left
+ *                 to read: event-driven applications should use
+ *                 \c mbedtls_ssl_check_pending() before waiting for the
+ *                 transport to become readable.
+ *
+ * \param conf     SSL configuration
+ * \param read_ahead MBEDTLS_SSL_READ_AHEAD_ENABLED or
+ *                 MBEDTLS_SSL_READ_AHEAD_DISABLED
+ */
+void mbedtls_ssl_conf_read_ahead( mbedtls_ssl_config *conf, char read_ahead );
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+/**
+ * \brief          Set a pool for the record buffers of idle connections.
+ *
+ *                 Each SSL context has an input and an output buffer of
+ *                 about MBEDTLS_SSL_IN_CONTENT_LEN and
+ *                 MBEDTLS_SSL_OUT_CONTENT_LEN bytes. With a pool, a context
+ *                 gives its buffers back to the pool when the handshake is
+ *                 over and no data is pending in them, at the end of calls
+ *                 such as mbedtls_ssl_read() or mbedtls_ssl_write(), and
+ *                 takes buffers from the pool again at the start of the
+ *                 next call that needs them. A connection that waits for
+ *                 the peer with no partial record buffered then only costs
+ *                 the size of mbedtls_ssl_context.
+ *
+ * \note           Released buffers are zeroized.
+ *
+ * \note           The pool must outlive all SSL contexts using this
+ *                 configuration.
+ *
+ * \param conf     SSL configuration
+ * \param pool     Buffer pool, initialized with
+ *                 mbedtls_ssl_buffer_pool_init(), or NULL to keep buffers
+ *                 for the whole life of each context (default).
+ */
+void mbedtls_ssl_conf_buffer_pool( mbedtls_ssl_config *conf,
+                                   mbedtls_ssl_buffer_pool *pool );
+
+/**
+ * \brief          Initialize a buffer pool.
+ *
+ * \param pool     Buffer pool to initialize
+ */
+void mbedtls_ssl_buffer_pool_init( mbedtls_ssl_buffer_pool *pool );
+
+/**
+ * \brief          Set the maximum number of buffers kept in the pool while
+ *                 no context uses them. Buffers given back beyond that are
+ *                 freed. (Default: MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE.)
+ *
+ * \param pool     Buffer pool
+ * \param max_free Maximum number of buffers kept
+ */
+void mbedtls_ssl_buffer_pool_set_max_free( mbedtls_ssl_buffer_pool *pool,
+                                           size_t max_free );
+
+/**
+ * \brief          Free the buffers kept in a pool.
+ *
+ * \param pool     Buffer pool to free
+ */
+void mbedtls_ssl_buffer_pool_free( mbedtls_ssl_buffer_pool *pool );
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 #if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
 /**
  * \brief          Enable / Disable session tickets (client only).
@@ -3622,7 +3950,11 @@ void mbedtls_ssl_conf_renegotiation_period( mbedtls_ssl_config *conf,
  *                 also signal pending data, but the converse does
  *                 not hold. For example, in DTLS there might be
  *                 further records waiting to be processed from
- *                 the current underlying transport's datagram.
+ *                 the current underlying transport's datagram,
+ *                 and in TLS with read-ahead (see
+ *                 \c mbedtls_ssl_conf_read_ahead()) there might be
+ *                 complete records that were received together with
+ *                 the previous one.
  *
  * \note           If this function returns 1 (data pending), this
  *                 does not imply that a subsequent call to
@@ -3710,6 +4042,40 @@ const char *mbedtls_ssl_get_version( const mbedtls_ssl_context *ssl );
  */
 int mbedtls_ssl_get_record_expansion( const mbedtls_ssl_context *ssl );
 
+/**
+ * \brief          Return the number of bytes that the record layer puts in
+ *                 front of the data: record header and explicit IV, if any
+ *
+ * \note           This is the room to reserve before the data in the
+ *                 buffer given to \c mbedtls_ssl_write_in_place(). It
+ *                 depends on the negotiated ciphersuite, so it must be
+ *                 queried once the handshake is complete.
+ *
+ * \param ssl      SSL context
+ *
+ * \return         Current record headroom in bytes, or
+ *                 MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE if compression is
+ *                 enabled
+ */
+int mbedtls_ssl_get_record_headroom( const mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          Return the (maximum) number of bytes that the record layer
+ *                 appends to the data: MAC or tag, and padding
+ *
+ * \note           This is the room to reserve after the data in the buffer
+ *                 given to \c mbedtls_ssl_write_in_place(). The headroom
+ *                 and the tailroom add up to
+ *                 \c mbedtls_ssl_get_record_expansion().
+ *
+ * \param ssl      SSL context
+ *
+ * \return         Current maximum record tailroom in bytes, or
+ *                 MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE if compression is
+ *                 enabled
+ */
+int mbedtls_ssl_get_record_tailroom( const mbedtls_ssl_context *ssl );
+
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
 /**
  * \brief          Return the maximum fragment length (payload, in bytes) for
@@ -4042,6 +4408,58 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl );
  */
 int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len );
 
+/**
+ * \brief          Get a view of the application data that has not been
+ *                 read yet, without copying it out of the SSL input buffer
+ *
+ *                 This reads and decrypts the next application data record
+ *                 if needed, exactly like \c mbedtls_ssl_read(), but instead
+ *                 of copying the plaintext it returns a pointer to it in
+ *                 place. The data stays available until it is consumed
+ *                 with \c mbedtls_ssl_read_release() (or
+ *                 \c mbedtls_ssl_read()); calling this function again
+ *                 before that returns the same data.
+ *
+ * \param ssl      SSL context
+ * \param buf      address of a pointer that is set to the first unread
+ *                 byte of application data, or to \c NULL if \p len is
+ *                 set to \c 0
+ * \param len      address of a variable that is set to the number of bytes
+ *                 available at \p buf. This is at most one record's worth
+ *                 of data.
+ *
+ * \return         \c 0 if successful. If \p len is set to \c 0, the read
+ *                 end of the underlying transport was closed without a
+ *                 CloseNotify, as when \c mbedtls_ssl_read() returns \c 0.
+ * \return         Any other value that \c mbedtls_ssl_read() may return,
+ *                 with the same meaning.
+ *
+ * \warning        The returned pointer is only valid until the next call to
+ *                 \c mbedtls_ssl_read_release() or to any other function
+ *                 operating on \p ssl. The data must not be modified.
+ */
+int mbedtls_ssl_read_record_view( mbedtls_ssl_context *ssl,
+                                  const unsigned char **buf, size_t *len );
+
+/**
+ * \brief          Mark application data returned by
+ *                 \c mbedtls_ssl_read_record_view() as consumed
+ *
+ *                 The consumed bytes are wiped from the input buffer. Once
+ *                 the whole record has been consumed, the next call to
+ *                 \c mbedtls_ssl_read_record_view() or \c mbedtls_ssl_read()
+ *                 fetches a new record.
+ *
+ * \param ssl      SSL context
+ * \param len      number of bytes consumed, from the start of the view;
+ *                 at most the length returned by
+ *                 \c mbedtls_ssl_read_record_view()
+ *
+ * \return         \c 0 if successful, or #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if
+ *                 \p len is larger than the amount of unread data.
+ */
+int mbedtls_ssl_read_release( mbedtls_ssl_context *ssl, size_t len );
+
 /**
  * \brief          Try to write exactly 'len' application data bytes
  *
@@ -4094,7 +4512,10 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
  * \note           If the requested length is greater than the maximum
  *                 fragment length (either the built-in limit or the one set
  *                 or negotiated with the peer), then:
- *                 - with TLS, less bytes than requested are written.
+ *                 - with TLS, less bytes than requested are written: the
+ *                   content of a single record, or of several records if a
+ *                   vectored write callback is set with
+ *                   \c mbedtls_ssl_set_bio_vec().
  *                 - with DTLS, MBEDTLS_ERR_SSL_BAD_INPUT_DATA is returned.
  *                 \c mbedtls_ssl_get_output_max_frag_len() may be used to
  *                 query the active maximum fragment length.
@@ -4104,6 +4525,50 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
  */
 int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len );
 
+/**
+ * \brief          Write one record of application data that the caller has
+ *                 placed in its own buffer, without copying it
+ *
+ *                 The buffer is laid out as follows:
+ *                 - \p buf[0] to \p buf[headroom - 1]: reserved for the
+ *                   record header and explicit IV, where \c headroom is
+ *                   the value returned by \c mbedtls_ssl_get_record_headroom();
+ *                 - the next \p len bytes: the application data;
+ *                 - at least \c mbedtls_ssl_get_record_tailroom() bytes
+ *                   reserved for the MAC or tag and the padding.
+ *
+ *                 The record is protected in place and sent from \p buf.
+ *                 If the underlying transport only takes part of it, the
+ *                 rest is copied to the internal output buffer, so that
+ *                 \p buf can be reused as soon as this function returns.
+ *
+ * \note           Ciphersuites subject to 1/n-1 record splitting (see
+ *                 \c mbedtls_ssl_conf_cbc_record_splitting()) and hardware
+ *                 record acceleration go through the internal buffer, as
+ *                 with \c mbedtls_ssl_write().
+ *
+ * \param ssl      SSL context
+ * \param buf      buffer holding the data, with headroom and tailroom
+ *                 around it. Its content is overwritten.
+ * \param buf_len  total size of \p buf
+ * \param len      number of application data bytes; at most
+ *                 \c mbedtls_ssl_get_max_out_record_payload()
+ *
+ * \return         \p len if successful.
+ * \return         #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if \p buf_len leaves no
+ *                 room for the headroom and tailroom, or if \p len is
+ *                 larger than a record's payload.
+ * \return         #MBEDTLS_ERR_SSL_WANT_WRITE or #MBEDTLS_ERR_SSL_WANT_READ
+ *                 as for \c mbedtls_ssl_write(). In this case the function
+ *                 must be called again with the same \p len; as the
+ *                 record has been protected already, the content of
+ *                 \p buf no longer matters.
+ * \return         Any other return value of \c mbedtls_ssl_write(), with
+ *                 the same meaning.
+ */
+int mbedtls_ssl_write_in_place( mbedtls_ssl_context *ssl, unsigned char *buf,
+                                size_t buf_len, size_t len );
+
 /**
  * \brief           Send an alert message
  *
@@ -50,6 +50,10 @@
 #define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50   /*!< Maximum entries in cache */
 #endif
 
+#if !defined(MBEDTLS_SSL_CACHE_SHARDS)
+#define MBEDTLS_SSL_CACHE_SHARDS                    8   /*!< Maximum number of independently locked shards */
+#endif
+
 /* \} name SECTION: Module settings */
 
 #ifdef __cplusplus
@@ -58,6 +62,7 @@ extern "C" {
 
 typedef struct mbedtls_ssl_cache_context mbedtls_ssl_cache_context;
 typedef struct mbedtls_ssl_cache_entry mbedtls_ssl_cache_entry;
+typedef struct mbedtls_ssl_cache_shard mbedtls_ssl_cache_shard;
 
 /**
  * \brief   This structure is used for storing cache entries
@@ -67,24 +72,50 @@ struct mbedtls_ssl_cache_entry
 #if defined(MBEDTLS_HAVE_TIME)
     mbedtls_time_t timestamp;           /*!< entry timestamp    */
 #endif
-    mbedtls_ssl_session session;        /*!< entry session      */
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-    mbedtls_x509_buf peer_cert;         /*!< entry peer_cert    */
+    unsigned char session_id[32];       /*!< session ID         */
+    size_t session_id_len;              /*!< session ID length  */
+    unsigned char *session;             /*!< session, as written by
+                                             mbedtls_ssl_session_save() */
+    size_t session_len;                 /*!< serialized session length  */
+    mbedtls_ssl_cache_entry *next;      /*!< next entry in the bucket   */
+    mbedtls_ssl_cache_entry *lru_prev;  /*!< more recently used entry   */
+    mbedtls_ssl_cache_entry *lru_next;  /*!< less recently used entry   */
+};
+
+/**
+ * \brief   Part of the cache with its own hash table, LRU list and lock
+ */
+struct mbedtls_ssl_cache_shard
+{
+    mbedtls_ssl_cache_entry **buckets;  /*!< hash table, or NULL if unused  */
+    size_t bucket_count;                /*!< hash table size, a power of 2  */
+    mbedtls_ssl_cache_entry *lru_head;  /*!< most recently used entry       */
+    mbedtls_ssl_cache_entry *lru_tail;  /*!< least recently used entry      */
+    int entries;                        /*!< number of entries              */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex                          */
 #endif
-    mbedtls_ssl_cache_entry *next;      /*!< chain pointer      */
 };
 
 /**
  * \brief Cache context
+ *
+ * Entries are indexed by session ID in a hash table split into
+ * shards, so that lookups take constant time and threads working on
+ * different shards do not contend for the same lock. When a shard is
+ * full, its least recently used entry is replaced.
+ *
+ * \p shard_count and \p max_entries are written with every shard lock and
+ * \p mutex held, so they may be read with either of them.
  */
 struct mbedtls_ssl_cache_context
 {
-    mbedtls_ssl_cache_entry *chain;     /*!< start of the chain     */
-    int timeout;                /*!< cache entry timeout    */
-    int max_entries;            /*!< maximum entries        */
+    mbedtls_ssl_cache_shard shards[MBEDTLS_SSL_CACHE_SHARDS]; /*!< shards */
+    int shard_count;            /*!< number of shards in use    */
+    int timeout;                /*!< cache entry timeout        */
+    int max_entries;            /*!< maximum entries            */
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_threading_mutex_t mutex;    /*!< mutex                  */
+    mbedtls_threading_mutex_t mutex;    /*!< mutex for the geometry */
 #endif
 };
 
@@ -99,6 +130,13 @@ void mbedtls_ssl_cache_init( mbedtls_ssl_cache_context *cache );
  * \brief          Cache get callback implementation
  *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
  *
+ * \note           Sessions are kept in the compact form written by
+ *                 mbedtls_ssl_session_save() and restored with
+ *                 mbedtls_ssl_session_load(). With
+ *                 MBEDTLS_SSL_KEEP_PEER_CERTIFICATE, this parses the peer
+ *                 certificate again if the peer sent one; without it, only
+ *                 the certificate digest is stored and nothing is parsed.
+ *
  * \param data     SSL cache context
  * \param session  session to retrieve entry for
  */
@@ -130,6 +168,18 @@ void mbedtls_ssl_cache_set_timeout( mbedtls_ssl_cache_context *cache, int timeou
  * \brief          Set the maximum number of cache entries
  *                 (Default: MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES (50))
  *
+ * \note           This also sets the number of shards the entries are
+ *                 spread over, from one for small caches up to
+ *                 MBEDTLS_SSL_CACHE_SHARDS. Each shard replaces its own
+ *                 least recently used entry when it is full.
+ *
+ * \note           The entries already stored are redistributed over the
+ *                 shards. If the cache shrinks, the least recently used
+ *                 ones are dropped.
+ *
+ * \note           If MBEDTLS_THREADING_C is enabled, this may be called
+ *                 while other threads use the cache.
+ *
  * \param cache    SSL cache context
  * \param max      cache entry maximum
  */
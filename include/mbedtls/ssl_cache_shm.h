@@ -0,0 +1,196 @@
+/**
+ * \file ssl_cache_shm.h
+ *
+ * \brief SSL session cache shared between processes
+ *
+ * This cache lives in a memory-mapped file, so that the worker processes
+ * of a preforking server can resume sessions established by each other.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MBEDTLS_SSL_CACHE_SHM_H
+#define MBEDTLS_SSL_CACHE_SHM_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ssl.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT)
+#define MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT   86400   /*!< 1 day  */
+#endif
+
+#if !defined(MBEDTLS_SSL_CACHE_SHM_MUTEXES)
+#define MBEDTLS_SSL_CACHE_SHM_MUTEXES           16  /*!< Number of mutexes the sets are spread over */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Shared cache context
+ *
+ * Each process that uses the cache has its own context, attached to the
+ * same file. The file holds a fixed number of fixed-size slots, grouped
+ * in small sets: a session can only be stored in the set its session ID
+ * hashes to, and replaces the least recently used slot of the set when
+ * the set is full.
+ */
+typedef struct mbedtls_ssl_cache_shm_context
+{
+    int fd;                     /*!< backing file, or -1            */
+    unsigned char *base;        /*!< start of the shared mapping    */
+    size_t map_len;             /*!< length of the shared mapping   */
+    uint32_t set_count;         /*!< number of sets of slots        */
+    size_t slot_size;           /*!< room for a serialized session  */
+    size_t slot_stride;         /*!< distance between two slots     */
+    size_t set_stride;          /*!< distance between two sets      */
+    int timeout;                /*!< cache entry timeout            */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex[MBEDTLS_SSL_CACHE_SHM_MUTEXES];
+                                /*!< serialize the threads of this
+                                     process, set i using mutex
+                                     i % MBEDTLS_SSL_CACHE_SHM_MUTEXES */
+#endif
+}
+mbedtls_ssl_cache_shm_context;
+
+/**
+ * \brief          Initialize a shared cache context
+ *
+ * \param cache    Shared cache context
+ */
+void mbedtls_ssl_cache_shm_init( mbedtls_ssl_cache_shm_context *cache );
+
+/**
+ * \brief          Create or attach to the shared cache in a file
+ *
+ *                 If the file is empty or does not exist, it is
+ *                 initialized as an empty cache. If it already holds a
+ *                 cache with the same geometry, the context attaches to
+ *                 it and its entries are kept. Any other file is left
+ *                 untouched, since other processes may still use it.
+ *
+ * \note           Call this in the parent before forking the worker
+ *                 processes, or in each process with the same path and
+ *                 geometry. Placing the file on a memory-backed file
+ *                 system (such as /dev/shm) avoids disk writes.
+ *
+ * \note           To change the geometry, remove the file and call this
+ *                 function again. Processes still attached to the former
+ *                 file keep using it until they detach.
+ *
+ * \warning        The file holds the master secrets of the cached
+ *                 sessions. It is created readable by its owner only:
+ *                 keep it out of reach of other users.
+ *
+ * \note           Sessions that do not fit in \p slot_size bytes once
+ *                 serialized with mbedtls_ssl_session_save() are not
+ *                 cached. Without client authentication, a TLS 1.2
+ *                 session takes about 150 bytes. With
+ *                 MBEDTLS_SSL_KEEP_PEER_CERTIFICATE, the client
+ *                 certificate is stored as well.
+ *
+ * \param cache    Shared cache context
+ * \param path     File to map. It is created if it does not exist.
+ * \param slots    Number of sessions the cache can hold, rounded up
+ *                 to a multiple of 4
+ * \param slot_size Maximum size of a serialized session
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA if a parameter is invalid,
+ *                 or if the file is not empty and does not hold a cache
+ *                 with this geometry,
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED if the file could not be
+ *                 opened, sized or mapped.
+ */
+int mbedtls_ssl_cache_shm_setup( mbedtls_ssl_cache_shm_context *cache,
+                                 const char *path,
+                                 size_t slots, size_t slot_size );
+
+/**
+ * \brief          Cache get callback implementation
+ *                 (Safe across processes, and across threads if
+ *                 MBEDTLS_THREADING_C is enabled)
+ *
+ * \param data     Shared cache context
+ * \param session  session to retrieve entry for
+ */
+int mbedtls_ssl_cache_shm_get( void *data, mbedtls_ssl_session *session );
+
+/**
+ * \brief          Cache set callback implementation
+ *                 (Safe across processes, and across threads if
+ *                 MBEDTLS_THREADING_C is enabled)
+ *
+ * \param data     Shared cache context
+ * \param session  session to store entry for
+ */
+int mbedtls_ssl_cache_shm_set( void *data, const mbedtls_ssl_session *session );
+
+#if defined(MBEDTLS_HAVE_TIME)
+/**
+ * \brief          Set the cache timeout
+ *                 (Default: MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT (1 day))
+ *
+ *                 A timeout of 0 indicates no timeout. The timeout applies
+ *                 to lookups made through this context.
+ *
+ * \param cache    Shared cache context
+ * \param timeout  cache entry timeout in seconds
+ */
+void mbedtls_ssl_cache_shm_set_timeout( mbedtls_ssl_cache_shm_context *cache,
+                                        int timeout );
+#endif /* MBEDTLS_HAVE_TIME */
+
+/**
+ * \brief          Detach from the shared cache and clear the context
+ *
+ * \note           The file and the sessions it holds are left in place
+ *                 for the other processes. Remove the file once no
+ *                 process uses it any more.
+ *
+ * \param cache    Shared cache context
+ */
+void mbedtls_ssl_cache_shm_free( mbedtls_ssl_cache_shm_context *cache );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_cache_shm.h */
@@ -167,6 +167,14 @@
 #define MBEDTLS_SSL_SOME_MODES_USE_MAC
 #endif
 
+/* This macro determines whether the ECDHE_ECDSA key exchange of TLS 1.2
+ * may be authenticated with Ed25519 certificates (RFC 8422). */
+#if defined(MBEDTLS_ED25519_C) &&                       \
+    defined(MBEDTLS_SSL_PROTO_TLS1_2) &&                \
+    defined(MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED)
+#define MBEDTLS_SSL_ED25519_ENABLED
+#endif
+
 #if defined(MBEDTLS_SSL_SOME_MODES_USE_MAC)
 /* Ciphersuites using HMAC */
 #if defined(MBEDTLS_SHA512_C)
@@ -209,6 +217,9 @@
 /* The maximum number of buffered handshake messages. */
 #define MBEDTLS_SSL_MAX_BUFFERED_HS 4
 
+/* The maximum number of records held back for a single vectored send. */
+#define MBEDTLS_SSL_OUT_QUEUE_MAX 8
+
 /* Maximum length we can advertise as our max content length for
    RFC 6066 max_fragment_length extension negotiation purposes
    (the lesser of both sizes, if they are unequal.)
@@ -370,6 +381,10 @@ struct mbedtls_ssl_sig_hash_set_t
      * to hash algorithms. */
     mbedtls_md_type_t rsa;
     mbedtls_md_type_t ecdsa;
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+    /* Ed25519 has no separate hash: just remember whether it was offered */
+    unsigned char ed25519;
+#endif
 };
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2 &&
           MBEDTLS_KEY_EXCHANGE_WITH_CERT_ENABLED */
@@ -626,6 +641,26 @@ struct mbedtls_ssl_handshake_params
 
 typedef struct mbedtls_ssl_hs_buffer mbedtls_ssl_hs_buffer;
 
+/*
+ * Sealed TLS records waiting to be sent in one go through the vectored send
+ * callback: the records of a handshake flight, or those of an application
+ * data write longer than one record.
+ */
+struct mbedtls_ssl_out_queue
+{
+    struct
+    {
+        unsigned char *data;            /*!< Heap copy of the record     */
+        size_t len;                     /*!< Length of the record        */
+    } rec[MBEDTLS_SSL_OUT_QUEUE_MAX];
+    size_t cnt;                         /*!< Number of queued records    */
+    size_t sent;                        /*!< Bytes of rec[0] already sent */
+    size_t app_len;                     /*!< Application data covered by
+                                             the pending records, to be
+                                             returned by the retried
+                                             mbedtls_ssl_write()         */
+};
+
 /*
  * Representation of decryption/encryption transformations on records
  *
@@ -760,6 +795,13 @@ struct mbedtls_ssl_transform
     mbedtls_cipher_context_t cipher_ctx_dec;    /*!<  decryption context      */
     int minor_ver;
 
+#if defined(MBEDTLS_SSL_KTLS)
+    /* Kept for mbedtls_ssl_export_record_keys() */
+    unsigned char key_enc[32];          /*!<  Key (encryption)        */
+    unsigned char key_dec[32];          /*!<  Key (decryption)        */
+    size_t keylen;                      /*!<  Length of the keys      */
+#endif /* MBEDTLS_SSL_KTLS */
+
 #if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
     uint8_t in_cid_len;
     uint8_t out_cid_len;
@@ -1117,6 +1159,26 @@ static inline mbedtls_ssl_srtp_profile mbedtls_ssl_check_srtp_profile_value
 }
 #endif
 
+#if defined(MBEDTLS_SSL_CACHE_C) || defined(MBEDTLS_SSL_CACHE_SHM_C)
+/*
+ * FNV-1a hash of a session ID, for indexing session caches
+ */
+static inline uint32_t mbedtls_ssl_session_id_hash( const unsigned char *id,
+                                                    size_t id_len )
+{
+    uint32_t hash = 0x811C9DC5;
+    size_t i;
+
+    for( i = 0; i < id_len; i++ )
+    {
+        hash ^= id[i];
+        hash *= 0x01000193;
+    }
+
+    return( hash );
+}
+#endif /* MBEDTLS_SSL_CACHE_C || MBEDTLS_SSL_CACHE_SHM_C */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 static inline mbedtls_pk_context *mbedtls_ssl_own_key( mbedtls_ssl_context *ssl )
 {
@@ -1290,6 +1352,11 @@ void mbedtls_ssl_update_in_pointers( mbedtls_ssl_context *ssl );
 
 int mbedtls_ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial );
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+int mbedtls_ssl_buffers_acquire( mbedtls_ssl_context *ssl );
+void mbedtls_ssl_buffers_release_idle( mbedtls_ssl_context *ssl );
+#endif
+
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
 void mbedtls_ssl_dtls_replay_reset( mbedtls_ssl_context *ssl );
 #endif
@@ -1300,6 +1367,8 @@ void mbedtls_ssl_handshake_wrapup_free_hs_transform( mbedtls_ssl_context *ssl );
 int mbedtls_ssl_start_renegotiation( mbedtls_ssl_context *ssl );
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
+void mbedtls_ssl_out_queue_free( mbedtls_ssl_context *ssl );
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 size_t mbedtls_ssl_get_current_mtu( const mbedtls_ssl_context *ssl );
 void mbedtls_ssl_buffering_free( mbedtls_ssl_context *ssl );
@@ -0,0 +1,213 @@
+/**
+ * \file ssl_key_pool.h
+ *
+ * \brief SSL ephemeral ECDHE key pool implementation
+ *
+ * A key pool holds single-use ECDHE key pairs generated ahead of time, so
+ * that a server does not have to generate one in the middle of each
+ * handshake. The pool is refilled by the application, for example from a
+ * dedicated thread or whenever the server is idle, or from a background
+ * thread of its own with MBEDTLS_THREADING_THREADS, and drained by the
+ * SSL/TLS layer through mbedtls_ssl_conf_ecdhe_key_cb().
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MBEDTLS_SSL_KEY_POOL_H
+#define MBEDTLS_SSL_KEY_POOL_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/ecp.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   The pre-generated key pairs of one curve
+ */
+typedef struct mbedtls_ssl_key_pool_curve
+{
+    mbedtls_ecp_group_id grp_id;        /*!< curve of the key pairs     */
+    mbedtls_mpi *d;                     /*!< private keys               */
+    mbedtls_ecp_point *Q;               /*!< public keys                */
+    size_t count;                       /*!< number of key pairs held   */
+}
+mbedtls_ssl_key_pool_curve;
+
+/**
+ * \brief   Key pool context
+ */
+typedef struct mbedtls_ssl_key_pool
+{
+    mbedtls_ssl_key_pool_curve *curves; /*!< one entry per curve        */
+    size_t nb_curves;                   /*!< number of curves           */
+    size_t size;                        /*!< key pairs held per curve   */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex                      */
+#endif
+#if defined(MBEDTLS_THREADING_THREADS)
+    int (*f_rng)(void *, unsigned char *, size_t); /*!< RNG for background
+                                                        refills, or NULL  */
+    void *p_rng;                        /*!< RNG parameter              */
+    int background;                     /*!< refill in the background   */
+    int refill_pending;                 /*!< a refill was requested     */
+    mbedtls_threading_thread_t thread;  /*!< background refill thread   */
+    int thread_state;                   /*!< whether \c thread is
+                                             running or must be joined  */
+#endif
+}
+mbedtls_ssl_key_pool;
+
+/**
+ * \brief          Initialize a key pool context
+ *
+ * \param pool     key pool context
+ */
+void mbedtls_ssl_key_pool_init( mbedtls_ssl_key_pool *pool );
+
+/**
+ * \brief          Set up a key pool for a list of curves. The pool is
+ *                 empty until mbedtls_ssl_key_pool_refill() is called.
+ *
+ * \param pool     key pool context
+ * \param curves   list of curves to pre-generate key pairs for,
+ *                 terminated by MBEDTLS_ECP_DP_NONE, for example the list
+ *                 given to mbedtls_ssl_conf_curves()
+ * \param size     number of key pairs to hold per curve
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA if \p size is 0 or a curve
+ *                 is not supported,
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED if memory allocation failed
+ */
+int mbedtls_ssl_key_pool_setup( mbedtls_ssl_key_pool *pool,
+                                const mbedtls_ecp_group_id *curves,
+                                size_t size );
+
+/**
+ * \brief          Generate key pairs until the pool is full
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ *                 Key pairs are generated without holding the pool's
+ *                 mutex, so handshakes can keep drawing from the pool
+ *                 while it is refilled from another thread.
+ *
+ * \param pool     key pool context
+ * \param f_rng    RNG function
+ * \param p_rng    RNG parameter
+ *
+ * \return         0 if successful, or an MBEDTLS_ERR_ECP_XXX or
+ *                 MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ssl_key_pool_refill( mbedtls_ssl_key_pool *pool,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+
+#if defined(MBEDTLS_THREADING_THREADS)
+/**
+ * \brief          Refill the pool from a background thread from now on
+ *
+ *                 A thread started with mbedtls_thread_create() refills
+ *                 the pool at once, and again whenever
+ *                 mbedtls_ssl_key_pool_get() leaves a curve with half of
+ *                 \c size key pairs or less. At most one such thread runs
+ *                 at a time.
+ *
+ * \note           \p f_rng is called from the background thread while
+ *                 other threads may use it too, so it must be thread-safe,
+ *                 as mbedtls_ctr_drbg_random() is with MBEDTLS_THREADING_C.
+ *
+ * \param pool     key pool context, already set up
+ * \param f_rng    RNG function
+ * \param p_rng    RNG parameter
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA if \p pool is not set up,
+ *                 MBEDTLS_ERR_THREADING_THREAD_ERROR if the thread could
+ *                 not be started, or
+ *                 MBEDTLS_ERR_THREADING_MUTEX_ERROR on a mutex failure
+ */
+int mbedtls_ssl_key_pool_start_refill( mbedtls_ssl_key_pool *pool,
+                                       int (*f_rng)(void *, unsigned char *,
+                                                    size_t),
+                                       void *p_rng );
+
+/**
+ * \brief          Stop refilling the pool in the background, after
+ *                 waiting for the refills already requested to finish.
+ *                 This is also done by mbedtls_ssl_key_pool_free().
+ *
+ * \param pool     key pool context
+ */
+void mbedtls_ssl_key_pool_stop_refill( mbedtls_ssl_key_pool *pool );
+#endif /* MBEDTLS_THREADING_THREADS */
+
+/**
+ * \brief          Key pair get callback implementation, for use with
+ *                 mbedtls_ssl_conf_ecdhe_key_cb()
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ *                 The key pair is removed from the pool, so that it is
+ *                 only ever used for one handshake.
+ *                 This may start a background refill, see
+ *                 mbedtls_ssl_key_pool_start_refill().
+ *
+ * \param data     key pool context
+ * \param grp_id   curve to get a key pair for
+ * \param key      initialized key pair to move the key pair into
+ *
+ * \return         0 if a key pair was retrieved, 1 if the pool holds none
+ *                 for this curve
+ */
+int mbedtls_ssl_key_pool_get( void *data, mbedtls_ecp_group_id grp_id,
+                              mbedtls_ecp_keypair *key );
+
+/**
+ * \brief          Get the number of key pairs the pool holds for a curve
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ * \param pool     key pool context
+ * \param grp_id   curve to count key pairs for
+ *
+ * \return         the number of key pairs available for \p grp_id
+ */
+size_t mbedtls_ssl_key_pool_count( mbedtls_ssl_key_pool *pool,
+                                   mbedtls_ecp_group_id grp_id );
+
+/**
+ * \brief          Free referenced items in a key pool context and clear
+ *                 memory, including the private keys it still holds
+ *
+ * \param pool     key pool context
+ */
+void mbedtls_ssl_key_pool_free( mbedtls_ssl_key_pool *pool );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_key_pool.h */
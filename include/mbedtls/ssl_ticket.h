@@ -45,24 +45,71 @@
 extern "C" {
 #endif
 
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_SSL_TICKET_MAX_KEYS)
+#define MBEDTLS_SSL_TICKET_MAX_KEYS     4   /*!< Maximum number of keys kept at once */
+#endif
+
+#if !defined(MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE)
+#define MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE 4 /*!< Prepared cipher contexts kept per key */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#define MBEDTLS_SSL_TICKET_KEY_NAME_BYTES   4   /*!< Length of a key name     */
+#define MBEDTLS_SSL_TICKET_MAX_KEY_BYTES   32   /*!< Maximum length of a key  */
+
 /**
  * \brief   Information for session ticket protection
  */
 typedef struct mbedtls_ssl_ticket_key
 {
-    unsigned char name[4];          /*!< random key identifier              */
+    unsigned char name[MBEDTLS_SSL_TICKET_KEY_NAME_BYTES]; /*!< key identifier */
     uint32_t generation_time;       /*!< key generation timestamp (seconds) */
-    mbedtls_cipher_context_t ctx;   /*!< context for auth enc/decryption    */
+    unsigned char key[MBEDTLS_SSL_TICKET_MAX_KEY_BYTES]; /*!< key material  */
 }
 mbedtls_ssl_ticket_key;
 
+/**
+ * \brief   Set of session ticket protection keys
+ *
+ *          The keys of a set are never modified once published in a
+ *          context: key rotation publishes a new set, and the previous one
+ *          is freed once the last ticket operation using it is done.
+ *
+ *          Each key comes with a pool of cipher contexts that are already
+ *          set up with it, taken by ticket operations and given back when
+ *          done, under the context's mutex. Rotation hands the pools of the
+ *          keys that are kept over to the new set.
+ */
+typedef struct mbedtls_ssl_ticket_key_set
+{
+    mbedtls_ssl_ticket_key keys[MBEDTLS_SSL_TICKET_MAX_KEYS]; /*!< keys,
+                                                 the active one first   */
+    size_t count;                   /*!< number of keys in the set          */
+    size_t refs;                    /*!< number of users of the set         */
+    mbedtls_cipher_context_t *ciphers[MBEDTLS_SSL_TICKET_MAX_KEYS]
+                                     [MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE];
+                                    /*!< prepared cipher contexts, per key  */
+    size_t cipher_count[MBEDTLS_SSL_TICKET_MAX_KEYS]; /*!< number of
+                                         prepared contexts, per key     */
+}
+mbedtls_ssl_ticket_key_set;
+
 /**
  * \brief   Context for session ticket handling functions
  */
 typedef struct mbedtls_ssl_ticket_context
 {
-    mbedtls_ssl_ticket_key keys[2]; /*!< ticket protection keys             */
-    unsigned char active;           /*!< index of the currently active key  */
+    mbedtls_ssl_ticket_key_set *keys; /*!< current ticket protection keys   */
+    const mbedtls_cipher_info_t *cipher_info; /*!< AEAD cipher for tickets  */
 
     uint32_t ticket_lifetime;       /*!< lifetime of tickets in seconds     */
 
@@ -71,7 +118,16 @@ typedef struct mbedtls_ssl_ticket_context
     void *p_rng;                    /*!< context for the RNG function       */
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_threading_mutex_t mutex;
+    mbedtls_threading_mutex_t mutex; /*!< protects \c keys, the reference
+                                          counts of the key sets and their
+                                          pools of cipher contexts          */
+#endif
+#if defined(MBEDTLS_THREADING_THREADS) && defined(MBEDTLS_HAVE_TIME)
+    int background;                 /*!< rotate keys in the background      */
+    int rotation_pending;           /*!< a rotation was requested           */
+    mbedtls_threading_thread_t thread; /*!< background rotation thread      */
+    int thread_state;               /*!< whether \c thread is running or
+                                         must be joined                     */
 #endif
 }
 mbedtls_ssl_ticket_context;
@@ -104,6 +160,10 @@ void mbedtls_ssl_ticket_init( mbedtls_ssl_ticket_context *ctx );
  *                  It is recommended to pick a reasonnable lifetime so as not
  *                  to negate the benefits of forward secrecy.
  *
+ * \note            Tickets are protected and checked without holding the
+ *                  context's mutex, so \p f_rng must be thread-safe if
+ *                  tickets are handled by several threads.
+ *
  * \return          0 if successful,
  *                  or a specific MBEDTLS_ERR_XXX error code
  */
@@ -112,6 +172,94 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
     mbedtls_cipher_type_t cipher,
     uint32_t lifetime );
 
+/**
+ * \brief           Rotate the session ticket keys.
+ *
+ *                  Make a new key active for ticket protection. The
+ *                  previously active keys are kept for parsing tickets
+ *                  issued with them, up to #MBEDTLS_SSL_TICKET_MAX_KEYS
+ *                  keys in total, the oldest ones being discarded first.
+ *                  With MBEDTLS_HAVE_TIME, a key is also discarded once
+ *                  all the tickets it protected have expired.
+ *
+ *                  If \p name and \p k are NULL, a new key is generated
+ *                  with the RNG given to mbedtls_ssl_ticket_setup().
+ *                  Otherwise, the key is taken from the caller. This lets
+ *                  several servers share their ticket keys, so that a
+ *                  ticket issued by one of them is accepted by the others.
+ *
+ * \note            The ticket write and parse callbacks rotate the keys
+ *                  themselves when the active key is older than the ticket
+ *                  lifetime. Calling this function periodically, at an
+ *                  interval shorter than the ticket lifetime, from a
+ *                  thread or timer of the application, keeps key
+ *                  generation out of the handshakes. So does
+ *                  mbedtls_ssl_ticket_start_rotation(), with
+ *                  MBEDTLS_THREADING_THREADS.
+ *
+ * \note            Keep the ticket lifetime divided by the rotation
+ *                  interval below #MBEDTLS_SSL_TICKET_MAX_KEYS, otherwise
+ *                  tickets are rejected before they expire.
+ *
+ * \param ctx       Context set up with mbedtls_ssl_ticket_setup()
+ * \param name      Name of the new key, or NULL to generate the key.
+ *                  Should be random, so that keys from different sources
+ *                  do not collide.
+ * \param nlength   Length of \p name in bytes, which must be
+ *                  #MBEDTLS_SSL_TICKET_KEY_NAME_BYTES
+ * \param k         New key, or NULL to generate the key. Should be
+ *                  random.
+ * \param klength   Length of \p k in bytes, which must be at least the
+ *                  key length of the cipher given to
+ *                  mbedtls_ssl_ticket_setup()
+ *
+ * \return          0 if successful,
+ *                  MBEDTLS_ERR_SSL_BAD_INPUT_DATA if a parameter is invalid,
+ *                  MBEDTLS_ERR_SSL_ALLOC_FAILED if memory allocation failed,
+ *                  or a specific MBEDTLS_ERR_XXX error code
+ */
+int mbedtls_ssl_ticket_rotate( mbedtls_ssl_ticket_context *ctx,
+                               const unsigned char *name, size_t nlength,
+                               const unsigned char *k, size_t klength );
+
+#if defined(MBEDTLS_THREADING_THREADS) && defined(MBEDTLS_HAVE_TIME)
+/**
+ * \brief           Rotate the session ticket keys from a background thread
+ *                  from now on.
+ *
+ *                  A thread started with mbedtls_thread_create() generates
+ *                  a new active key whenever the ticket write or parse
+ *                  callback finds the active key older than half of the
+ *                  ticket lifetime, so that the handshakes never have to
+ *                  wait for key generation. At most one such thread runs at
+ *                  a time.
+ *
+ * \note            The RNG given to mbedtls_ssl_ticket_setup() is called
+ *                  from the background thread while other threads may use
+ *                  it too, so it must be thread-safe, as
+ *                  mbedtls_ctr_drbg_random() is with MBEDTLS_THREADING_C.
+ *
+ * \param ctx       Context set up with mbedtls_ssl_ticket_setup(), with a
+ *                  nonzero ticket lifetime
+ *
+ * \return          0 if successful,
+ *                  MBEDTLS_ERR_SSL_BAD_INPUT_DATA if \p ctx is not set up,
+ *                  MBEDTLS_ERR_THREADING_THREAD_ERROR if the thread could
+ *                  not be started, or
+ *                  MBEDTLS_ERR_THREADING_MUTEX_ERROR on a mutex failure
+ */
+int mbedtls_ssl_ticket_start_rotation( mbedtls_ssl_ticket_context *ctx );
+
+/**
+ * \brief           Stop rotating the keys in the background, after waiting
+ *                  for the rotation already requested to finish.
+ *                  This is also done by mbedtls_ssl_ticket_free().
+ *
+ * \param ctx       Context to stop rotating the keys of
+ */
+void mbedtls_ssl_ticket_stop_rotation( mbedtls_ssl_ticket_context *ctx );
+#endif /* MBEDTLS_THREADING_THREADS && MBEDTLS_HAVE_TIME */
+
 /**
  * \brief           Implementation of the ticket write callback
  *
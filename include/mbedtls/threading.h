@@ -40,6 +40,7 @@ extern "C" {
 
 #define MBEDTLS_ERR_THREADING_BAD_INPUT_DATA              -0x001C  /**< Bad input parameters to function. */
 #define MBEDTLS_ERR_THREADING_MUTEX_ERROR                 -0x001E  /**< Locking / unlocking / free failed with error code. */
+#define MBEDTLS_ERR_THREADING_THREAD_ERROR                -0x001F  /**< Creating or joining a thread failed. */
 
 #if defined(MBEDTLS_THREADING_PTHREAD)
 #include <pthread.h>
@@ -51,6 +52,15 @@ typedef struct mbedtls_threading_mutex_t
      * API of Mbed TLS and may change without notice. */
     char is_valid;
 } mbedtls_threading_mutex_t;
+
+#if defined(MBEDTLS_THREADING_THREADS)
+typedef struct mbedtls_threading_thread_t
+{
+    pthread_t thread;
+    void (*func)( void * );
+    void *arg;
+} mbedtls_threading_thread_t;
+#endif /* MBEDTLS_THREADING_THREADS */
 #endif
 
 #if defined(MBEDTLS_THREADING_ALT)
@@ -84,6 +94,27 @@ void mbedtls_threading_set_alt( void (*mutex_init)( mbedtls_threading_mutex_t *
  * \brief               Free global mutexes.
  */
 void mbedtls_threading_free_alt( void );
+
+#if defined(MBEDTLS_THREADING_THREADS)
+/**
+ * \brief           Set your alternate thread creation function pointers.
+ *                  The mbedtls_threading_thread_t type must be defined in
+ *                  threading_alt.h. If used, this function must be called
+ *                  once in the main thread before any other mbed TLS
+ *                  function is called.
+ *
+ * \note            thread_create() returns 0 if the thread was started, in
+ *                  which case thread_join() will be called exactly once on
+ *                  it, and a nonzero value otherwise.
+ *
+ * \param thread_create the thread creation function implementation
+ * \param thread_join   the thread join function implementation
+ */
+void mbedtls_threading_set_thread_alt( int (*thread_create)( mbedtls_threading_thread_t *,
+                                                             void (*)( void * ),
+                                                             void * ),
+                                       int (*thread_join)( mbedtls_threading_thread_t * ) );
+#endif /* MBEDTLS_THREADING_THREADS */
 #endif /* MBEDTLS_THREADING_ALT */
 
 #if defined(MBEDTLS_THREADING_C)
@@ -97,6 +128,20 @@ extern void (*mbedtls_mutex_free)( mbedtls_threading_mutex_t *mutex );
 extern int (*mbedtls_mutex_lock)( mbedtls_threading_mutex_t *mutex );
 extern int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t *mutex );
 
+#if defined(MBEDTLS_THREADING_THREADS)
+/*
+ * The function pointers for thread_create and thread_join
+ *
+ * thread_create starts a thread running func( arg ) and returns 0, or
+ * returns MBEDTLS_ERR_THREADING_THREAD_ERROR if no thread could be started.
+ * Callers must then be able to do the work themselves. thread_join waits
+ * for a started thread to finish.
+ */
+extern int (*mbedtls_thread_create)( mbedtls_threading_thread_t *thread,
+                                     void (*func)( void * ), void *arg );
+extern int (*mbedtls_thread_join)( mbedtls_threading_thread_t *thread );
+#endif /* MBEDTLS_THREADING_THREADS */
+
 /*
  * Global mutexes
  */
@@ -104,6 +149,10 @@ extern int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t *mutex );
 extern mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex;
 #endif
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+extern mbedtls_threading_mutex_t mbedtls_threading_ecp_tables_mutex;
+#endif
+
 #if defined(MBEDTLS_HAVE_TIME_DATE) && !defined(MBEDTLS_PLATFORM_GMTIME_R_ALT)
 /* This mutex may or may not be used in the default definition of
  * mbedtls_platform_gmtime_r(), but in order to determine that,
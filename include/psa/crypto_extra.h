@@ -660,6 +660,56 @@ mbedtls_ecp_group_id mbedtls_ecc_group_of_psa( psa_ecc_family_t curve,
 
 /**@}*/
 
+/** \defgroup psa_batch_verify Batch signature verification
+ * @{
+ */
+
+/** A signature to verify with psa_verify_hash_batch().
+ *
+ * The input fields have the same meaning as the parameters of
+ * psa_verify_hash().
+ */
+typedef struct psa_verify_hash_batch_entry_s
+{
+    mbedtls_svc_key_id_t key;   /**< The key to use. */
+    psa_algorithm_t alg;        /**< The signature algorithm. */
+    const uint8_t *hash;        /**< The hash whose signature is to be verified. */
+    size_t hash_length;         /**< The size of the \c hash buffer in bytes. */
+    const uint8_t *signature;   /**< The signature to verify. */
+    size_t signature_length;    /**< The size of the \c signature buffer in bytes. */
+    psa_status_t status;        /**< Output: the result for this signature,
+                                 *   as psa_verify_hash() would return it. */
+} psa_verify_hash_batch_entry_t;
+
+/** Verify many signatures of hashes at once.
+ *
+ * \warning This function is an experimental extension: its interface may
+ *          change in future versions of the library.
+ *
+ * This is equivalent to calling psa_verify_hash() on each entry, but ECDSA
+ * signatures made with keys on the same curve (with consecutive entries
+ * sharing curves) are verified together with mbedtls_ecdsa_verify_batch(),
+ * which is significantly faster than verifying them one by one. Other
+ * signatures are verified individually.
+ *
+ * \param[in,out] entries   The signatures to verify. On return, the
+ *                          \c status field of each entry holds the result
+ *                          for that signature.
+ * \param count             The number of entries.
+ *
+ * \retval #PSA_SUCCESS
+ *         All the signatures are valid.
+ * \retval #PSA_ERROR_INSUFFICIENT_MEMORY
+ *         The signatures could not be verified. The \c status fields of the
+ *         entries are not meaningful.
+ * \return The \c status field of the first entry that failed otherwise,
+ *         typically #PSA_ERROR_INVALID_SIGNATURE.
+ */
+psa_status_t psa_verify_hash_batch( psa_verify_hash_batch_entry_t *entries,
+                                    size_t count );
+
+/**@}*/
+
 /** \defgroup psa_external_rng External random generator
  * @{
  */
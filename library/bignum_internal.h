@@ -0,0 +1,154 @@
+/**
+ * \file bignum_internal.h
+ *
+ * \brief Internal bignum functions, for use by other library modules only
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef MBEDTLS_BIGNUM_INTERNAL_H
+#define MBEDTLS_BIGNUM_INTERNAL_H
+
+#include "common.h"
+
+#include "mbedtls/bignum.h"
+
+/**
+ * \brief          Raise several numbers to the same exponent modulo the
+ *                 same modulus: X[i] = X[i]^E mod N.
+ *
+ *                 Unlike mbedtls_mpi_exp_mod(), this uses a plain binary
+ *                 method whose sequence of operations depends on \p E,
+ *                 so \p E must not be secret. It is meant for small public
+ *                 exponents such as RSA's 65537, for which it needs fewer
+ *                 operations than the sliding-window method.
+ *
+ * \param X        The array of \p count numbers to raise. Each of them
+ *                 must satisfy 0 <= X[i] < N, and receives its result.
+ * \param count    The number of entries of \p X.
+ * \param E        The exponent. This must be positive.
+ * \param N        The modulus. This must be positive and odd.
+ * \param _RR      Optional cache for R^2 mod N, as for
+ *                 mbedtls_mpi_exp_mod(). This may be \c NULL.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N, \p E or one of
+ *                 the entries of \p X is out of range.
+ */
+int mbedtls_mpi_exp_mod_batch( mbedtls_mpi X[], size_t count,
+                               const mbedtls_mpi *E, const mbedtls_mpi *N,
+                               mbedtls_mpi *_RR );
+
+/**
+ * \brief          Raise 2 to a possibly secret power: X = 2^E mod N.
+ *
+ *                 This gives the same result as mbedtls_mpi_exp_mod() with
+ *                 a base of 2, such as the generator of the Diffie-Hellman
+ *                 groups of RFC 3526 and RFC 7919, but replaces the
+ *                 multiplications by the base with modular doublings. Its
+ *                 sequence of operations only depends on the number of
+ *                 limbs of \p E.
+ *
+ * \param X        The destination MPI.
+ * \param E        The exponent. This must not be negative.
+ * \param N        The modulus. This must be positive and odd.
+ * \param _RR      Optional cache for R^2 mod N, as for
+ *                 mbedtls_mpi_exp_mod(). This may be \c NULL.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N or \p E is out of
+ *                 range.
+ */
+int mbedtls_mpi_exp_mod_base2( mbedtls_mpi *X, const mbedtls_mpi *E,
+                               const mbedtls_mpi *N, mbedtls_mpi *_RR );
+
+#if defined(MBEDTLS_GENPRIME)
+/**
+ * \brief          Draw the starting point of a sieve-based prime search,
+ *                 as done by mbedtls_mpi_gen_prime().
+ *
+ * \param X        The destination MPI.
+ * \param nbits    The size of the prime to generate in bits.
+ * \param flags    A mask of flags of type #mbedtls_mpi_gen_prime_flag_t.
+ * \param f_rng    The RNG function to use. This must not be \c NULL.
+ * \param p_rng    The RNG parameter to be passed to \p f_rng.
+ *
+ * \return         \c 0 if successful.
+ * \return         A negative error code on failure.
+ */
+int mbedtls_mpi_gen_prime_start( mbedtls_mpi *X, size_t nbits, int flags,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+
+/**
+ * \brief          Build the table of small primes that
+ *                 mbedtls_mpi_gen_prime_range() sieves with.
+ *
+ *                 The table only depends on the library build, so it can
+ *                 be built once and shared, read-only, by any number of
+ *                 searches and threads.
+ *
+ * \param primes   On success, a table allocated with mbedtls_calloc(),
+ *                 which the caller must release with mbedtls_free().
+ * \param nprimes  On success, the number of entries in \p primes.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ */
+int mbedtls_mpi_gen_prime_table( uint16_t **primes, size_t *nprimes );
+
+/**
+ * \brief          Search part of the window starting at \p X for a prime.
+ *
+ *                 Candidates are examined in increasing order, and the
+ *                 result only depends on the starting point, \p first,
+ *                 \p count and the output of \p f_rng. Splitting a window
+ *                 into consecutive ranges and keeping the result of the
+ *                 lowest range that succeeds gives the same prime as
+ *                 searching the whole window at once.
+ *
+ * \param X        On entry, a starting point from
+ *                 mbedtls_mpi_gen_prime_start() with the same \p nbits
+ *                 and \p flags. On success, the prime that was found.
+ * \param nbits    The size of the prime to generate in bits. This must be
+ *                 at least 64.
+ * \param flags    A mask of flags of type #mbedtls_mpi_gen_prime_flag_t.
+ * \param primes   The table from mbedtls_mpi_gen_prime_table().
+ * \param nprimes  The number of entries in \p primes.
+ * \param sieve    Scratch space of at least \p count bytes.
+ * \param first    The index of the first candidate to examine.
+ * \param count    The number of candidates to examine.
+ * \param f_rng    The RNG function for the Miller-Rabin tests.
+ * \param p_rng    The RNG parameter to be passed to \p f_rng.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_NOT_ACCEPTABLE if the range contains
+ *                 no suitable prime, or if its candidates would exceed
+ *                 \p nbits bits.
+ * \return         Another negative error code on failure.
+ */
+int mbedtls_mpi_gen_prime_range( mbedtls_mpi *X, size_t nbits, int flags,
+                                 const uint16_t *primes, size_t nprimes,
+                                 unsigned char *sieve,
+                                 size_t first, size_t count,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+#endif /* MBEDTLS_GENPRIME */
+
+#endif /* MBEDTLS_BIGNUM_INTERNAL_H */
@@ -33,6 +33,8 @@
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
 
+#include "bignum_internal.h"
+
 #include <string.h>
 
 #if defined(MBEDTLS_PEM_PARSE_C)
@@ -119,6 +121,21 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Compute our public value GX = G^X mod P. The generator of the well-known
+ * groups (RFC 3526, RFC 7919) is 2, for which multiplications by G become
+ * modular doublings.
+ */
+static int dhm_make_gx( mbedtls_dhm_context *ctx )
+{
+    if( mbedtls_mpi_cmp_int( &ctx->G, 2 ) == 0 )
+        return( mbedtls_mpi_exp_mod_base2( &ctx->GX, &ctx->X,
+                                           &ctx->P, &ctx->RP ) );
+
+    return( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
+                                 &ctx->P, &ctx->RP ) );
+}
+
 void mbedtls_dhm_init( mbedtls_dhm_context *ctx )
 {
     DHM_VALIDATE( ctx != NULL );
@@ -187,8 +204,7 @@ int mbedtls_dhm_make_params( mbedtls_dhm_context *ctx, int x_size,
     /*
      * Calculate GX = G^X mod P
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
-                          &ctx->P , &ctx->RP ) );
+    MBEDTLS_MPI_CHK( dhm_make_gx( ctx ) );
 
     if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
@@ -302,8 +318,7 @@ int mbedtls_dhm_make_public( mbedtls_dhm_context *ctx, int x_size,
     }
     while( dhm_check_range( &ctx->X, &ctx->P ) != 0 );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
-                          &ctx->P , &ctx->RP ) );
+    MBEDTLS_MPI_CHK( dhm_make_gx( ctx ) );
 
     if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
@@ -261,6 +261,7 @@ static int ecdsa_sign_restartable( mbedtls_ecp_group *grp,
     int *p_sign_tries = &sign_tries, *p_key_tries = &key_tries;
     mbedtls_ecp_point R;
     mbedtls_mpi k, e, t;
+    mbedtls_mpi_modulus N;
     mbedtls_mpi *pk = &k, *pr = r;
 
     /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
@@ -273,9 +274,13 @@ static int ecdsa_sign_restartable( mbedtls_ecp_group *grp,
 
     mbedtls_ecp_point_init( &R );
     mbedtls_mpi_init( &k ); mbedtls_mpi_init( &e ); mbedtls_mpi_init( &t );
+    mbedtls_mpi_modulus_init( &N );
 
     ECDSA_RS_ENTER( sig );
 
+    /* All the arithmetic below is mod n: set up Barrett reduction once */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_setup( &N, &grp->N ) );
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->sig != NULL )
     {
@@ -327,7 +332,7 @@ mul:
                                                           f_rng_blind,
                                                           p_rng_blind,
                                                           ECDSA_RS_ECP ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pr, &R.X, &grp->N ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_reduce( pr, &R.X, &N ) );
         }
         while( mbedtls_mpi_cmp_int( pr, 0 ) == 0 );
 
@@ -349,8 +354,9 @@ modn:
         MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
 
         /*
-         * Generate a random value to blind inv_mod in next step,
-         * avoiding a potential timing leak.
+         * Generate a random value to blind the inversion in next step.
+         * The inversion itself is constant-time; the blinding is kept as
+         * a second line of defence.
          */
         MBEDTLS_MPI_CHK( mbedtls_ecp_gen_privkey( grp, &t, f_rng_blind,
                                                   p_rng_blind ) );
@@ -358,14 +364,13 @@ modn:
         /*
          * Step 6: compute s = (e + r * d) / k = t (e + rd) / (kt) mod n
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, pr, d ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( s, pr, d, &N ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, s ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &e, &e, &t ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( pk, pk, &t ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pk, pk, &grp->N ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( s, pk, &grp->N ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, s, &e ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_reduce( &e, &e, &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &e, &e, &t, &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( pk, pk, &t, &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( s, pk, &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( s, s, &e, &N ) );
     }
     while( mbedtls_mpi_cmp_int( s, 0 ) == 0 );
 
@@ -377,6 +382,7 @@ modn:
 cleanup:
     mbedtls_ecp_point_free( &R );
     mbedtls_mpi_free( &k ); mbedtls_mpi_free( &e ); mbedtls_mpi_free( &t );
+    mbedtls_mpi_modulus_free( &N );
 
     ECDSA_RS_LEAVE( sig );
 
@@ -599,16 +605,19 @@ static int ecdsa_verify_restartable( mbedtls_ecp_group *grp,
                                      const unsigned char *buf, size_t blen,
                                      const mbedtls_ecp_point *Q,
                                      const mbedtls_mpi *r, const mbedtls_mpi *s,
+                                     mbedtls_ecp_keypair *key,
                                      mbedtls_ecdsa_restart_ctx *rs_ctx )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_mpi e, s_inv, u1, u2;
+    mbedtls_mpi_modulus N;
     mbedtls_ecp_point R;
     mbedtls_mpi *pu1 = &u1, *pu2 = &u2;
 
     mbedtls_ecp_point_init( &R );
     mbedtls_mpi_init( &e ); mbedtls_mpi_init( &s_inv );
     mbedtls_mpi_init( &u1 ); mbedtls_mpi_init( &u2 );
+    mbedtls_mpi_modulus_init( &N );
 
     /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
     if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
@@ -616,6 +625,8 @@ static int ecdsa_verify_restartable( mbedtls_ecp_group *grp,
 
     ECDSA_RS_ENTER( ver );
 
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_setup( &N, &grp->N ) );
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->ver != NULL )
     {
@@ -651,11 +662,8 @@ static int ecdsa_verify_restartable( mbedtls_ecp_group *grp,
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &s_inv, s, &grp->N ) );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( pu1, &e, &s_inv ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pu1, pu1, &grp->N ) );
-
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( pu2, r, &s_inv ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pu2, pu2, &grp->N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( pu1, &e, &s_inv, &N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( pu2, r, &s_inv, &N ) );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->ver != NULL )
@@ -666,6 +674,21 @@ muladd:
     /*
      * Step 5: R = u1 G + u2 Q
      */
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    /* Use the pre-computed tables of the key, if any, unless we may have
+     * to restart */
+    if( key != NULL
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+        && ( rs_ctx == NULL || ! mbedtls_ecp_restart_is_enabled() )
+#endif
+      )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_keypair_muladd( key, &R, pu1, pu2 ) );
+    }
+    else
+#else
+    (void) key;
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
     MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_restartable( grp,
                      &R, pu1, &grp->G, pu2, Q, ECDSA_RS_ECP ) );
 
@@ -679,7 +702,7 @@ muladd:
      * Step 6: convert xR to an integer (no-op)
      * Step 7: reduce xR mod n (gives v)
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &R.X, &R.X, &grp->N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_reduce( &R.X, &R.X, &N ) );
 
     /*
      * Step 8: check if v (that is, R.X) is equal to r
@@ -694,6 +717,7 @@ cleanup:
     mbedtls_ecp_point_free( &R );
     mbedtls_mpi_free( &e ); mbedtls_mpi_free( &s_inv );
     mbedtls_mpi_free( &u1 ); mbedtls_mpi_free( &u2 );
+    mbedtls_mpi_modulus_free( &N );
 
     ECDSA_RS_LEAVE( ver );
 
@@ -715,10 +739,224 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
     ECDSA_VALIDATE_RET( s   != NULL );
     ECDSA_VALIDATE_RET( buf != NULL || blen == 0 );
 
-    return( ecdsa_verify_restartable( grp, buf, blen, Q, r, s, NULL ) );
+    return( ecdsa_verify_restartable( grp, buf, blen, Q, r, s, NULL, NULL ) );
+}
+
+/* Size of the random coefficients of batch verification, in Bytes */
+#define ECDSA_BATCH_RAND_BYTES  8
+
+/*
+ * Verify a group of at most MBEDTLS_ECP_BATCH_MAX_SIZE signatures, whose r
+ * and s are known to be in range, with a random linear combination of their
+ * verification equations:
+ *
+ *   sum( a_j u1_j ) G + sum( a_j u2_j Q_j ) = sum( +/- a_j R_j )
+ *
+ * with a_0 = 1 and random a_j otherwise. This only tells whether all the
+ * signatures are valid, not which ones aren't.
+ */
+static int ecdsa_verify_batch_group( mbedtls_ecp_group *grp,
+                                     mbedtls_ecdsa_batch_entry *group[],
+                                     size_t n,
+                                     int (*f_rng)(void *, unsigned char *, size_t),
+                                     void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t j;
+    unsigned char rnd[ECDSA_BATCH_RAND_BYTES];
+    mbedtls_mpi e, u, inv;
+    mbedtls_mpi_modulus N;
+    mbedtls_mpi s_inv[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_mpi a[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_mpi k[MBEDTLS_ECP_BATCH_MAX_SIZE + 1];
+    const mbedtls_mpi *pk[MBEDTLS_ECP_BATCH_MAX_SIZE + 1];
+    const mbedtls_ecp_point *P[MBEDTLS_ECP_BATCH_MAX_SIZE + 1];
+    const mbedtls_mpi *pa[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    const mbedtls_mpi *px[MBEDTLS_ECP_BATCH_MAX_SIZE];
+
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &u ); mbedtls_mpi_init( &inv );
+    mbedtls_mpi_modulus_init( &N );
+    mbedtls_mpi_init( &k[0] );
+    for( j = 0; j < n; j++ )
+    {
+        mbedtls_mpi_init( &s_inv[j] );
+        mbedtls_mpi_init( &a[j] );
+        mbedtls_mpi_init( &k[j + 1] );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_setup( &N, &grp->N ) );
+
+    /*
+     * All s_j^-1 with a single inversion: with s_inv[j] = s_0 ... s_j,
+     * inv = 1 / ( s_0 ... s_j ) gives 1 / s_j = inv * s_inv[j - 1].
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &s_inv[0], group[0]->s ) );
+    for( j = 1; j < n; j++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &s_inv[j], &s_inv[j - 1],
+                                                  group[j]->s, &N ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &inv, &s_inv[n - 1], &grp->N ) );
+
+    for( j = n - 1; j > 0; j-- )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &s_inv[j], &inv,
+                                                  &s_inv[j - 1], &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &inv, &inv,
+                                                  group[j]->s, &N ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &s_inv[0], &inv ) );
+
+    /*
+     * k_0 = sum( a_j u1_j ) for G, k_j+1 = a_j u2_j for Q_j
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &k[0], 0 ) );
+    P[0] = &grp->G;
+    pk[0] = &k[0];
+
+    for( j = 0; j < n; j++ )
+    {
+        if( j == 0 )
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &a[j], 1 ) );
+        }
+        else
+        {
+            MBEDTLS_MPI_CHK( f_rng( p_rng, rnd, sizeof( rnd ) ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &a[j], rnd,
+                                                      sizeof( rnd ) ) );
+            if( mbedtls_mpi_cmp_int( &a[j], 0 ) == 0 )
+                MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &a[j], 1 ) );
+        }
+
+        MBEDTLS_MPI_CHK( derive_mpi( grp, &e, group[j]->buf, group[j]->blen ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &u, &e, &s_inv[j], &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u, &u, &a[j] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &k[0], &k[0], &u ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_reduce( &k[0], &k[0], &N ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &u, group[j]->r, &s_inv[j],
+                                                  &N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_modulus_mul( &k[j + 1], &u, &a[j], &N ) );
+
+        P[j + 1] = group[j]->Q;
+        pk[j + 1] = &k[j + 1];
+        pa[j] = &a[j];
+        px[j] = group[j]->r;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_batch_check( grp, n + 1, pk, P,
+                                                     n, pa, px ) );
+
+cleanup:
+    mbedtls_platform_zeroize( rnd, sizeof( rnd ) );
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &u ); mbedtls_mpi_free( &inv );
+    mbedtls_mpi_modulus_free( &N );
+    mbedtls_mpi_free( &k[0] );
+    for( j = 0; j < n; j++ )
+    {
+        mbedtls_mpi_free( &s_inv[j] );
+        mbedtls_mpi_free( &a[j] );
+        mbedtls_mpi_free( &k[j + 1] );
+    }
+
+    return( ret );
 }
 #endif /* !MBEDTLS_ECDSA_VERIFY_ALT */
 
+/*
+ * Verify a batch of ECDSA signatures, with individual verification of the
+ * signatures of groups that fail
+ */
+int mbedtls_ecdsa_verify_batch( mbedtls_ecp_group *grp,
+                                mbedtls_ecdsa_batch_entry *entries,
+                                size_t count,
+                                int (*f_rng)(void *, unsigned char *, size_t),
+                                void *p_rng )
+{
+    size_t i;
+    mbedtls_ecdsa_batch_entry *entry;
+#if !defined(MBEDTLS_ECDSA_VERIFY_ALT)
+    size_t j, n = 0;
+    mbedtls_ecdsa_batch_entry *group[MBEDTLS_ECP_BATCH_MAX_SIZE];
+#endif
+    ECDSA_VALIDATE_RET( grp     != NULL );
+    ECDSA_VALIDATE_RET( entries != NULL || count == 0 );
+    ECDSA_VALIDATE_RET( f_rng   != NULL );
+
+#if defined(MBEDTLS_ECDSA_VERIFY_ALT)
+    (void) f_rng;
+    (void) p_rng;
+
+    for( i = 0; i < count; i++ )
+    {
+        entry = &entries[i];
+        entry->ret = mbedtls_ecdsa_verify( grp, entry->buf, entry->blen,
+                                           entry->Q, entry->r, entry->s );
+    }
+#else
+    /* Report the failure on every entry, so that a caller that only looks
+     * at the entries does not take them for valid */
+    if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
+    {
+        for( i = 0; i < count; i++ )
+            entries[i].ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        entry = &entries[i];
+
+        /* Signatures with r or s out of range are invalid (step 1) */
+        if( mbedtls_mpi_cmp_int( entry->r, 1 ) < 0 ||
+            mbedtls_mpi_cmp_mpi( entry->r, &grp->N ) >= 0 ||
+            mbedtls_mpi_cmp_int( entry->s, 1 ) < 0 ||
+            mbedtls_mpi_cmp_mpi( entry->s, &grp->N ) >= 0 )
+        {
+            entry->ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+        else
+        {
+            entry->ret = 0;
+            group[n++] = entry;
+        }
+
+        if( n < MBEDTLS_ECP_BATCH_MAX_SIZE && i + 1 < count )
+            continue;
+
+        /* A single signature is cheaper to verify on its own */
+        if( n > 1 &&
+            ecdsa_verify_batch_group( grp, group, n, f_rng, p_rng ) == 0 )
+        {
+            n = 0;
+            continue;
+        }
+
+        for( j = 0; j < n; j++ )
+        {
+            group[j]->ret = ecdsa_verify_restartable( grp,
+                                group[j]->buf, group[j]->blen, group[j]->Q,
+                                group[j]->r, group[j]->s, NULL, NULL );
+        }
+
+        n = 0;
+    }
+#endif /* MBEDTLS_ECDSA_VERIFY_ALT */
+
+    for( i = 0; i < count; i++ )
+    {
+        if( entries[i].ret != 0 )
+            return( entries[i].ret );
+    }
+
+    return( 0 );
+}
+
 /*
  * Convert a signature (given by context) to ASN.1
  */
@@ -889,7 +1127,7 @@ int mbedtls_ecdsa_read_signature_restartable( mbedtls_ecdsa_context *ctx,
         goto cleanup;
 #else
     if( ( ret = ecdsa_verify_restartable( &ctx->grp, hash, hlen,
-                              &ctx->Q, &r, &s, rs_ctx ) ) != 0 )
+                              &ctx->Q, &r, &s, ctx, rs_ctx ) ) != 0 )
         goto cleanup;
 #endif /* MBEDTLS_ECDSA_VERIFY_ALT */
 
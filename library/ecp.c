@@ -560,6 +560,130 @@ static const mbedtls_ecp_curve_info ecp_supported_curves[] =
 
 static mbedtls_ecp_group_id ecp_supported_grp_id[ECP_NB_CURVES];
 
+/*
+ * Window width for the odd multiples of points given to
+ * mbedtls_ecp_muladd(), see ecp_muladd_wnaf().
+ *
+ * Width w needs 2^(w-2) pre-computed points, so width
+ * MBEDTLS_ECP_WINDOW_SIZE + 1 needs as much memory as ecp_mul_comb().
+ */
+#if MBEDTLS_ECP_WINDOW_SIZE < 4
+#define ECP_WNAF_WINDOW         ( MBEDTLS_ECP_WINDOW_SIZE + 1 )
+#else
+#define ECP_WNAF_WINDOW         5
+#endif
+
+/* Window width for the base point, whose table may be kept around */
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+#define ECP_WNAF_G_WINDOW       7
+#else
+#define ECP_WNAF_G_WINDOW       ECP_WNAF_WINDOW
+#endif
+
+#define ECP_WNAF_MAX_WINDOW     8
+#define ECP_WNAF_TABLE_SIZE( w ) ( 1U << ( ( w ) - 2 ) )
+
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+/*
+ * Process-wide tables of pre-computed multiples of the base point of each
+ * built-in curve, indexed like ecp_supported_curves[].
+ *
+ * A table is only computed with the ecp_tables mutex held and is never
+ * modified after being published here, so any number of groups may read it
+ * concurrently.
+ */
+static mbedtls_ecp_point *ecp_shared_T[ECP_NB_CURVES];
+static unsigned char ecp_shared_T_size[ECP_NB_CURVES];
+
+/* Same for the odd multiples used by ecp_muladd_wnaf() */
+static mbedtls_ecp_point *ecp_shared_wnaf_T[ECP_NB_CURVES];
+
+/*
+ * Index of a curve in the shared tables, or -1 if there is none
+ */
+static int ecp_shared_table_index( mbedtls_ecp_group_id grp_id )
+{
+    int i;
+
+    for( i = 0; ecp_supported_curves[i].grp_id != MBEDTLS_ECP_DP_NONE; i++ )
+    {
+        if( ecp_supported_curves[i].grp_id == grp_id )
+            return( i );
+    }
+
+    return( -1 );
+}
+
+/*
+ * Check whether the table attached to a group is a shared one
+ */
+static int ecp_table_is_shared( const mbedtls_ecp_group *grp )
+{
+    int idx, is_shared;
+
+    if( grp->T == NULL || ( idx = ecp_shared_table_index( grp->id ) ) < 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    /* When in doubt, leak the table rather than free a shared one */
+    if( mbedtls_mutex_lock( &mbedtls_threading_ecp_tables_mutex ) != 0 )
+        return( 1 );
+#endif
+
+    is_shared = ( grp->T == ecp_shared_T[idx] );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_ecp_tables_mutex ) != 0 )
+        return( 1 );
+#endif
+
+    return( is_shared );
+}
+
+/*
+ * Free all shared tables
+ */
+void mbedtls_ecp_shared_tables_free( void )
+{
+    size_t i;
+    unsigned char j;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &mbedtls_threading_ecp_tables_mutex ) != 0 )
+        return;
+#endif
+
+    for( i = 0; i < ECP_NB_CURVES; i++ )
+    {
+        if( ecp_shared_T[i] == NULL )
+            continue;
+
+        for( j = 0; j < ecp_shared_T_size[i]; j++ )
+            mbedtls_ecp_point_free( &ecp_shared_T[i][j] );
+        mbedtls_free( ecp_shared_T[i] );
+
+        ecp_shared_T[i] = NULL;
+        ecp_shared_T_size[i] = 0;
+    }
+
+    for( i = 0; i < ECP_NB_CURVES; i++ )
+    {
+        if( ecp_shared_wnaf_T[i] == NULL )
+            continue;
+
+        for( j = 0; j < ECP_WNAF_TABLE_SIZE( ECP_WNAF_G_WINDOW ); j++ )
+            mbedtls_ecp_point_free( &ecp_shared_wnaf_T[i][j] );
+        mbedtls_free( ecp_shared_wnaf_T[i] );
+
+        ecp_shared_wnaf_T[i] = NULL;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &mbedtls_threading_ecp_tables_mutex );
+#endif
+}
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
 /*
  * List of supported curves and associated info
  */
@@ -711,6 +835,10 @@ void mbedtls_ecp_keypair_init( mbedtls_ecp_keypair *key )
     mbedtls_ecp_group_init( &key->grp );
     mbedtls_mpi_init( &key->d );
     mbedtls_ecp_point_init( &key->Q );
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    key->T = NULL;
+    key->T_size = 0;
+#endif
 }
 
 /*
@@ -745,7 +873,11 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_mpi_free( &grp->N );
     }
 
-    if( grp->T != NULL )
+    if( grp->T != NULL
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+        && ! ecp_table_is_shared( grp )
+#endif
+      )
     {
         for( i = 0; i < grp->T_size; i++ )
             mbedtls_ecp_point_free( &grp->T[i] );
@@ -766,6 +898,19 @@ void mbedtls_ecp_keypair_free( mbedtls_ecp_keypair *key )
     mbedtls_ecp_group_free( &key->grp );
     mbedtls_mpi_free( &key->d );
     mbedtls_ecp_point_free( &key->Q );
+
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    if( key->T != NULL )
+    {
+        size_t i;
+
+        for( i = 0; i < key->T_size; i++ )
+            mbedtls_ecp_point_free( &key->T[i] );
+        mbedtls_free( key->T );
+        key->T = NULL;
+        key->T_size = 0;
+    }
+#endif
 }
 
 /*
@@ -1333,7 +1478,7 @@ static int ecp_normalize_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *p
     /*
      * X = X / Z^2  mod p
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &Zi,      &pt->Z,     &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &Zi, &pt->Z, &grp->P ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &ZZi,     &Zi,        &Zi     ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &pt->X,   &pt->X,     &ZZi    ) );
 
@@ -1405,7 +1550,7 @@ static int ecp_normalize_jac_many( const mbedtls_ecp_group *grp,
     /*
      * u = 1 / (Z_0 * ... * Z_n) mod P
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &u, &c[T_size-1], &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &u, &c[T_size-1], &grp->P ) );
 
     for( i = T_size - 1; ; i-- )
     {
@@ -2256,6 +2401,77 @@ static unsigned char ecp_pick_window_size( const mbedtls_ecp_group *grp,
     return( w );
 }
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+/*
+ * Look up the shared table of multiples of the base point of a built-in
+ * curve, computing it first if it doesn't exist yet and can_compute is set.
+ *
+ * On success, *T is the shared table, or NULL if there is none (yet).
+ * The caller must not modify the table or free it.
+ */
+static int ecp_shared_table_get( const mbedtls_ecp_group *grp,
+                                 unsigned char w, size_t d, int can_compute,
+                                 mbedtls_ecp_point **T )
+{
+    int ret = 0;
+    int idx;
+    unsigned char i;
+    const unsigned char T_size = 1U << ( w - 1 );
+    mbedtls_ecp_point *new_T = NULL;
+
+    *T = NULL;
+
+    /* Only groups with static constants are guaranteed to be identical to
+     * any other group with the same identifier. */
+    if( grp->h != 1 || ( idx = ecp_shared_table_index( grp->id ) ) < 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &mbedtls_threading_ecp_tables_mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( ecp_shared_T[idx] == NULL && can_compute )
+    {
+        new_T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) );
+        if( new_T == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_init( &new_T[i] );
+
+        MBEDTLS_MPI_CHK( ecp_precompute_comb( grp, new_T, &grp->G,
+                                              w, d, NULL ) );
+
+        /* publish */
+        ecp_shared_T[idx] = new_T;
+        ecp_shared_T_size[idx] = T_size;
+        new_T = NULL;
+    }
+
+    if( ecp_shared_T_size[idx] == T_size )
+        *T = ecp_shared_T[idx];
+
+cleanup:
+    if( new_T != NULL )
+    {
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_free( &new_T[i] );
+        mbedtls_free( new_T );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_ecp_tables_mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
 /*
  * Multiplication using the comb method - for curves in short Weierstrass form
  *
@@ -2329,6 +2545,25 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     T_size = 1U << ( w - 1 );
     d = ( grp->nbits + w - 1 ) / w;
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    /* Pre-computed table: is there a shared one for the base point? */
+    if( p_eq_g && grp->T == NULL )
+    {
+        int can_compute = 1;
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+        /* Computing the shared table can't be interrupted */
+        if( rs_ctx != NULL && rs_ctx->rsm != NULL )
+            can_compute = 0;
+#endif
+
+        MBEDTLS_MPI_CHK( ecp_shared_table_get( grp, w, d, can_compute,
+                                               &grp->T ) );
+        if( grp->T != NULL )
+            grp->T_size = T_size;
+    }
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
     /* Pre-computed table: do we have it already for the base point? */
     if( p_eq_g && grp->T != NULL )
     {
@@ -2453,7 +2688,7 @@ static int ecp_normalize_mxz( const mbedtls_ecp_group *grp, mbedtls_ecp_point *P
     return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
 #else
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &P->Z, &P->Z, &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &P->Z, &P->Z, &grp->P ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &P->X, &P->X, &P->Z ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &P->Z, 1 ) );
 
@@ -2840,118 +3075,1241 @@ cleanup:
 }
 
 /*
- * Restartable linear combination
+ * Interleaved multi-scalar multiplication with width-w NAF
+ * (GECC algorithms 3.35 and 3.51) - for public scalars only
  * NOT constant-time
+ *
+ * Each scalar k_i is recoded in width-w_i non-adjacent form: a sequence of
+ * digits that are either 0 or odd with absolute value less than 2^(w_i-1),
+ * with at most one non-zero digit in any w_i consecutive ones. All scalars
+ * then share a single chain of doublings, and each non-zero digit adds or
+ * subtracts one of the odd multiples P_i, 3 P_i, ..., (2^(w_i-1) - 1) P_i,
+ * pre-computed in affine coordinates so that mixed additions can be used.
+ *
+ * For two 256-bit scalars and w = 5, this is about 256 doublings and 86
+ * additions, against twice as many doublings for two separate comb
+ * multiplications, without the cost of their side-channel countermeasures.
  */
-int mbedtls_ecp_muladd_restartable(
-             mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
-             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
-             const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
-             mbedtls_ecp_restart_ctx *rs_ctx )
+
+/*
+ * Compute the odd multiples T[i] = (2i + 1) P for i < 2^(w-2).
+ * T must point to that many initialized points, P must be normalized.
+ */
+static int ecp_wnaf_precompute( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point T[],
+                                const mbedtls_ecp_point *P,
+                                unsigned char w )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_ecp_point mP;
-    mbedtls_ecp_point *pmP = &mP;
-    mbedtls_ecp_point *pR = R;
-#if defined(MBEDTLS_ECP_INTERNAL_ALT)
-    char is_grp_capable = 0;
-#endif
-    ECP_VALIDATE_RET( grp != NULL );
-    ECP_VALIDATE_RET( R   != NULL );
-    ECP_VALIDATE_RET( m   != NULL );
-    ECP_VALIDATE_RET( P   != NULL );
-    ECP_VALIDATE_RET( n   != NULL );
-    ECP_VALIDATE_RET( Q   != NULL );
+    size_t i;
+    const size_t T_size = ECP_WNAF_TABLE_SIZE( w );
+    mbedtls_ecp_point D;
+    mbedtls_ecp_point *TT[ECP_WNAF_TABLE_SIZE( ECP_WNAF_MAX_WINDOW ) - 1];
 
-    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
-        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+    mbedtls_ecp_point_init( &D );
 
-    mbedtls_ecp_point_init( &mP );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[0], P ) );
 
-    ECP_RS_ENTER( ma );
+    if( T_size == 1 )
+        goto cleanup;
 
-#if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+    /* D = 2P, normalized so that it can be used in mixed additions */
+    MBEDTLS_MPI_CHK( ecp_double_jac( grp, &D, P ) );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, &D ) );
+
+    for( i = 1; i < T_size; i++ )
     {
-        /* redirect intermediate results to restart context */
-        pmP = &rs_ctx->ma->mP;
-        pR  = &rs_ctx->ma->R;
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &T[i], &T[i - 1], &D ) );
+        TT[i - 1] = &T[i];
+    }
 
-        /* jump to next operation */
-        if( rs_ctx->ma->state == ecp_rsma_mul2 )
-            goto mul2;
-        if( rs_ctx->ma->state == ecp_rsma_add )
-            goto add;
-        if( rs_ctx->ma->state == ecp_rsma_norm )
-            goto norm;
+    MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, T_size - 1 ) );
+
+    /* ecp_normalize_jac_many() doesn't store Z, but these points may be
+     * copied as they are to the result, which must then have Z == 1 */
+    for( i = 1; i < T_size; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &T[i].Z, 1 ) );
+
+cleanup:
+    mbedtls_ecp_point_free( &D );
+
+    return( ret );
+}
+
+/*
+ * Width-w NAF of |k| in naf[0..len-1], least significant digit first.
+ * len must be at least mbedtls_mpi_bitlen( k ) + 1.
+ */
+static void ecp_wnaf_recode( signed char naf[], size_t len,
+                             const mbedtls_mpi *k, unsigned char w )
+{
+    size_t bit = 0, now, j;
+    int carry = 0, word;
+
+    memset( naf, 0, len );
+
+    while( bit < len )
+    {
+        if( (int) mbedtls_mpi_get_bit( k, bit ) == carry )
+        {
+            bit++;
+            continue;
+        }
+
+        now = w;
+        if( now > len - bit )
+            now = len - bit;
+
+        /* odd, since the first bit differs from the carry */
+        word = carry;
+        for( j = 0; j < now; j++ )
+            word += mbedtls_mpi_get_bit( k, bit + j ) << j;
+
+        carry = ( word >> ( w - 1 ) ) & 1;
+        word -= carry << w;
+
+        naf[bit] = (signed char) word;
+        bit += now;
     }
-#endif /* MBEDTLS_ECP_RESTARTABLE */
+}
 
-    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_shortcuts( grp, pmP, m, P, rs_ctx ) );
-#if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL && rs_ctx->ma != NULL )
-        rs_ctx->ma->state = ecp_rsma_mul2;
+/*
+ * R = sum( k[i] * P_i ) where T[i] holds the odd multiples of P_i for
+ * window width w[i], as computed by ecp_wnaf_precompute().
+ *
+ * Scalars may be negative. Cost: one doubling per bit of the largest
+ * scalar, and about one addition per ( w[i] + 1 ) bits of each scalar.
+ * The result is left in Jacobian coordinates.
+ */
+static int ecp_muladd_wnaf( const mbedtls_ecp_group *grp,
+                            mbedtls_ecp_point *R, size_t count,
+                            const mbedtls_mpi * const k[],
+                            const mbedtls_ecp_point * const T[],
+                            const unsigned char w[] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, j, len = 0;
+    int digit;
+    signed char *naf = NULL;
+    mbedtls_ecp_point neg;
 
-mul2:
-#endif
-    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_shortcuts( grp, pR,  n, Q, rs_ctx ) );
+    mbedtls_ecp_point_init( &neg );
 
-#if defined(MBEDTLS_ECP_INTERNAL_ALT)
-    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
-        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
-#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+    for( j = 0; j < count; j++ )
+    {
+        if( mbedtls_mpi_bitlen( k[j] ) + 1 > len )
+            len = mbedtls_mpi_bitlen( k[j] ) + 1;
+    }
 
-#if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL && rs_ctx->ma != NULL )
-        rs_ctx->ma->state = ecp_rsma_add;
+    naf = mbedtls_calloc( count, len );
+    if( naf == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
 
-add:
-#endif
-    MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_ADD );
-    MBEDTLS_MPI_CHK( ecp_add_mixed( grp, pR, pmP, pR ) );
-#if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL && rs_ctx->ma != NULL )
-        rs_ctx->ma->state = ecp_rsma_norm;
+    for( j = 0; j < count; j++ )
+        ecp_wnaf_recode( naf + j * len, len, k[j], w[j] );
 
-norm:
-#endif
-    MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_INV );
-    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, pR ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_set_zero( R ) );
 
-#if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL && rs_ctx->ma != NULL )
-        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( R, pR ) );
-#endif
+    for( i = len; i-- > 0; )
+    {
+        if( mbedtls_mpi_cmp_int( &R->Z, 0 ) != 0 )
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R ) );
 
-cleanup:
-#if defined(MBEDTLS_ECP_INTERNAL_ALT)
-    if( is_grp_capable )
-        mbedtls_internal_ecp_free( grp );
-#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+        for( j = 0; j < count; j++ )
+        {
+            digit = naf[j * len + i];
+            if( digit == 0 )
+                continue;
 
-    mbedtls_ecp_point_free( &mP );
+            if( k[j]->s < 0 )
+                digit = -digit;
 
-    ECP_RS_LEAVE( ma );
+            if( digit > 0 )
+            {
+                MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R,
+                                                &T[j][( digit - 1 ) >> 1] ) );
+            }
+            else
+            {
+                MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &neg,
+                                                   &T[j][( -digit - 1 ) >> 1] ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &neg.Y,
+                                                      &grp->P, &neg.Y ) );
+                MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R, &neg ) );
+            }
+        }
+    }
+
+cleanup:
+    mbedtls_free( naf );
+    mbedtls_ecp_point_free( &neg );
 
     return( ret );
 }
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
 /*
- * Linear combination
- * NOT constant-time
+ * Get the shared odd multiples of the base point of a built-in curve for
+ * window width ECP_WNAF_G_WINDOW, computing them first if needed.
+ * On success, *T is the shared table, or NULL if the curve has none.
  */
-int mbedtls_ecp_muladd( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
-             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
-             const mbedtls_mpi *n, const mbedtls_ecp_point *Q )
+static int ecp_shared_wnaf_table_get( const mbedtls_ecp_group *grp,
+                                      const mbedtls_ecp_point **T )
 {
-    ECP_VALIDATE_RET( grp != NULL );
-    ECP_VALIDATE_RET( R   != NULL );
-    ECP_VALIDATE_RET( m   != NULL );
-    ECP_VALIDATE_RET( P   != NULL );
-    ECP_VALIDATE_RET( n   != NULL );
-    ECP_VALIDATE_RET( Q   != NULL );
-    return( mbedtls_ecp_muladd_restartable( grp, R, m, P, n, Q, NULL ) );
+    int ret = 0;
+    int idx;
+    size_t i;
+    const size_t T_size = ECP_WNAF_TABLE_SIZE( ECP_WNAF_G_WINDOW );
+    mbedtls_ecp_point *new_T = NULL;
+
+    *T = NULL;
+
+    if( grp->h != 1 || ( idx = ecp_shared_table_index( grp->id ) ) < 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &mbedtls_threading_ecp_tables_mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( ecp_shared_wnaf_T[idx] == NULL )
+    {
+        new_T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) );
+        if( new_T == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_init( &new_T[i] );
+
+        MBEDTLS_MPI_CHK( ecp_wnaf_precompute( grp, new_T, &grp->G,
+                                              ECP_WNAF_G_WINDOW ) );
+
+        /* publish */
+        ecp_shared_wnaf_T[idx] = new_T;
+        new_T = NULL;
+    }
+
+    *T = ecp_shared_wnaf_T[idx];
+
+cleanup:
+    if( new_T != NULL )
+    {
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_free( &new_T[i] );
+        mbedtls_free( new_T );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_ecp_tables_mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+/*
+ * GLV endomorphism of secp256k1 (GECC section 3.5) - for public scalars only
+ *
+ * Since p = 1 mod 3 and b = 7, phi(x, y) = (beta x, y) with beta^3 = 1 mod p
+ * is an endomorphism of the curve, and acts on the group of order n as the
+ * multiplication by some lambda with lambda^3 = 1 mod n. Any scalar k splits
+ * as k = k1 + k2 lambda mod n with |k1|, |k2| < 2^128, so k P can be computed
+ * as k1 P + k2 phi(P): a multi-scalar multiplication with half as many
+ * doublings, while the odd multiples of phi(P) only cost one multiplication
+ * each from those of P.
+ *
+ * The split uses the short basis (a1, b1), (a2, b2) of the lattice of the
+ * (x, y) with x + y lambda = 0 mod n, where b1 < 0 and b2 = a1, and
+ * rounds k b2 / n and -k b1 / n with g1 = round( 2^384 b2 / n ) and
+ * g2 = round( -2^384 b1 / n ), as libsecp256k1 does.
+ */
+static const unsigned char secp256k1_glv_beta[] = {
+    0x7A, 0xE9, 0x6A, 0x2B, 0x65, 0x7C, 0x07, 0x10,
+    0x6E, 0x64, 0x47, 0x9E, 0xAC, 0x34, 0x34, 0xE9,
+    0x9C, 0xF0, 0x49, 0x75, 0x12, 0xF5, 0x89, 0x95,
+    0xC1, 0x39, 0x6C, 0x28, 0x71, 0x95, 0x01, 0xEE
+};
+static const unsigned char secp256k1_glv_a1[] = {
+    0x30, 0x86, 0xD2, 0x21, 0xA7, 0xD4, 0x6B, 0xCD,
+    0xE8, 0x6C, 0x90, 0xE4, 0x92, 0x84, 0xEB, 0x15
+};
+/* -b1 */
+static const unsigned char secp256k1_glv_minus_b1[] = {
+    0xE4, 0x43, 0x7E, 0xD6, 0x01, 0x0E, 0x88, 0x28,
+    0x6F, 0x54, 0x7F, 0xA9, 0x0A, 0xBF, 0xE4, 0xC3
+};
+static const unsigned char secp256k1_glv_a2[] = {
+    0x01, 0x14, 0xCA, 0x50, 0xF7, 0xA8, 0xE2, 0xF3,
+    0xF6, 0x57, 0xC1, 0x10, 0x8D, 0x9D, 0x44, 0xCF,
+    0xD8
+};
+static const unsigned char secp256k1_glv_g1[] = {
+    0x30, 0x86, 0xD2, 0x21, 0xA7, 0xD4, 0x6B, 0xCD,
+    0xE8, 0x6C, 0x90, 0xE4, 0x92, 0x84, 0xEB, 0x15,
+    0x3D, 0xAA, 0x8A, 0x14, 0x71, 0xE8, 0xCA, 0x7F,
+    0xE8, 0x93, 0x20, 0x9A, 0x45, 0xDB, 0xB0, 0x31
+};
+static const unsigned char secp256k1_glv_g2[] = {
+    0xE4, 0x43, 0x7E, 0xD6, 0x01, 0x0E, 0x88, 0x28,
+    0x6F, 0x54, 0x7F, 0xA9, 0x0A, 0xBF, 0xE4, 0xC4,
+    0x22, 0x12, 0x08, 0xAC, 0x9D, 0xF5, 0x06, 0xC6,
+    0x15, 0x71, 0xB4, 0xAE, 0x8A, 0xC4, 0x7F, 0x71
+};
+
+/*
+ * Whether k P should be computed as k1 P + k2 phi(P): only on secp256k1,
+ * and only for scalars that are longer than k1 and k2 would be.
+ */
+static int ecp_glv_applies( const mbedtls_ecp_group *grp,
+                            const mbedtls_mpi *k )
+{
+    return( grp->id == MBEDTLS_ECP_DP_SECP256K1 &&
+            mbedtls_mpi_bitlen( k ) > 128 );
+}
+
+/*
+ * c = round( k g / 2^384 ), for 0 <= k < n
+ */
+static int ecp_glv_round( mbedtls_mpi *c, const mbedtls_mpi *k,
+                          const unsigned char *g, size_t g_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi G;
+
+    mbedtls_mpi_init( &G );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &G, g, g_len ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( c, k, &G ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( c, 383 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( c, c, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( c, 1 ) );
+
+cleanup:
+    mbedtls_mpi_free( &G );
+
+    return( ret );
+}
+
+/*
+ * Split k into k1 + k2 lambda mod n, with |k1|, |k2| < 2^128:
+ * with r = k mod n, c1 = round( r b2 / n ) and c2 = round( -r b1 / n ),
+ *     k1 = r - c1 a1 - c2 a2
+ *     k2 = -c1 b1 - c2 b2 = c1 (-b1) - c2 a1
+ */
+static int ecp_glv_split( const mbedtls_ecp_group *grp,
+                          mbedtls_mpi *k1, mbedtls_mpi *k2,
+                          const mbedtls_mpi *k )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi r, c1, c2, a1, a2, mb1, t;
+
+    mbedtls_mpi_init( &r ); mbedtls_mpi_init( &c1 ); mbedtls_mpi_init( &c2 );
+    mbedtls_mpi_init( &a1 ); mbedtls_mpi_init( &a2 ); mbedtls_mpi_init( &mb1 );
+    mbedtls_mpi_init( &t );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &a1, secp256k1_glv_a1,
+                                              sizeof( secp256k1_glv_a1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &a2, secp256k1_glv_a2,
+                                              sizeof( secp256k1_glv_a2 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &mb1, secp256k1_glv_minus_b1,
+                                              sizeof( secp256k1_glv_minus_b1 ) ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &r, k, &grp->N ) );
+    MBEDTLS_MPI_CHK( ecp_glv_round( &c1, &r, secp256k1_glv_g1,
+                                    sizeof( secp256k1_glv_g1 ) ) );
+    MBEDTLS_MPI_CHK( ecp_glv_round( &c2, &r, secp256k1_glv_g2,
+                                    sizeof( secp256k1_glv_g2 ) ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &c1, &a1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k1, &r, &t ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &c2, &a2 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k1, k1, &t ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( k2, &c1, &mb1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &c2, &a1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k2, k2, &t ) );
+
+cleanup:
+    mbedtls_mpi_free( &r ); mbedtls_mpi_free( &c1 ); mbedtls_mpi_free( &c2 );
+    mbedtls_mpi_free( &a1 ); mbedtls_mpi_free( &a2 ); mbedtls_mpi_free( &mb1 );
+    mbedtls_mpi_free( &t );
+
+    return( ret );
+}
+
+/*
+ * Odd multiples of phi(P) from those of P: phi_T[i] = phi( T[i] ).
+ * phi_T must point to 2^(w-2) initialized points.
+ */
+static int ecp_glv_table( const mbedtls_ecp_group *grp,
+                          mbedtls_ecp_point phi_T[],
+                          const mbedtls_ecp_point T[],
+                          unsigned char w )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+    mbedtls_mpi beta;
+
+    mbedtls_mpi_init( &beta );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &beta, secp256k1_glv_beta,
+                                              sizeof( secp256k1_glv_beta ) ) );
+
+    for( i = 0; i < ECP_WNAF_TABLE_SIZE( w ); i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &phi_T[i].X,
+                                              &T[i].X, &beta ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &phi_T[i].Y, &T[i].Y ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &phi_T[i].Z, 1 ) );
+    }
+
+cleanup:
+    mbedtls_mpi_free( &beta );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_DP_SECP256K1_ENABLED */
+
+/*
+ * R = sum( k[i] * P[i] ) in Jacobian coordinates (not normalized), with
+ * scalars of any size and sign, and points that must be normalized.
+ * On secp256k1, long scalars are split with the GLV endomorphism, so
+ * that up to 2 * count scalars are passed to ecp_muladd_wnaf().
+ * NOT constant-time
+ */
+static int ecp_muladd_multi( const mbedtls_ecp_group *grp,
+                             mbedtls_ecp_point *R, size_t count,
+                             const mbedtls_mpi * const k[],
+                             const mbedtls_ecp_point * const P[] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, j, nb = count;
+    const mbedtls_mpi **kk = NULL;
+    const mbedtls_ecp_point **T = NULL;
+    mbedtls_ecp_point **own_T = NULL;
+    unsigned char *w = NULL;
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    mbedtls_mpi *glv_k = NULL;
+#endif
+
+    kk = mbedtls_calloc( 2 * count, sizeof( *kk ) );
+    T = mbedtls_calloc( 2 * count, sizeof( *T ) );
+    own_T = mbedtls_calloc( 2 * count, sizeof( *own_T ) );
+    w = mbedtls_calloc( 2 * count, 1 );
+    if( kk == NULL || T == NULL || own_T == NULL || w == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    if( grp->id == MBEDTLS_ECP_DP_SECP256K1 )
+    {
+        glv_k = mbedtls_calloc( 2 * count, sizeof( mbedtls_mpi ) );
+        if( glv_k == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        for( j = 0; j < 2 * count; j++ )
+            mbedtls_mpi_init( &glv_k[j] );
+    }
+#endif
+
+    for( j = 0; j < count; j++ )
+    {
+        kk[j] = k[j];
+
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+        if( mbedtls_mpi_cmp_mpi( &P[j]->Y, &grp->G.Y ) == 0 &&
+            mbedtls_mpi_cmp_mpi( &P[j]->X, &grp->G.X ) == 0 )
+        {
+            MBEDTLS_MPI_CHK( ecp_shared_wnaf_table_get( grp, &T[j] ) );
+            w[j] = ECP_WNAF_G_WINDOW;
+        }
+#endif
+
+        if( T[j] == NULL )
+        {
+            w[j] = ECP_WNAF_WINDOW;
+            own_T[j] = mbedtls_calloc( ECP_WNAF_TABLE_SIZE( w[j] ),
+                                       sizeof( mbedtls_ecp_point ) );
+            if( own_T[j] == NULL )
+            {
+                ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+                goto cleanup;
+            }
+
+            for( i = 0; i < ECP_WNAF_TABLE_SIZE( w[j] ); i++ )
+                mbedtls_ecp_point_init( &own_T[j][i] );
+
+            MBEDTLS_MPI_CHK( ecp_wnaf_precompute( grp, own_T[j],
+                                                  P[j], w[j] ) );
+            T[j] = own_T[j];
+        }
+
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+        if( ecp_glv_applies( grp, k[j] ) )
+        {
+            /* k P = k1 P + k2 phi(P) */
+            MBEDTLS_MPI_CHK( ecp_glv_split( grp, &glv_k[2 * j],
+                                            &glv_k[2 * j + 1], k[j] ) );
+            kk[j] = &glv_k[2 * j];
+            kk[nb] = &glv_k[2 * j + 1];
+
+            w[nb] = w[j];
+            own_T[nb] = mbedtls_calloc( ECP_WNAF_TABLE_SIZE( w[nb] ),
+                                        sizeof( mbedtls_ecp_point ) );
+            if( own_T[nb] == NULL )
+            {
+                ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+                goto cleanup;
+            }
+
+            for( i = 0; i < ECP_WNAF_TABLE_SIZE( w[nb] ); i++ )
+                mbedtls_ecp_point_init( &own_T[nb][i] );
+
+            MBEDTLS_MPI_CHK( ecp_glv_table( grp, own_T[nb], T[j], w[nb] ) );
+            T[nb] = own_T[nb];
+            nb++;
+        }
+#endif /* MBEDTLS_ECP_DP_SECP256K1_ENABLED */
+    }
+
+    MBEDTLS_MPI_CHK( ecp_muladd_wnaf( grp, R, nb, kk, T, w ) );
+
+cleanup:
+    for( j = 0; own_T != NULL && j < 2 * count; j++ )
+    {
+        if( own_T[j] == NULL )
+            continue;
+
+        for( i = 0; i < ECP_WNAF_TABLE_SIZE( w[j] ); i++ )
+            mbedtls_ecp_point_free( &own_T[j][i] );
+        mbedtls_free( own_T[j] );
+    }
+
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    if( glv_k != NULL )
+    {
+        for( j = 0; j < 2 * count; j++ )
+            mbedtls_mpi_free( &glv_k[j] );
+        mbedtls_free( glv_k );
+    }
+#endif
+
+    mbedtls_free( kk );
+    mbedtls_free( T );
+    mbedtls_free( own_T );
+    mbedtls_free( w );
+
+    return( ret );
+}
+
+/*
+ * Non-restartable linear combination R = m * P + n * Q, with scalars
+ * neither 1 nor -1 (those are left to mbedtls_ecp_mul_shortcuts()).
+ * NOT constant-time
+ */
+static int ecp_muladd_interleaved( mbedtls_ecp_group *grp,
+                                   mbedtls_ecp_point *R,
+                                   const mbedtls_mpi *m,
+                                   const mbedtls_ecp_point *P,
+                                   const mbedtls_mpi *n,
+                                   const mbedtls_ecp_point *Q )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    const mbedtls_mpi *k[2];
+    const mbedtls_ecp_point *points[2];
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+
+    k[0] = m; points[0] = P;
+    k[1] = n; points[1] = Q;
+
+    /* Same sanity checks as mbedtls_ecp_mul() */
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_privkey( grp, m ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_pubkey( grp, P ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_privkey( grp, n ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_pubkey( grp, Q ) );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_muladd_multi( grp, R, 2, k, points ) );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, R ) );
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    return( ret );
+}
+
+/*
+ * Restartable linear combination
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd_restartable(
+             mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
+             mbedtls_ecp_restart_ctx *rs_ctx )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecp_point mP;
+    mbedtls_ecp_point *pmP = &mP;
+    mbedtls_ecp_point *pR = R;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( grp != NULL );
+    ECP_VALIDATE_RET( R   != NULL );
+    ECP_VALIDATE_RET( m   != NULL );
+    ECP_VALIDATE_RET( P   != NULL );
+    ECP_VALIDATE_RET( n   != NULL );
+    ECP_VALIDATE_RET( Q   != NULL );
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    /* Use the faster interleaved multiplication unless we may have to
+     * restart, which it doesn't support, or a scalar is trivial. */
+    if( mbedtls_mpi_cmp_int( m, 1 ) != 0 && mbedtls_mpi_cmp_int( m, -1 ) != 0 &&
+        mbedtls_mpi_cmp_int( n, 1 ) != 0 && mbedtls_mpi_cmp_int( n, -1 ) != 0
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+        && ( rs_ctx == NULL || ! mbedtls_ecp_restart_is_enabled() )
+#endif
+      )
+    {
+        return( ecp_muladd_interleaved( grp, R, m, P, n, Q ) );
+    }
+
+    mbedtls_ecp_point_init( &mP );
+
+    ECP_RS_ENTER( ma );
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+    {
+        /* redirect intermediate results to restart context */
+        pmP = &rs_ctx->ma->mP;
+        pR  = &rs_ctx->ma->R;
+
+        /* jump to next operation */
+        if( rs_ctx->ma->state == ecp_rsma_mul2 )
+            goto mul2;
+        if( rs_ctx->ma->state == ecp_rsma_add )
+            goto add;
+        if( rs_ctx->ma->state == ecp_rsma_norm )
+            goto norm;
+    }
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_shortcuts( grp, pmP, m, P, rs_ctx ) );
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+        rs_ctx->ma->state = ecp_rsma_mul2;
+
+mul2:
+#endif
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_shortcuts( grp, pR,  n, Q, rs_ctx ) );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+        rs_ctx->ma->state = ecp_rsma_add;
+
+add:
+#endif
+    MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_ADD );
+    MBEDTLS_MPI_CHK( ecp_add_mixed( grp, pR, pmP, pR ) );
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+        rs_ctx->ma->state = ecp_rsma_norm;
+
+norm:
+#endif
+    MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_INV );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, pR ) );
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    if( rs_ctx != NULL && rs_ctx->ma != NULL )
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( R, pR ) );
+#endif
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    mbedtls_ecp_point_free( &mP );
+
+    ECP_RS_LEAVE( ma );
+
+    return( ret );
+}
+
+/*
+ * Linear combination
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q )
+{
+    ECP_VALIDATE_RET( grp != NULL );
+    ECP_VALIDATE_RET( R   != NULL );
+    ECP_VALIDATE_RET( m   != NULL );
+    ECP_VALIDATE_RET( P   != NULL );
+    ECP_VALIDATE_RET( n   != NULL );
+    ECP_VALIDATE_RET( Q   != NULL );
+    return( mbedtls_ecp_muladd_restartable( grp, R, m, P, n, Q, NULL ) );
+}
+
+/*
+ * Recover a point R with the given x coordinate, if there is one.
+ * E must be ( P + 1 ) / 4, which gives square roots since P = 3 mod 4.
+ * The sign of the y coordinate is arbitrary.
+ */
+static int ecp_recover_y( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                          const mbedtls_mpi *x, const mbedtls_mpi *E,
+                          mbedtls_mpi *RR )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi RHS, YY;
+
+    if( mbedtls_mpi_cmp_int( x, 0 ) < 0 ||
+        mbedtls_mpi_cmp_mpi( x, &grp->P ) >= 0 )
+        return( MBEDTLS_ERR_ECP_VERIFY_FAILED );
+
+    mbedtls_mpi_init( &RHS ); mbedtls_mpi_init( &YY );
+
+    /* RHS = X (X^2 + A) + B = X^3 + A X + B, as in ecp_check_pubkey_sw() */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, x, x ) );
+
+    if( grp->A.p == NULL )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &RHS, &RHS, 3       ) );  MOD_SUB( RHS );
+    }
+    else
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS, &grp->A ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, &RHS, x ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS, &grp->B ) );
+
+    /* Y = sqrt( RHS ), if RHS is a square at all */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &R->Y, &RHS, E, &grp->P, RR ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &YY, &R->Y, &R->Y ) );
+
+    if( mbedtls_mpi_cmp_mpi( &YY, &RHS ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, x ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &R->Z, 1 ) );
+
+cleanup:
+    mbedtls_mpi_free( &RHS ); mbedtls_mpi_free( &YY );
+
+    return( ret );
+}
+
+/*
+ * Is the Jacobian point U equal to the normalized point S, or to -S?
+ */
+static int ecp_jac_eq_affine_pm( const mbedtls_ecp_group *grp,
+                                 const mbedtls_ecp_point *U,
+                                 const mbedtls_ecp_point *S,
+                                 int *eq )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi T, V;
+
+    *eq = 0;
+
+    if( mbedtls_mpi_cmp_int( &U->Z, 0 ) == 0 ||
+        mbedtls_mpi_cmp_int( &S->Z, 0 ) == 0 )
+    {
+        *eq = ( mbedtls_mpi_cmp_int( &U->Z, 0 ) == 0 &&
+                mbedtls_mpi_cmp_int( &S->Z, 0 ) == 0 );
+        return( 0 );
+    }
+
+    mbedtls_mpi_init( &T ); mbedtls_mpi_init( &V );
+
+    /* X == x Z^2 ? */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T, &U->Z, &U->Z ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &V, &S->X, &T ) );
+    if( mbedtls_mpi_cmp_mpi( &U->X, &V ) != 0 )
+        goto cleanup;
+
+    /* Y == +/- y Z^3 ? */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T, &T, &U->Z ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &V, &S->Y, &T ) );
+    if( mbedtls_mpi_cmp_mpi( &U->Y, &V ) != 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &V, &grp->P, &V ) );
+        if( mbedtls_mpi_cmp_mpi( &U->Y, &V ) != 0 )
+            goto cleanup;
+    }
+
+    *eq = 1;
+
+cleanup:
+    mbedtls_mpi_free( &T ); mbedtls_mpi_free( &V );
+
+    return( ret );
+}
+
+/*
+ * Check sum( k[i] P[i] ) == sum( +/- a[j] R[j] ) where x(R[j]) = x[j]
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd_batch_check( mbedtls_ecp_group *grp,
+                                    size_t count,
+                                    const mbedtls_mpi * const k[],
+                                    const mbedtls_ecp_point * const P[],
+                                    size_t x_count,
+                                    const mbedtls_mpi * const a[],
+                                    const mbedtls_mpi * const x[] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int eq = 0;
+    size_t i, j, g, steps;
+    unsigned char neg[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_ecp_point aR[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_ecp_point D[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_ecp_point *TT[MBEDTLS_ECP_BATCH_MAX_SIZE];
+    mbedtls_ecp_point R, S, U, Dneg;
+    const mbedtls_ecp_point *pR = &R;
+    const unsigned char w = 2;
+    mbedtls_mpi E, RR;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( grp != NULL );
+    ECP_VALIDATE_RET( count == 0 || ( k != NULL && P != NULL ) );
+    ECP_VALIDATE_RET( a != NULL );
+    ECP_VALIDATE_RET( x != NULL );
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( x_count == 0 || x_count > MBEDTLS_ECP_BATCH_MAX_SIZE )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    /* We only know how to take square roots cheaply if P = 3 mod 4 */
+    if( mbedtls_mpi_get_bit( &grp->P, 0 ) != 1 ||
+        mbedtls_mpi_get_bit( &grp->P, 1 ) != 1 )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    for( i = 0; i < count; i++ )
+    {
+        if( ( ret = mbedtls_ecp_check_pubkey( grp, P[i] ) ) != 0 )
+            return( ret );
+    }
+
+    mbedtls_ecp_point_init( &R ); mbedtls_ecp_point_init( &S );
+    mbedtls_ecp_point_init( &U ); mbedtls_ecp_point_init( &Dneg );
+    mbedtls_mpi_init( &E ); mbedtls_mpi_init( &RR );
+
+    for( j = 0; j < x_count; j++ )
+    {
+        mbedtls_ecp_point_init( &aR[j] );
+        mbedtls_ecp_point_init( &D[j] );
+        neg[j] = 0;
+    }
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    /*
+     * aR[j] = a[j] R[j] for either choice of R[j], and D[j] = 2 aR[j],
+     * all normalized. The randomizers are small, so don't bother with a
+     * table: window 2 is plain NAF with R[j] itself as the only entry.
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &E, &grp->P, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &E, 2 ) );
+
+    for( j = 0; j < x_count; j++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_recover_y( grp, &R, x[j], &E, &RR ) );
+        MBEDTLS_MPI_CHK( ecp_muladd_wnaf( grp, &aR[j], 1, &a[j], &pR, &w ) );
+
+        if( mbedtls_mpi_cmp_int( &aR[j].Z, 0 ) == 0 )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+            goto cleanup;
+        }
+
+        TT[j] = &aR[j];
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, x_count ) );
+
+    for( j = 0; j < x_count; j++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &aR[j].Z, 1 ) );
+        MBEDTLS_MPI_CHK( ecp_double_jac( grp, &D[j], &aR[j] ) );
+        TT[j] = &D[j];
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, x_count ) );
+
+    for( j = 0; j < x_count; j++ )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &D[j].Z, 1 ) );
+
+    /* S = sum( k[i] P[i] ), normalized */
+    if( count > 0 )
+    {
+        MBEDTLS_MPI_CHK( ecp_muladd_multi( grp, &S, count, k, P ) );
+        MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, &S ) );
+    }
+    else
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_set_zero( &S ) );
+    }
+
+    /* U = sum( aR[j] ) with all signs positive */
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &U, &aR[0] ) );
+    for( j = 1; j < x_count; j++ )
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &U, &U, &aR[j] ) );
+
+    /*
+     * Try all choices of signs, up to a global sign which is taken care of
+     * by comparing U with both S and -S. Use a Gray code so that each step
+     * changes the sign of a single term, at the cost of one addition.
+     */
+    steps = (size_t) 1 << ( x_count - 1 );
+    for( g = 1; ; g++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_jac_eq_affine_pm( grp, &U, &S, &eq ) );
+        if( eq || g == steps )
+            break;
+
+        for( j = 1; ( g & ( (size_t) 1 << ( j - 1 ) ) ) == 0; j++ )
+            ;
+
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &Dneg, &D[j] ) );
+        if( ! neg[j] )
+            MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &Dneg.Y, &grp->P, &Dneg.Y ) );
+        neg[j] = ! neg[j];
+
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &U, &U, &Dneg ) );
+    }
+
+    ret = eq ? 0 : MBEDTLS_ERR_ECP_VERIFY_FAILED;
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    for( j = 0; j < x_count; j++ )
+    {
+        mbedtls_ecp_point_free( &aR[j] );
+        mbedtls_ecp_point_free( &D[j] );
+    }
+
+    mbedtls_ecp_point_free( &R ); mbedtls_ecp_point_free( &S );
+    mbedtls_ecp_point_free( &U ); mbedtls_ecp_point_free( &Dneg );
+    mbedtls_mpi_free( &E ); mbedtls_mpi_free( &RR );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+/*
+ * Make sure grp->T holds the comb table of multiples of G for window w,
+ * the way ecp_mul_comb() would have computed it.
+ */
+static int ecp_base_table_get( mbedtls_ecp_group *grp,
+                               unsigned char w, size_t d )
+{
+    int ret = 0;
+    unsigned char i;
+    const unsigned char T_size = 1U << ( w - 1 );
+    mbedtls_ecp_point *T = NULL;
+
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    if( grp->T == NULL )
+    {
+        MBEDTLS_MPI_CHK( ecp_shared_table_get( grp, w, d, 1, &grp->T ) );
+        if( grp->T != NULL )
+            grp->T_size = T_size;
+    }
+#endif
+
+    if( grp->T == NULL )
+    {
+        T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) );
+        if( T == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_init( &T[i] );
+
+        MBEDTLS_MPI_CHK( ecp_precompute_comb( grp, T, &grp->G, w, d, NULL ) );
+
+        /* transfer ownership to the group */
+        grp->T = T;
+        grp->T_size = T_size;
+        T = NULL;
+    }
+
+    if( grp->T_size != T_size )
+        ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+
+cleanup:
+    if( T != NULL )
+    {
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+    }
+
+    return( ret );
+}
+
+/*
+ * Pre-compute the comb table of multiples of Q, with the same window as the
+ * table of multiples of G so that both can share the same doublings.
+ */
+int mbedtls_ecp_keypair_precompute( mbedtls_ecp_keypair *key )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char w, i, T_size;
+    size_t d;
+    mbedtls_ecp_group *grp;
+    mbedtls_ecp_point *T = NULL;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( key != NULL );
+
+    grp = &key->grp;
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( ( ret = mbedtls_ecp_check_pubkey( grp, &key->Q ) ) != 0 )
+        return( ret );
+
+    w = ecp_pick_window_size( grp, 1 );
+    T_size = 1U << ( w - 1 );
+    d = ( grp->nbits + w - 1 ) / w;
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_base_table_get( grp, w, d ) );
+
+    T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) );
+    if( T == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < T_size; i++ )
+        mbedtls_ecp_point_init( &T[i] );
+
+    MBEDTLS_MPI_CHK( ecp_precompute_comb( grp, T, &key->Q, w, d, NULL ) );
+
+    /* replace the previous table, if any */
+    if( key->T != NULL )
+    {
+        for( i = 0; i < key->T_size; i++ )
+            mbedtls_ecp_point_free( &key->T[i] );
+        mbedtls_free( key->T );
+    }
+
+    key->T = T;
+    key->T_size = T_size;
+    T = NULL;
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    if( T != NULL )
+    {
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+    }
+
+    return( ret );
+}
+
+/*
+ * Is the pre-computed table of key (still) usable along with that of G?
+ */
+static int ecp_keypair_table_is_valid( const mbedtls_ecp_keypair *key,
+                                       unsigned char T_size )
+{
+    return( key->T != NULL && key->T_size == T_size &&
+            key->grp.T != NULL && key->grp.T_size == T_size &&
+            mbedtls_mpi_cmp_mpi( &key->T[0].X, &key->Q.X ) == 0 &&
+            mbedtls_mpi_cmp_mpi( &key->T[0].Y, &key->Q.Y ) == 0 );
+}
+
+/*
+ * R = m * G + n * Q with comb tables for both G and Q, computed with the same
+ * window w: the scalars are recoded as in ecp_mul_comb() and then a single
+ * chain of d doublings serves both.
+ *
+ * Cost: d D + 2 (d + 1) A + 1 N
+ * NOT constant-time
+ */
+static int ecp_muladd_comb( const mbedtls_ecp_group *grp,
+                            mbedtls_ecp_point *R,
+                            const mbedtls_mpi *m, const mbedtls_mpi *n,
+                            const mbedtls_ecp_point *TQ,
+                            unsigned char w, size_t d )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, j;
+    unsigned char ii, parity_trick;
+    unsigned char k[2][COMB_MAX_D + 1];
+    const mbedtls_mpi *s[2];
+    const mbedtls_ecp_point *T[2];
+    mbedtls_ecp_point Txi;
+
+    mbedtls_ecp_point_init( &Txi );
+
+    s[0] = m; T[0] = grp->T;
+    s[1] = n; T[1] = TQ;
+
+    for( j = 0; j < 2; j++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_comb_recode_scalar( grp, s[j], k[j], d, w,
+                                                 &parity_trick ) );
+
+        /* N - s was recoded instead of s: flip the sign of every digit */
+        if( parity_trick )
+        {
+            for( i = 0; i <= d; i++ )
+                k[j][i] ^= 0x80;
+        }
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_set_zero( R ) );
+
+    for( i = d + 1; i-- > 0; )
+    {
+        if( mbedtls_mpi_cmp_int( &R->Z, 0 ) != 0 )
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R ) );
+
+        for( j = 0; j < 2; j++ )
+        {
+            /* See ecp_select_comb(); table points may lack Z */
+            ii = ( k[j][i] & 0x7Fu ) >> 1;
+            MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &Txi, &T[j][ii] ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &Txi.Z, 1 ) );
+
+            if( k[j][i] >> 7 )
+                MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &Txi.Y,
+                                                      &grp->P, &Txi.Y ) );
+
+            MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R, &Txi ) );
+        }
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, R ) );
+
+cleanup:
+    mbedtls_ecp_point_free( &Txi );
+
+    return( ret );
+}
+
+/*
+ * Linear combination with the base point and the public key of a key pair
+ * NOT constant-time
+ */
+int mbedtls_ecp_keypair_muladd( mbedtls_ecp_keypair *key, mbedtls_ecp_point *R,
+                                const mbedtls_mpi *m, const mbedtls_mpi *n )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char w;
+    size_t d;
+    mbedtls_ecp_group *grp;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( key != NULL );
+    ECP_VALIDATE_RET( R   != NULL );
+    ECP_VALIDATE_RET( m   != NULL );
+    ECP_VALIDATE_RET( n   != NULL );
+
+    grp = &key->grp;
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    w = ecp_pick_window_size( grp, 1 );
+    d = ( grp->nbits + w - 1 ) / w;
+
+    if( ! ecp_keypair_table_is_valid( key, 1U << ( w - 1 ) ) )
+        return( mbedtls_ecp_muladd( grp, R, m, &grp->G, n, &key->Q ) );
+
+    /* Same sanity checks as mbedtls_ecp_muladd(); Q was checked when the
+     * table was computed, and still matches it */
+    if( ( ret = mbedtls_ecp_check_privkey( grp, m ) ) != 0 ||
+        ( ret = mbedtls_ecp_check_privkey( grp, n ) ) != 0 )
+        return( ret );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_muladd_comb( grp, R, m, n, key->T, w, d ) );
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    return( ret );
 }
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 #if defined(MBEDTLS_ECP_MONTGOMERY_ENABLED)
@@ -0,0 +1,1256 @@
+/*
+ *  Edwards-curve Digital Signature Algorithm over edwards25519
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * References:
+ *
+ * RFC 8032: Edwards-Curve Digital Signature Algorithm (EdDSA)
+ *
+ * Bernstein, Duif, Lange, Schwabe, Yang: High-speed high-security
+ * signatures, https://ed25519.cr.yp.to/ed25519-20110926.pdf
+ *
+ * Hisil, Wong, Carter, Dawson: Twisted Edwards Curves Revisited,
+ * https://eprint.iacr.org/2008/522
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_ED25519_C)
+
+#include "mbedtls/ed25519.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/error.h"
+
+#include <string.h>
+
+/*
+ * 32-bit integer manipulation macros (little endian)
+ */
+#ifndef GET_UINT32_LE
+#define GET_UINT32_LE(n,b,i)                            \
+{                                                       \
+    (n) = ( (uint32_t) (b)[(i)    ]       )             \
+        | ( (uint32_t) (b)[(i) + 1] <<  8 )             \
+        | ( (uint32_t) (b)[(i) + 2] << 16 )             \
+        | ( (uint32_t) (b)[(i) + 3] << 24 );            \
+}
+#endif
+
+/* Parameter validation macros based on platform_util.h */
+#define ED25519_VALIDATE_RET( cond )    \
+    MBEDTLS_INTERNAL_VALIDATE_RET( cond, MBEDTLS_ERR_ECP_BAD_INPUT_DATA )
+#define ED25519_VALIDATE( cond )        \
+    MBEDTLS_INTERNAL_VALIDATE( cond )
+
+/*
+ * Elements of GF(2^255 - 19) are held in 10 limbs of alternately 26 and
+ * 25 bits, limb i having weight 2^ceil(25.5 * i). Every function below
+ * returns limbs that fit in 26 bits, so that products of two limbs and
+ * their sums fit in 64 bits without any intermediate carry.
+ */
+typedef uint32_t ed25519_fe[10];
+
+#define FE_BITS( i )    ( 26 - ( ( i ) & 1 ) )
+#define FE_OFFSET( i )  ( 25 * ( i ) + ( ( i ) + 1 ) / 2 )
+
+/* d = -121665 / 121666 */
+static const ed25519_fe ed25519_d =
+    { 0x35978a3, 0x0d37284, 0x3156ebd, 0x06a0a0e, 0x001c029,
+      0x179e898, 0x3a03cbb, 0x1ce7198, 0x2e2b6ff, 0x1480db3 };
+
+/* 2 * d */
+static const ed25519_fe ed25519_2d =
+    { 0x2b2f159, 0x1a6e509, 0x22add7a, 0x0d4141d, 0x0038052,
+      0x0f3d130, 0x3407977, 0x19ce331, 0x1c56dff, 0x0901b67 };
+
+/* A square root of -1, 2^((p - 1) / 4) */
+static const ed25519_fe ed25519_sqrtm1 =
+    { 0x20ea0b0, 0x186c9d2, 0x08f189d, 0x035697f, 0x0bd0c60,
+      0x1fbd7a7, 0x2804c9e, 0x1e16569, 0x004fc1d, 0x0ae0c92 };
+
+/*
+ * Reduce the 64-bit limbs of t into h. The input limbs must be less
+ * than 2^62.
+ */
+static void fe_carry( ed25519_fe h, uint64_t t[10] )
+{
+    uint64_t c;
+    size_t i;
+
+    for( i = 0; i < 10; i++ )
+    {
+        c = t[i] >> FE_BITS( i );
+        t[i] &= ( (uint64_t) 1 << FE_BITS( i ) ) - 1;
+        if( i < 9 )
+            t[i + 1] += c;
+        else
+            t[0] += 19 * c;     /* 2^255 = 19 */
+    }
+
+    c = t[0] >> 26;
+    t[0] &= 0x3ffffff;
+    t[1] += c;
+
+    for( i = 0; i < 10; i++ )
+        h[i] = (uint32_t) t[i];
+}
+
+static void fe_copy( ed25519_fe h, const ed25519_fe f )
+{
+    memcpy( h, f, sizeof( ed25519_fe ) );
+}
+
+static void fe_set_int( ed25519_fe h, uint32_t z )
+{
+    memset( h, 0, sizeof( ed25519_fe ) );
+    h[0] = z;
+}
+
+static void fe_add( ed25519_fe h, const ed25519_fe f, const ed25519_fe g )
+{
+    uint64_t t[10];
+    size_t i;
+
+    for( i = 0; i < 10; i++ )
+        t[i] = (uint64_t) f[i] + g[i];
+
+    fe_carry( h, t );
+}
+
+/*
+ * h = f - g, computed as f + 2p - g so that no limb goes negative
+ */
+static void fe_sub( ed25519_fe h, const ed25519_fe f, const ed25519_fe g )
+{
+    uint64_t t[10];
+    size_t i;
+
+    for( i = 0; i < 10; i++ )
+    {
+        uint64_t two_p = ( i == 0 ) ? 0x7ffffda :
+                         ( i & 1 ) ? 0x3fffffe : 0x7fffffe;
+        t[i] = (uint64_t) f[i] + two_p - g[i];
+    }
+
+    fe_carry( h, t );
+}
+
+static void fe_neg( ed25519_fe h, const ed25519_fe f )
+{
+    ed25519_fe zero;
+
+    fe_set_int( zero, 0 );
+    fe_sub( h, zero, f );
+}
+
+/*
+ * h = f * g. A product of two odd-indexed limbs lands one bit above the
+ * limb it is accumulated into, hence the doubled copy of g; a product
+ * beyond limb 9 wraps around multiplied by 19.
+ */
+static void fe_mul( ed25519_fe h, const ed25519_fe f, const ed25519_fe g )
+{
+    uint64_t t[19];
+    uint32_t g2[10];
+    size_t i, j;
+
+    for( j = 0; j < 10; j++ )
+        g2[j] = g[j] << ( j & 1 );
+
+    memset( t, 0, sizeof( t ) );
+
+    for( i = 0; i < 10; i++ )
+    {
+        const uint32_t *gi = ( i & 1 ) ? g2 : g;
+
+        for( j = 0; j < 10; j++ )
+            t[i + j] += (uint64_t) f[i] * gi[j];
+    }
+
+    for( i = 0; i < 9; i++ )
+        t[i] += 19 * t[i + 10];
+
+    fe_carry( h, t );
+}
+
+/*
+ * h = f^2, computing each cross product once
+ */
+static void fe_sq( ed25519_fe h, const ed25519_fe f )
+{
+    uint64_t t[19];
+    size_t i, j;
+
+    memset( t, 0, sizeof( t ) );
+
+    for( i = 0; i < 10; i++ )
+    {
+        t[2 * i] += (uint64_t) f[i] * ( f[i] << ( i & 1 ) );
+
+        for( j = i + 1; j < 10; j++ )
+            t[i + j] += (uint64_t) ( f[i] << 1 ) * ( f[j] << ( i & j & 1 ) );
+    }
+
+    for( i = 0; i < 9; i++ )
+        t[i] += 19 * t[i + 10];
+
+    fe_carry( h, t );
+}
+
+/*
+ * h = f^(2^n)
+ */
+static void fe_sqn( ed25519_fe h, const ed25519_fe f, size_t n )
+{
+    fe_sq( h, f );
+    while( --n > 0 )
+        fe_sq( h, h );
+}
+
+/*
+ * Conditionally set h = f in constant time. cond must be 0 or 1.
+ */
+static void fe_cmov( ed25519_fe h, const ed25519_fe f, uint32_t cond )
+{
+    uint32_t mask = (uint32_t) 0 - cond;
+    size_t i;
+
+    for( i = 0; i < 10; i++ )
+        h[i] ^= ( h[i] ^ f[i] ) & mask;
+}
+
+/*
+ * Compute z^(2^250 - 1) and z^11, the common part of the addition chains
+ * for inversion and square roots.
+ */
+static void fe_pow_2_250_1( ed25519_fe out, ed25519_fe z11,
+                            const ed25519_fe z )
+{
+    ed25519_fe z2, z9, a, b, c;
+
+    fe_sq( z2, z );                 /* 2 */
+    fe_sqn( a, z2, 2 );             /* 8 */
+    fe_mul( z9, a, z );             /* 9 */
+    fe_mul( z11, z9, z2 );          /* 11 */
+    fe_sq( a, z11 );                /* 22 */
+    fe_mul( a, a, z9 );             /* 2^5 - 1 */
+    fe_sqn( b, a, 5 );
+    fe_mul( b, b, a );              /* 2^10 - 1 */
+    fe_sqn( c, b, 10 );
+    fe_mul( c, c, b );              /* 2^20 - 1 */
+    fe_sqn( out, c, 20 );
+    fe_mul( out, out, c );          /* 2^40 - 1 */
+    fe_sqn( out, out, 10 );
+    fe_mul( b, out, b );            /* 2^50 - 1 */
+    fe_sqn( c, b, 50 );
+    fe_mul( c, c, b );              /* 2^100 - 1 */
+    fe_sqn( out, c, 100 );
+    fe_mul( out, out, c );          /* 2^200 - 1 */
+    fe_sqn( out, out, 50 );
+    fe_mul( out, out, b );          /* 2^250 - 1 */
+}
+
+/*
+ * h = 1 / z = z^(p - 2) = z^(2^255 - 21)
+ */
+static void fe_invert( ed25519_fe h, const ed25519_fe z )
+{
+    ed25519_fe t, z11;
+
+    fe_pow_2_250_1( t, z11, z );
+    fe_sqn( t, t, 5 );
+    fe_mul( h, t, z11 );
+}
+
+/*
+ * h = z^((p - 5) / 8) = z^(2^252 - 3)
+ */
+static void fe_pow22523( ed25519_fe h, const ed25519_fe z )
+{
+    ed25519_fe t, z11;
+
+    fe_pow_2_250_1( t, z11, z );
+    fe_sqn( t, t, 2 );
+    fe_mul( h, t, z );
+}
+
+/*
+ * Load the low 255 bits of the little-endian s.
+ */
+static void fe_frombytes( ed25519_fe h, const unsigned char s[32] )
+{
+    size_t i, k;
+
+    for( i = 0; i < 10; i++ )
+    {
+        size_t off = FE_OFFSET( i );
+        uint64_t v = 0;
+
+        for( k = 0; k < 5 && off / 8 + k < 32; k++ )
+            v |= (uint64_t) s[off / 8 + k] << ( 8 * k );
+
+        h[i] = (uint32_t) ( v >> ( off % 8 ) ) & ( ( 1u << FE_BITS( i ) ) - 1 );
+    }
+}
+
+/*
+ * Write the canonical little-endian encoding of h, in constant time.
+ */
+static void fe_tobytes( unsigned char s[32], const ed25519_fe h )
+{
+    uint64_t t[10], q;
+    size_t i, k;
+
+    for( i = 0; i < 10; i++ )
+        t[i] = h[i];
+
+    /* q = floor((h + 19) / 2^255), which is 1 if h >= p and 0 otherwise */
+    q = 19;
+    for( i = 0; i < 10; i++ )
+        q = ( t[i] + q ) >> FE_BITS( i );
+
+    /* h - q * p = h + 19 * q - q * 2^255: drop the carry out of bit 255 */
+    t[0] += 19 * q;
+    for( i = 0; i < 9; i++ )
+    {
+        t[i + 1] += t[i] >> FE_BITS( i );
+        t[i] &= ( (uint64_t) 1 << FE_BITS( i ) ) - 1;
+    }
+    t[9] &= 0x1ffffff;
+
+    memset( s, 0, 32 );
+    for( i = 0; i < 10; i++ )
+    {
+        size_t off = FE_OFFSET( i );
+        uint64_t v = t[i] << ( off % 8 );
+
+        for( k = 0; k < 5 && off / 8 + k < 32; k++ )
+            s[off / 8 + k] |= (unsigned char) ( v >> ( 8 * k ) );
+    }
+}
+
+static int fe_isnegative( const ed25519_fe f )
+{
+    unsigned char s[32];
+
+    fe_tobytes( s, f );
+    return( s[0] & 1 );
+}
+
+static int fe_iszero( const ed25519_fe f )
+{
+    static const unsigned char zero[32] = { 0 };
+    unsigned char s[32];
+
+    fe_tobytes( s, f );
+    return( memcmp( s, zero, sizeof( s ) ) == 0 );
+}
+
+/*
+ * A point in extended coordinates: x = X / Z, y = Y / Z, x * y = T / Z
+ */
+typedef struct
+{
+    ed25519_fe X, Y, Z, T;
+}
+ed25519_point;
+
+/*
+ * A point prepared to be added to another one: (Y + X, Y - X, 2 * Z,
+ * 2 * d * T)
+ */
+typedef struct
+{
+    ed25519_fe YplusX, YminusX, Z2, T2d;
+}
+ed25519_cached;
+
+/*
+ * j * B for j = 0, ..., 15 in the same form with Z = 1, so that 2 * Z
+ * is implied. B is the base point of RFC 8032.
+ */
+static const ed25519_fe ed25519_base_table[16][3] =
+{
+    {
+      { 0x0000001, 0x0000000, 0x0000000, 0x0000000, 0x0000000,
+        0x0000000, 0x0000000, 0x0000000, 0x0000000, 0x0000000 },
+      { 0x0000001, 0x0000000, 0x0000000, 0x0000000, 0x0000000,
+        0x0000000, 0x0000000, 0x0000000, 0x0000000, 0x0000000 },
+      { 0x0000000, 0x0000000, 0x0000000, 0x0000000, 0x0000000,
+        0x0000000, 0x0000000, 0x0000000, 0x0000000, 0x0000000 }
+    },
+    {
+      { 0x18c3b85, 0x124f1bd, 0x1c325f7, 0x037dc60, 0x33e4cb7,
+        0x03d42c2, 0x1a44c32, 0x14ca4e1, 0x3a33d4b, 0x01f3e74 },
+      { 0x340913e, 0x00e4175, 0x3d673a2, 0x02e8a05, 0x3f4e67c,
+        0x08f8a09, 0x0c21a34, 0x04cf4b8, 0x1298f81, 0x113f4be },
+      { 0x37aaa68, 0x0448161, 0x093d579, 0x11e6556, 0x09b67a0,
+        0x143598c, 0x1bee5ee, 0x0b50b43, 0x289f0c6, 0x1bc45ed }
+    },
+    {
+      { 0x33c71d7, 0x139ff24, 0x2b6b244, 0x0b3d07f, 0x27d1a76,
+        0x1d60702, 0x34d32f0, 0x1c5cb54, 0x3fa87d2, 0x1643018 },
+      { 0x2b4d5a8, 0x0695810, 0x19ed153, 0x0627305, 0x23cae04,
+        0x16e37aa, 0x311b5d8, 0x0aabc13, 0x2669c92, 0x1aed656 },
+      { 0x19b7a5f, 0x0aa2ce9, 0x1ef087f, 0x0eaecd6, 0x0db05af,
+        0x13d6a31, 0x3d04205, 0x16e6a01, 0x313ea50, 0x1c06bd6 }
+    },
+    {
+      { 0x0ee9730, 0x16c2a13, 0x17155e4, 0x1874432, 0x0096a10,
+        0x1016732, 0x1a8014f, 0x11e9823, 0x1b9a80f, 0x1e85938 },
+      { 0x0fcd265, 0x047fa29, 0x34faacc, 0x1ef2e0d, 0x0ef4d4f,
+        0x14bd6bd, 0x0f98d10, 0x14c5026, 0x07555bd, 0x0aae456 },
+      { 0x1d0d889, 0x1a4cfc3, 0x34c4295, 0x110e1ae, 0x162508c,
+        0x0f2db4c, 0x072a2c6, 0x098da2e, 0x2f12b9b, 0x168a09a }
+    },
+    {
+      { 0x2fc099f, 0x0d46e63, 0x0a7050e, 0x1a3efe9, 0x19d971b,
+        0x10a9265, 0x2469efd, 0x0e4f946, 0x0321e58, 0x1a03a44 },
+      { 0x16818bf, 0x1814281, 0x35532bf, 0x18ab307, 0x0c9fa25,
+        0x0a05073, 0x071e683, 0x093587d, 0x0c7445a, 0x09e4cfd },
+      { 0x076ff09, 0x0fefa71, 0x02e4b42, 0x02bdae6, 0x1ba78e5,
+        0x02b4494, 0x1ee7c88, 0x1c56bbb, 0x3f63553, 0x1fe7432 }
+    },
+    {
+      { 0x0a5bb33, 0x0af1102, 0x1a05442, 0x01e3af7, 0x2354123,
+        0x0bfec44, 0x1f5862d, 0x0dd7ba3, 0x3146e20, 0x0a51733 },
+      { 0x047d6ba, 0x060b0e9, 0x136eff2, 0x08a5939, 0x3540053,
+        0x064a087, 0x2788e5c, 0x0be7c67, 0x33eb1b5, 0x05529f9 },
+      { 0x12a8285, 0x0f6fc60, 0x23f9797, 0x03e85ee, 0x09c3820,
+        0x1bda72d, 0x1b3858d, 0x0d35683, 0x296b3bb, 0x10eaaf9 }
+    },
+    {
+      { 0x3157131, 0x13bbadd, 0x1f10741, 0x0480645, 0x26c9c56,
+        0x059a736, 0x2db346d, 0x117b00c, 0x36a2cc3, 0x14795ee },
+      { 0x37d8ca4, 0x001ad9e, 0x0e72933, 0x0213e91, 0x15d6f8a,
+        0x04553b9, 0x02e7390, 0x1109761, 0x01ae417, 0x0e2d931 },
+      { 0x2ea4b71, 0x10c99c0, 0x36030b5, 0x01a0d0d, 0x2f9c380,
+        0x03bc144, 0x2512584, 0x03c6a7c, 0x1a9f0d6, 0x042e3a4 }
+    },
+    {
+      { 0x04ea3bf, 0x0973425, 0x01a4d63, 0x1d59cee, 0x1d1c0d4,
+        0x0542e49, 0x1294114, 0x04fce36, 0x29283c9, 0x1186fa9 },
+      { 0x23221b1, 0x1cb26aa, 0x074f74d, 0x099ddd1, 0x1b28085,
+        0x0192c3a, 0x13b27c9, 0x0fc13bd, 0x1d2e531, 0x075bb75 },
+      { 0x1b8b3a2, 0x0db7200, 0x0935e30, 0x03829f5, 0x2cc0d7d,
+        0x077adf3, 0x220dd2c, 0x014ea53, 0x1c6a0f9, 0x1ea7eec }
+    },
+    {
+      { 0x0dd3e8f, 0x1d65981, 0x2058b36, 0x1bf1443, 0x1b2cc0d,
+        0x0d9c323, 0x1ce332f, 0x0a5f626, 0x2061bce, 0x024579d },
+      { 0x39234d9, 0x1d77b7c, 0x31f3c54, 0x0070daa, 0x258f5da,
+        0x03c23fb, 0x3a0d637, 0x0386584, 0x21320e0, 0x0ea4092 },
+      { 0x1a2911a, 0x07d7672, 0x0fafcf8, 0x1c45e65, 0x2e28dc5,
+        0x0b62a32, 0x2090c87, 0x1d2ac6c, 0x1c2ecc4, 0x09a41f1 }
+    },
+    {
+      { 0x2a8632f, 0x199e2a9, 0x0d8b365, 0x17a8de2, 0x2994279,
+        0x086f5b5, 0x119e4e3, 0x1eb39d6, 0x338add7, 0x0d2e7b4 },
+      { 0x39d8064, 0x1885f80, 0x0337e6d, 0x1b7a902, 0x2628206,
+        0x15eb044, 0x1e30473, 0x191f2d9, 0x11fadc9, 0x1270169 },
+      { 0x045af1b, 0x13a2fe4, 0x245e0d6, 0x14538ce, 0x38bfe0f,
+        0x1d4cf16, 0x37e14c9, 0x160d55e, 0x021b008, 0x1cf05c8 }
+    },
+    {
+      { 0x360748e, 0x164f4ac, 0x00affe3, 0x0a0b0bf, 0x117d4d3,
+        0x1554646, 0x281b1cd, 0x03da1aa, 0x28aae59, 0x10eb1d8 },
+      { 0x27081dd, 0x0d56388, 0x205eebe, 0x1b32d4f, 0x013e060,
+        0x1dc3958, 0x1cba2fa, 0x0e0508e, 0x2c4950b, 0x00d4e0c },
+      { 0x3d0f8d8, 0x14ab900, 0x0681a07, 0x05e9f83, 0x0743073,
+        0x131b509, 0x34f87b3, 0x19cffe2, 0x3470bf4, 0x03b18ab }
+    },
+    {
+      { 0x2802ade, 0x1c02122, 0x1c4e5f7, 0x0781181, 0x39767fb,
+        0x1703406, 0x342388b, 0x1f5e227, 0x22546d8, 0x109d6ab },
+      { 0x1864348, 0x1d6c092, 0x070262b, 0x14bb844, 0x0fb5acd,
+        0x08deb95, 0x03aaab5, 0x0eff474, 0x0029d5c, 0x062ad66 },
+      { 0x16089e9, 0x0cb317f, 0x0949b05, 0x1099417, 0x00c7ad2,
+        0x11a8622, 0x088ccda, 0x1290886, 0x22b53df, 0x0f71954 }
+    },
+    {
+      { 0x31e7539, 0x16010a9, 0x2353c46, 0x0bec1a6, 0x22378f7,
+        0x01a6f93, 0x26e9738, 0x1ab08bd, 0x1e8d3cd, 0x01e2abf },
+      { 0x13d54b9, 0x1e0dd6d, 0x36490ad, 0x0866592, 0x08ecafe,
+        0x0d5dbdd, 0x2fdb72b, 0x05db109, 0x228a602, 0x1e55bb3 },
+      { 0x3944553, 0x165361f, 0x3017dd4, 0x11d1270, 0x3d9b368,
+        0x0976461, 0x1ac4d7a, 0x018dff9, 0x151c83d, 0x0df1a94 }
+    },
+    {
+      { 0x2007f6d, 0x03088a8, 0x3db77ee, 0x0d5ade6, 0x2fe12ce,
+        0x107ba07, 0x107097d, 0x0482a6f, 0x2ec346f, 0x08d3f5f },
+      { 0x27fbf93, 0x1c04ecc, 0x1ed6a0d, 0x04cdbbb, 0x2bbf3af,
+        0x0ad5968, 0x1591955, 0x094f3a2, 0x2d17602, 0x0099e20 },
+      { 0x32ea378, 0x028465c, 0x28e2a6c, 0x18efc6e, 0x090df9a,
+        0x1a7e533, 0x39bfc48, 0x10c745d, 0x3daa097, 0x125ee9b }
+    },
+    {
+      { 0x3213df2, 0x01c3b0f, 0x130e4df, 0x002bf7d, 0x2009dff,
+        0x081bdd5, 0x3a60214, 0x0c60348, 0x32464d1, 0x1babd82 },
+      { 0x0171280, 0x0e29135, 0x0663bfb, 0x07edbe5, 0x339a6c8,
+        0x0ec47a9, 0x32b78b7, 0x01a4225, 0x2c5b3c8, 0x0b7c3a8 },
+      { 0x21e1b82, 0x07161de, 0x3ea92d4, 0x16d154d, 0x3c08e5f,
+        0x0cb1baa, 0x3efb81f, 0x1927383, 0x3cd8ba9, 0x092fdf8 }
+    },
+    {
+      { 0x3cfeaa0, 0x1b300c4, 0x08da499, 0x068c4e1, 0x219230a,
+        0x1f2d4d0, 0x2defd60, 0x0e565b7, 0x17f12de, 0x18788a4 },
+      { 0x28ccf0b, 0x0f36191, 0x21ac081, 0x12154c8, 0x34e0a6e,
+        0x1b25192, 0x0180403, 0x1d7eea1, 0x0218d05, 0x10ed735 },
+      { 0x3d0b516, 0x09d8be6, 0x3ddcbb3, 0x071b9fe, 0x3ace2bd,
+        0x1d64270, 0x32d3ec9, 0x1084065, 0x210ae4d, 0x1447584 }
+    }
+};
+
+static void point_set_zero( ed25519_point *p )
+{
+    fe_set_int( p->X, 0 );
+    fe_set_int( p->Y, 1 );
+    fe_set_int( p->Z, 1 );
+    fe_set_int( p->T, 0 );
+}
+
+static void point_to_cached( ed25519_cached *c, const ed25519_point *p )
+{
+    fe_add( c->YplusX, p->Y, p->X );
+    fe_sub( c->YminusX, p->Y, p->X );
+    fe_add( c->Z2, p->Z, p->Z );
+    fe_mul( c->T2d, p->T, ed25519_2d );
+}
+
+static void base_table_get( ed25519_cached *c, size_t j )
+{
+    fe_copy( c->YplusX, ed25519_base_table[j][0] );
+    fe_copy( c->YminusX, ed25519_base_table[j][1] );
+    fe_set_int( c->Z2, 2 );
+    fe_copy( c->T2d, ed25519_base_table[j][2] );
+}
+
+/*
+ * Constant-time version of base_table_get(): all entries are read.
+ */
+static void base_table_select( ed25519_cached *c, uint32_t digit )
+{
+    uint32_t j;
+
+    base_table_get( c, 0 );
+    for( j = 1; j < 16; j++ )
+    {
+        /* 1 if j == digit, 0 otherwise */
+        uint32_t eq = ( ( j ^ digit ) - 1 ) >> 31;
+
+        fe_cmov( c->YplusX, ed25519_base_table[j][0], eq );
+        fe_cmov( c->YminusX, ed25519_base_table[j][1], eq );
+        fe_cmov( c->T2d, ed25519_base_table[j][2], eq );
+    }
+}
+
+/*
+ * r = p + q, add-2008-hwcd-3 (8M). r may alias p.
+ */
+static void point_add( ed25519_point *r, const ed25519_point *p,
+                       const ed25519_cached *q )
+{
+    ed25519_fe a, b, c, d, e, f, g, h;
+
+    fe_sub( a, p->Y, p->X );
+    fe_mul( a, a, q->YminusX );
+    fe_add( b, p->Y, p->X );
+    fe_mul( b, b, q->YplusX );
+    fe_mul( c, p->T, q->T2d );
+    fe_mul( d, p->Z, q->Z2 );
+
+    fe_sub( e, b, a );
+    fe_sub( f, d, c );
+    fe_add( g, d, c );
+    fe_add( h, b, a );
+
+    fe_mul( r->X, e, f );
+    fe_mul( r->Y, g, h );
+    fe_mul( r->T, e, h );
+    fe_mul( r->Z, f, g );
+}
+
+/*
+ * r = 2 * p, dbl-2008-hwcd with a = -1 (4M + 4S). E, F, G and H are
+ * computed with their signs flipped, which leaves the products
+ * unchanged. r may alias p.
+ */
+static void point_double( ed25519_point *r, const ed25519_point *p )
+{
+    ed25519_fe a, b, c, e, f, g, h;
+
+    fe_sq( a, p->X );
+    fe_sq( b, p->Y );
+    fe_sq( c, p->Z );
+    fe_add( c, c, c );
+
+    fe_add( h, a, b );              /* -H */
+    fe_add( e, p->X, p->Y );
+    fe_sq( e, e );
+    fe_sub( e, h, e );              /* -E */
+    fe_sub( g, a, b );              /* -G */
+    fe_add( f, c, g );              /* -F */
+
+    fe_mul( r->X, e, f );
+    fe_mul( r->Y, g, h );
+    fe_mul( r->T, e, h );
+    fe_mul( r->Z, f, g );
+}
+
+static void point_encode( unsigned char s[32], const ed25519_point *p )
+{
+    ed25519_fe recip, x, y;
+
+    fe_invert( recip, p->Z );
+    fe_mul( x, p->X, recip );
+    fe_mul( y, p->Y, recip );
+    fe_tobytes( s, y );
+    s[31] ^= (unsigned char) ( fe_isnegative( x ) << 7 );
+}
+
+/*
+ * Decode a point as in RFC 8032 section 5.1.3, rejecting non-canonical
+ * encodings. This runs in variable time and is only used on public data.
+ */
+static int point_decode( ed25519_point *p, const unsigned char s[32] )
+{
+    unsigned char buf[32];
+    ed25519_fe u, v, v3, vxx, check;
+    int sign = s[31] >> 7;
+
+    fe_frombytes( p->Y, s );
+    fe_tobytes( buf, p->Y );
+    buf[31] |= s[31] & 0x80;
+    if( memcmp( buf, s, sizeof( buf ) ) != 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    fe_set_int( p->Z, 1 );
+
+    /* u = y^2 - 1, v = d y^2 + 1 */
+    fe_sq( u, p->Y );
+    fe_mul( v, u, ed25519_d );
+    fe_sub( u, u, p->Z );
+    fe_add( v, v, p->Z );
+
+    /* x = u v^3 (u v^7)^((p - 5) / 8) */
+    fe_sq( v3, v );
+    fe_mul( v3, v3, v );
+    fe_sq( p->X, v3 );
+    fe_mul( p->X, p->X, v );
+    fe_mul( p->X, p->X, u );
+    fe_pow22523( p->X, p->X );
+    fe_mul( p->X, p->X, v3 );
+    fe_mul( p->X, p->X, u );
+
+    fe_sq( vxx, p->X );
+    fe_mul( vxx, vxx, v );
+    fe_sub( check, vxx, u );
+    if( ! fe_iszero( check ) )
+    {
+        fe_add( check, vxx, u );
+        if( ! fe_iszero( check ) )
+            return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+        fe_mul( p->X, p->X, ed25519_sqrtm1 );
+    }
+
+    if( fe_iszero( p->X ) && sign )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    if( fe_isnegative( p->X ) != sign )
+        fe_neg( p->X, p->X );
+
+    fe_mul( p->T, p->X, p->Y );
+
+    return( 0 );
+}
+
+/*
+ * r = a * B for a secret scalar a, in constant time: a fixed window of 4
+ * bits, with a table lookup that reads every entry.
+ */
+static void base_mul( ed25519_point *r, const unsigned char a[32] )
+{
+    ed25519_cached c;
+    size_t i;
+
+    point_set_zero( r );
+
+    for( i = 64; i-- > 0; )
+    {
+        uint32_t digit = ( a[i / 2] >> ( 4 * ( i & 1 ) ) ) & 0xf;
+
+        point_double( r, r );
+        point_double( r, r );
+        point_double( r, r );
+        point_double( r, r );
+
+        base_table_select( &c, digit );
+        point_add( r, r, &c );
+    }
+
+    mbedtls_platform_zeroize( &c, sizeof( c ) );
+}
+
+/*
+ * r = a * B + b * P for public scalars a and b, interleaving both
+ * multiplications so that they share their doublings.
+ */
+static void double_mul_vartime( ed25519_point *r, const unsigned char a[32],
+                                const unsigned char b[32],
+                                const ed25519_point *p )
+{
+    ed25519_cached table[16], c;
+    ed25519_point t;
+    int started = 0;
+    size_t i;
+
+    /* table[j] = j * P */
+    point_set_zero( &t );
+    point_to_cached( &table[0], &t );
+    point_to_cached( &table[1], p );
+    t = *p;
+    for( i = 2; i < 16; i++ )
+    {
+        point_add( &t, &t, &table[1] );
+        point_to_cached( &table[i], &t );
+    }
+
+    point_set_zero( r );
+
+    for( i = 64; i-- > 0; )
+    {
+        uint32_t da = ( a[i / 2] >> ( 4 * ( i & 1 ) ) ) & 0xf;
+        uint32_t db = ( b[i / 2] >> ( 4 * ( i & 1 ) ) ) & 0xf;
+
+        if( started )
+        {
+            point_double( r, r );
+            point_double( r, r );
+            point_double( r, r );
+            point_double( r, r );
+        }
+
+        if( da != 0 )
+        {
+            base_table_get( &c, da );
+            point_add( r, r, &c );
+            started = 1;
+        }
+
+        if( db != 0 )
+        {
+            point_add( r, r, &table[db] );
+            started = 1;
+        }
+    }
+}
+
+/*
+ * The group order L = 2^252 + 27742317777372353535851937790883648493,
+ * in 32-bit words, least significant first.
+ */
+static const uint32_t ed25519_L[8] =
+    { 0x5cf5d3ed, 0x5812631a, 0xa2f79cd6, 0x14def9de,
+      0x00000000, 0x00000000, 0x00000000, 0x10000000 };
+
+/*
+ * r = x mod L for a little-endian x of up to 64 Bytes, one bit at a
+ * time with a conditional subtraction, in constant time.
+ */
+static void sc_reduce( unsigned char r[32], const unsigned char *x,
+                       size_t xlen )
+{
+    uint32_t acc[8], t[8], borrow, mask;
+    size_t i, j;
+
+    memset( acc, 0, sizeof( acc ) );
+
+    for( i = 8 * xlen; i-- > 0; )
+    {
+        /* acc < L < 2^253, so 2 * acc + 1 fits in 8 words */
+        for( j = 7; j > 0; j-- )
+            acc[j] = ( acc[j] << 1 ) | ( acc[j - 1] >> 31 );
+        acc[0] = ( acc[0] << 1 ) | ( ( x[i / 8] >> ( i % 8 ) ) & 1 );
+
+        borrow = 0;
+        for( j = 0; j < 8; j++ )
+        {
+            uint64_t d = (uint64_t) acc[j] - ed25519_L[j] - borrow;
+            t[j] = (uint32_t) d;
+            borrow = (uint32_t) ( d >> 32 ) & 1;
+        }
+
+        /* Keep acc - L unless it borrowed */
+        mask = borrow - 1;
+        for( j = 0; j < 8; j++ )
+            acc[j] = ( acc[j] & ~mask ) | ( t[j] & mask );
+    }
+
+    for( j = 0; j < 32; j++ )
+        r[j] = (unsigned char) ( acc[j / 4] >> ( 8 * ( j % 4 ) ) );
+
+    mbedtls_platform_zeroize( acc, sizeof( acc ) );
+    mbedtls_platform_zeroize( t, sizeof( t ) );
+}
+
+/*
+ * s = (a * b + c) mod L, in constant time. a must be less than L and b
+ * and c less than 2^255.
+ */
+static void sc_muladd( unsigned char s[32], const unsigned char a[32],
+                       const unsigned char b[32], const unsigned char c[32] )
+{
+    uint32_t aw[8], bw[8], p[16];
+    unsigned char buf[64];
+    uint64_t t;
+    size_t i, j;
+
+    for( i = 0; i < 8; i++ )
+    {
+        GET_UINT32_LE( aw[i], a, 4 * i );
+        GET_UINT32_LE( bw[i], b, 4 * i );
+        GET_UINT32_LE( p[i], c, 4 * i );
+        p[i + 8] = 0;
+    }
+
+    /* a * b < 2^508, so adding it to c cannot overflow 16 words */
+    for( i = 0; i < 8; i++ )
+    {
+        t = 0;
+        for( j = 0; j < 8; j++ )
+        {
+            t += (uint64_t) aw[i] * bw[j] + p[i + j];
+            p[i + j] = (uint32_t) t;
+            t >>= 32;
+        }
+        for( j = i + 8; j < 16; j++ )
+        {
+            t += p[j];
+            p[j] = (uint32_t) t;
+            t >>= 32;
+        }
+    }
+
+    for( i = 0; i < 64; i++ )
+        buf[i] = (unsigned char) ( p[i / 4] >> ( 8 * ( i % 4 ) ) );
+
+    sc_reduce( s, buf, sizeof( buf ) );
+
+    mbedtls_platform_zeroize( aw, sizeof( aw ) );
+    mbedtls_platform_zeroize( bw, sizeof( bw ) );
+    mbedtls_platform_zeroize( p, sizeof( p ) );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+}
+
+/*
+ * Whether s < L, in variable time
+ */
+static int sc_is_canonical( const unsigned char s[32] )
+{
+    size_t i;
+
+    for( i = 8; i-- > 0; )
+    {
+        uint32_t w;
+
+        GET_UINT32_LE( w, s, 4 * i );
+
+        if( w != ed25519_L[i] )
+            return( w < ed25519_L[i] );
+    }
+
+    return( 0 );
+}
+
+/*
+ * k = SHA-512(p1 || p2 || msg) mod L
+ */
+static int hash_reduce( unsigned char k[32],
+                        const unsigned char p1[32], const unsigned char p2[32],
+                        const unsigned char *msg, size_t msg_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_sha512_context sha;
+    unsigned char h[64];
+
+    mbedtls_sha512_init( &sha );
+
+    if( ( ret = mbedtls_sha512_starts_ret( &sha, 0 ) ) != 0 )
+        goto cleanup;
+    if( p1 != NULL && ( ret = mbedtls_sha512_update_ret( &sha, p1, 32 ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_sha512_update_ret( &sha, p2, 32 ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_sha512_update_ret( &sha, msg, msg_len ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_sha512_finish_ret( &sha, h ) ) != 0 )
+        goto cleanup;
+
+    sc_reduce( k, h, sizeof( h ) );
+
+cleanup:
+    mbedtls_sha512_free( &sha );
+    mbedtls_platform_zeroize( h, sizeof( h ) );
+
+    return( ret );
+}
+
+/*
+ * Derive the secret scalar a and the nonce prefix from the seed
+ * (RFC 8032 section 5.1.5)
+ */
+static int expand_seed( const unsigned char seed[32],
+                        unsigned char a[32], unsigned char prefix[32] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char h[64];
+
+    if( ( ret = mbedtls_sha512_ret( seed, 32, h, 0 ) ) != 0 )
+        goto cleanup;
+
+    h[0] &= 248;
+    h[31] &= 127;
+    h[31] |= 64;
+
+    memcpy( a, h, 32 );
+    if( prefix != NULL )
+        memcpy( prefix, h + 32, 32 );
+
+cleanup:
+    mbedtls_platform_zeroize( h, sizeof( h ) );
+
+    return( ret );
+}
+
+void mbedtls_ed25519_init( mbedtls_ed25519_context *ctx )
+{
+    ED25519_VALIDATE( ctx != NULL );
+
+    memset( ctx, 0, sizeof( mbedtls_ed25519_context ) );
+}
+
+void mbedtls_ed25519_free( mbedtls_ed25519_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_ed25519_context ) );
+}
+
+int mbedtls_ed25519_set_private_key( mbedtls_ed25519_context *ctx,
+                                     const unsigned char *seed,
+                                     size_t seed_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char a[32];
+    ed25519_point A;
+
+    ED25519_VALIDATE_RET( ctx != NULL );
+    ED25519_VALIDATE_RET( seed != NULL );
+
+    if( seed_len != MBEDTLS_ED25519_SEED_SIZE )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    if( ( ret = expand_seed( seed, a, NULL ) ) != 0 )
+        goto cleanup;
+
+    base_mul( &A, a );
+    point_encode( ctx->pub, &A );
+    memcpy( ctx->seed, seed, MBEDTLS_ED25519_SEED_SIZE );
+    ctx->has_pub = 1;
+    ctx->has_priv = 1;
+
+cleanup:
+    mbedtls_platform_zeroize( a, sizeof( a ) );
+    mbedtls_platform_zeroize( &A, sizeof( A ) );
+
+    return( ret );
+}
+
+int mbedtls_ed25519_genkey( mbedtls_ed25519_context *ctx,
+                            int (*f_rng)(void *, unsigned char *, size_t),
+                            void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char seed[MBEDTLS_ED25519_SEED_SIZE];
+
+    ED25519_VALIDATE_RET( ctx != NULL );
+    ED25519_VALIDATE_RET( f_rng != NULL );
+
+    if( f_rng( p_rng, seed, sizeof( seed ) ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+        goto cleanup;
+    }
+
+    ret = mbedtls_ed25519_set_private_key( ctx, seed, sizeof( seed ) );
+
+cleanup:
+    mbedtls_platform_zeroize( seed, sizeof( seed ) );
+
+    return( ret );
+}
+
+int mbedtls_ed25519_set_public_key( mbedtls_ed25519_context *ctx,
+                                    const unsigned char *pub,
+                                    size_t pub_len )
+{
+    ed25519_point A;
+
+    ED25519_VALIDATE_RET( ctx != NULL );
+    ED25519_VALIDATE_RET( pub != NULL );
+
+    if( pub_len != MBEDTLS_ED25519_KEY_SIZE ||
+        point_decode( &A, pub ) != 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    mbedtls_platform_zeroize( ctx->seed, sizeof( ctx->seed ) );
+    memcpy( ctx->pub, pub, MBEDTLS_ED25519_KEY_SIZE );
+    ctx->has_pub = 1;
+    ctx->has_priv = 0;
+
+    return( 0 );
+}
+
+int mbedtls_ed25519_check_pub_priv( const mbedtls_ed25519_context *pub,
+                                    const mbedtls_ed25519_context *prv )
+{
+    ED25519_VALIDATE_RET( pub != NULL );
+    ED25519_VALIDATE_RET( prv != NULL );
+
+    if( ! pub->has_pub || ! prv->has_priv ||
+        memcmp( pub->pub, prv->pub, MBEDTLS_ED25519_KEY_SIZE ) != 0 )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    return( 0 );
+}
+
+/*
+ * RFC 8032 section 5.1.6
+ */
+int mbedtls_ed25519_sign( const mbedtls_ed25519_context *ctx,
+                          const unsigned char *msg, size_t msg_len,
+                          unsigned char sig[MBEDTLS_ED25519_SIG_SIZE] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char a[32], prefix[32], r[32], k[32];
+    ed25519_point R;
+
+    ED25519_VALIDATE_RET( ctx != NULL );
+    ED25519_VALIDATE_RET( msg != NULL || msg_len == 0 );
+    ED25519_VALIDATE_RET( sig != NULL );
+
+    if( ! ctx->has_priv )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    if( ( ret = expand_seed( ctx->seed, a, prefix ) ) != 0 )
+        goto cleanup;
+
+    /* r = SHA-512(prefix || M), R = r * B */
+    if( ( ret = hash_reduce( r, NULL, prefix, msg, msg_len ) ) != 0 )
+        goto cleanup;
+
+    base_mul( &R, r );
+    point_encode( sig, &R );
+
+    /* k = SHA-512(R || A || M), S = r + k * a */
+    if( ( ret = hash_reduce( k, sig, ctx->pub, msg, msg_len ) ) != 0 )
+        goto cleanup;
+
+    sc_muladd( sig + 32, k, a, r );
+
+cleanup:
+    mbedtls_platform_zeroize( a, sizeof( a ) );
+    mbedtls_platform_zeroize( prefix, sizeof( prefix ) );
+    mbedtls_platform_zeroize( r, sizeof( r ) );
+    mbedtls_platform_zeroize( &R, sizeof( R ) );
+
+    return( ret );
+}
+
+/*
+ * RFC 8032 section 5.1.7, checking that S * B - k * A encodes to R
+ */
+int mbedtls_ed25519_verify( const mbedtls_ed25519_context *ctx,
+                            const unsigned char *msg, size_t msg_len,
+                            const unsigned char *sig, size_t sig_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char k[32], check[32];
+    ed25519_point A, R;
+
+    ED25519_VALIDATE_RET( ctx != NULL );
+    ED25519_VALIDATE_RET( msg != NULL || msg_len == 0 );
+    ED25519_VALIDATE_RET( sig != NULL || sig_len == 0 );
+
+    if( ! ctx->has_pub )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    if( sig_len < MBEDTLS_ED25519_SIG_SIZE || ! sc_is_canonical( sig + 32 ) )
+        return( MBEDTLS_ERR_ECP_VERIFY_FAILED );
+
+    if( point_decode( &A, ctx->pub ) != 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    fe_neg( A.X, A.X );
+    fe_neg( A.T, A.T );
+
+    if( ( ret = hash_reduce( k, sig, ctx->pub, msg, msg_len ) ) != 0 )
+        return( ret );
+
+    double_mul_vartime( &R, sig + 32, k, &A );
+    point_encode( check, &R );
+
+    if( memcmp( check, sig, 32 ) != 0 )
+        return( MBEDTLS_ERR_ECP_VERIFY_FAILED );
+
+    if( sig_len != MBEDTLS_ED25519_SIG_SIZE )
+        return( MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH );
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf     printf
+#endif
+
+/*
+ * Test vectors 1 and 3 from RFC 8032 section 7.1
+ */
+static const unsigned char ed25519_test_seed[2][32] =
+{
+    { 0x9d, 0x61, 0xb1, 0x9d, 0xef, 0xfd, 0x5a, 0x60,
+      0xba, 0x84, 0x4a, 0xf4, 0x92, 0xec, 0x2c, 0xc4,
+      0x44, 0x49, 0xc5, 0x69, 0x7b, 0x32, 0x69, 0x19,
+      0x70, 0x3b, 0xac, 0x03, 0x1c, 0xae, 0x7f, 0x60 },
+    { 0xc5, 0xaa, 0x8d, 0xf4, 0x3f, 0x9f, 0x83, 0x7b,
+      0xed, 0xb7, 0x44, 0x2f, 0x31, 0xdc, 0xb7, 0xb1,
+      0x66, 0xd3, 0x85, 0x35, 0x07, 0x6f, 0x09, 0x4b,
+      0x85, 0xce, 0x3a, 0x2e, 0x0b, 0x44, 0x58, 0xf7 },
+};
+
+static const unsigned char ed25519_test_pub[2][32] =
+{
+    { 0xd7, 0x5a, 0x98, 0x01, 0x82, 0xb1, 0x0a, 0xb7,
+      0xd5, 0x4b, 0xfe, 0xd3, 0xc9, 0x64, 0x07, 0x3a,
+      0x0e, 0xe1, 0x72, 0xf3, 0xda, 0xa6, 0x23, 0x25,
+      0xaf, 0x02, 0x1a, 0x68, 0xf7, 0x07, 0x51, 0x1a },
+    { 0xfc, 0x51, 0xcd, 0x8e, 0x62, 0x18, 0xa1, 0xa3,
+      0x8d, 0xa4, 0x7e, 0xd0, 0x02, 0x30, 0xf0, 0x58,
+      0x08, 0x16, 0xed, 0x13, 0xba, 0x33, 0x03, 0xac,
+      0x5d, 0xeb, 0x91, 0x15, 0x48, 0x90, 0x80, 0x25 },
+};
+
+static const unsigned char ed25519_test_msg[2][2] =
+{
+    { 0 },
+    { 0xaf, 0x82 },
+};
+
+static const size_t ed25519_test_msg_len[2] = { 0, 2 };
+
+static const unsigned char ed25519_test_sig[2][64] =
+{
+    { 0xe5, 0x56, 0x43, 0x00, 0xc3, 0x60, 0xac, 0x72,
+      0x90, 0x86, 0xe2, 0xcc, 0x80, 0x6e, 0x82, 0x8a,
+      0x84, 0x87, 0x7f, 0x1e, 0xb8, 0xe5, 0xd9, 0x74,
+      0xd8, 0x73, 0xe0, 0x65, 0x22, 0x49, 0x01, 0x55,
+      0x5f, 0xb8, 0x82, 0x15, 0x90, 0xa3, 0x3b, 0xac,
+      0xc6, 0x1e, 0x39, 0x70, 0x1c, 0xf9, 0xb4, 0x6b,
+      0xd2, 0x5b, 0xf5, 0xf0, 0x59, 0x5b, 0xbe, 0x24,
+      0x65, 0x51, 0x41, 0x43, 0x8e, 0x7a, 0x10, 0x0b },
+    { 0x62, 0x91, 0xd6, 0x57, 0xde, 0xec, 0x24, 0x02,
+      0x48, 0x27, 0xe6, 0x9c, 0x3a, 0xbe, 0x01, 0xa3,
+      0x0c, 0xe5, 0x48, 0xa2, 0x84, 0x74, 0x3a, 0x44,
+      0x5e, 0x36, 0x80, 0xd7, 0xdb, 0x5a, 0xc3, 0xac,
+      0x18, 0xff, 0x9b, 0x53, 0x8d, 0x16, 0xf2, 0x90,
+      0xae, 0x67, 0xf7, 0x60, 0x98, 0x4d, 0xc6, 0x59,
+      0x4a, 0x7c, 0x15, 0xe9, 0x71, 0x6e, 0xd2, 0x8d,
+      0xc0, 0x27, 0xbe, 0xce, 0xea, 0x1e, 0xc4, 0x0a },
+};
+
+/*
+ * Checkup routine
+ */
+int mbedtls_ed25519_self_test( int verbose )
+{
+    int ret = 1;
+    mbedtls_ed25519_context ctx;
+    unsigned char sig[MBEDTLS_ED25519_SIG_SIZE];
+    size_t i;
+
+    mbedtls_ed25519_init( &ctx );
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  Ed25519 test #%u (sign): ", (unsigned) i + 1 );
+
+        if( mbedtls_ed25519_set_private_key( &ctx, ed25519_test_seed[i],
+                                             32 ) != 0 ||
+            memcmp( ctx.pub, ed25519_test_pub[i], 32 ) != 0 ||
+            mbedtls_ed25519_sign( &ctx, ed25519_test_msg[i],
+                                  ed25519_test_msg_len[i], sig ) != 0 ||
+            memcmp( sig, ed25519_test_sig[i], sizeof( sig ) ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+            goto cleanup;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n  Ed25519 test #%u (verify): ",
+                            (unsigned) i + 1 );
+
+        if( mbedtls_ed25519_set_public_key( &ctx, ed25519_test_pub[i],
+                                            32 ) != 0 ||
+            mbedtls_ed25519_verify( &ctx, ed25519_test_msg[i],
+                                    ed25519_test_msg_len[i],
+                                    ed25519_test_sig[i], 64 ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+            goto cleanup;
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    ret = 0;
+
+cleanup:
+    mbedtls_ed25519_free( &ctx );
+
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_ED25519_C */
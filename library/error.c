@@ -813,6 +813,8 @@ const char * mbedtls_low_level_strerr( int error_code )
             return( "NET - Polling the net context failed" );
         case -(MBEDTLS_ERR_NET_BAD_INPUT_DATA):
             return( "NET - Input invalid" );
+        case -(MBEDTLS_ERR_NET_KTLS_UNAVAILABLE):
+            return( "NET - Kernel TLS offload is not available for this socket or cipher" );
 #endif /* MBEDTLS_NET_C */
 
 #if defined(MBEDTLS_OID_C)
@@ -876,6 +878,8 @@ const char * mbedtls_low_level_strerr( int error_code )
             return( "THREADING - Bad input parameters to function" );
         case -(MBEDTLS_ERR_THREADING_MUTEX_ERROR):
             return( "THREADING - Locking / unlocking / free failed with error code" );
+        case -(MBEDTLS_ERR_THREADING_THREAD_ERROR):
+            return( "THREADING - Creating or joining a thread failed" );
 #endif /* MBEDTLS_THREADING_C */
 
 #if defined(MBEDTLS_XTEA_C)
@@ -41,8 +41,10 @@
 
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
 
 #include <string.h>
+#include <limits.h>
 
 #if (defined(_WIN32) || defined(_WIN32_WCE)) && !defined(EFIX64) && \
     !defined(EFI32)
@@ -85,6 +87,7 @@ static int wsa_init_done = 0;
 #include <sys/time.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <netdb.h>
 #include <errno.h>
@@ -93,6 +96,24 @@ static int wsa_init_done = 0;
 
 #endif /* ( _WIN32 || _WIN32_WCE ) && !EFIX64 && !EFI32 */
 
+#if defined(MBEDTLS_SSL_KTLS) && defined(__linux__)
+#include <netinet/tcp.h>
+#include <linux/tls.h>
+
+#if !defined(TCP_ULP)
+#define TCP_ULP 31
+#endif
+#if !defined(SOL_TLS)
+#define SOL_TLS 282
+#endif
+
+#define NET_HAVE_KTLS
+#endif /* MBEDTLS_SSL_KTLS && __linux__ */
+
+/* Maximum number of buffers passed to a single vectored write; POSIX
+ * guarantees at least 16 for IOV_MAX */
+#define NET_IOV_MAX 16
+
 /* Some MS functions want int and MSVC warns if we pass size_t,
  * but the standard functions use socklen_t, so cast only for MSVC */
 #if defined(_MSC_VER)
@@ -541,6 +562,29 @@ void mbedtls_net_usleep( unsigned long usec )
 #endif
 }
 
+/*
+ * Translate the error of a failed read into an error code
+ */
+static int net_recv_error( void *ctx )
+{
+    if( net_would_block( ctx ) != 0 )
+        return( MBEDTLS_ERR_SSL_WANT_READ );
+
+#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
+    !defined(EFI32)
+    if( WSAGetLastError() == WSAECONNRESET )
+        return( MBEDTLS_ERR_NET_CONN_RESET );
+#else
+    if( errno == EPIPE || errno == ECONNRESET )
+        return( MBEDTLS_ERR_NET_CONN_RESET );
+
+    if( errno == EINTR )
+        return( MBEDTLS_ERR_SSL_WANT_READ );
+#endif
+
+    return( MBEDTLS_ERR_NET_RECV_FAILED );
+}
+
 /*
  * Read at most 'len' characters
  */
@@ -555,24 +599,7 @@ int mbedtls_net_recv( void *ctx, unsigned char *buf, size_t len )
     ret = (int) read( fd, buf, len );
 
     if( ret < 0 )
-    {
-        if( net_would_block( ctx ) != 0 )
-            return( MBEDTLS_ERR_SSL_WANT_READ );
-
-#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
-    !defined(EFI32)
-        if( WSAGetLastError() == WSAECONNRESET )
-            return( MBEDTLS_ERR_NET_CONN_RESET );
-#else
-        if( errno == EPIPE || errno == ECONNRESET )
-            return( MBEDTLS_ERR_NET_CONN_RESET );
-
-        if( errno == EINTR )
-            return( MBEDTLS_ERR_SSL_WANT_READ );
-#endif
-
-        return( MBEDTLS_ERR_NET_RECV_FAILED );
-    }
+        return( net_recv_error( ctx ) );
 
     return( ret );
 }
@@ -628,6 +655,29 @@ int mbedtls_net_recv_timeout( void *ctx, unsigned char *buf,
     return( mbedtls_net_recv( ctx, buf, len ) );
 }
 
+/*
+ * Translate the error of a failed write into an error code
+ */
+static int net_send_error( void *ctx )
+{
+    if( net_would_block( ctx ) != 0 )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
+    !defined(EFI32)
+    if( WSAGetLastError() == WSAECONNRESET )
+        return( MBEDTLS_ERR_NET_CONN_RESET );
+#else
+    if( errno == EPIPE || errno == ECONNRESET )
+        return( MBEDTLS_ERR_NET_CONN_RESET );
+
+    if( errno == EINTR )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+#endif
+
+    return( MBEDTLS_ERR_NET_SEND_FAILED );
+}
+
 /*
  * Write at most 'len' characters
  */
@@ -642,27 +692,249 @@ int mbedtls_net_send( void *ctx, const unsigned char *buf, size_t len )
     ret = (int) write( fd, buf, len );
 
     if( ret < 0 )
+        return( net_send_error( ctx ) );
+
+    return( ret );
+}
+
+/*
+ * Write the content of several buffers at once
+ */
+int mbedtls_net_send_vec( void *ctx, const mbedtls_ssl_iovec *iov,
+                          size_t iovcnt )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int fd = ((mbedtls_net_context *) ctx)->fd;
+    size_t i, total = 0;
+#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
+    !defined(EFI32)
+    WSABUF vec[NET_IOV_MAX];
+    DWORD sent = 0;
+#else
+    struct iovec vec[NET_IOV_MAX];
+#endif
+
+    if( fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    if( iovcnt == 0 )
+        return( 0 );
+
+    /* Sending only a prefix of the data is allowed, so just stop at what
+     * fits in one call and in the return value */
+    for( i = 0; i < iovcnt && i < NET_IOV_MAX; i++ )
     {
-        if( net_would_block( ctx ) != 0 )
-            return( MBEDTLS_ERR_SSL_WANT_WRITE );
+        if( iov[i].len > (size_t) INT_MAX - total )
+            break;
+        total += iov[i].len;
 
 #if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
     !defined(EFI32)
-        if( WSAGetLastError() == WSAECONNRESET )
-            return( MBEDTLS_ERR_NET_CONN_RESET );
+        vec[i].buf = (char *) iov[i].base;
+        vec[i].len = (ULONG) iov[i].len;
 #else
-        if( errno == EPIPE || errno == ECONNRESET )
-            return( MBEDTLS_ERR_NET_CONN_RESET );
+        vec[i].iov_base = (void *) iov[i].base;
+        vec[i].iov_len  = iov[i].len;
+#endif
+    }
 
-        if( errno == EINTR )
-            return( MBEDTLS_ERR_SSL_WANT_WRITE );
+    if( i == 0 )
+        return( mbedtls_net_send( ctx, iov[0].base, iov[0].len ) );
+
+#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
+    !defined(EFI32)
+    if( WSASend( (SOCKET) fd, vec, (DWORD) i, &sent, 0, NULL, NULL ) != 0 )
+        return( net_send_error( ctx ) );
+
+    ret = (int) sent;
+#else
+    ret = (int) writev( fd, vec, (int) i );
+
+    if( ret < 0 )
+        return( net_send_error( ctx ) );
 #endif
 
-        return( MBEDTLS_ERR_NET_SEND_FAILED );
+    return( ret );
+}
+
+#if defined(MBEDTLS_SSL_KTLS)
+/*
+ * Hand the record protection of one direction over to the kernel
+ */
+int mbedtls_net_ktls_enable( mbedtls_net_context *ctx, int direction,
+                             const mbedtls_ssl_record_keys *keys )
+{
+#if defined(NET_HAVE_KTLS)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    union
+    {
+        struct tls12_crypto_info_aes_gcm_128 gcm128;
+        struct tls12_crypto_info_aes_gcm_256 gcm256;
+#if defined(TLS_CIPHER_CHACHA20_POLY1305)
+        struct tls12_crypto_info_chacha20_poly1305 chachapoly;
+#endif
+    } info;
+    socklen_t info_len;
+
+    if( ctx->fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    if( keys == NULL ||
+        ( direction != MBEDTLS_SSL_KTLS_TX &&
+          direction != MBEDTLS_SSL_KTLS_RX ) )
+    {
+        return( MBEDTLS_ERR_NET_BAD_INPUT_DATA );
+    }
+
+    memset( &info, 0, sizeof( info ) );
+
+    /* With GCM, the explicit part of the nonce is the sequence number */
+    switch( keys->cipher )
+    {
+        case MBEDTLS_CIPHER_AES_128_GCM:
+            if( keys->key_len != TLS_CIPHER_AES_GCM_128_KEY_SIZE ||
+                keys->iv_len != TLS_CIPHER_AES_GCM_128_SALT_SIZE )
+                return( MBEDTLS_ERR_NET_BAD_INPUT_DATA );
+
+            info.gcm128.info.version = TLS_1_2_VERSION;
+            info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+            memcpy( info.gcm128.key, keys->key, keys->key_len );
+            memcpy( info.gcm128.salt, keys->iv, keys->iv_len );
+            memcpy( info.gcm128.iv, keys->seq, TLS_CIPHER_AES_GCM_128_IV_SIZE );
+            memcpy( info.gcm128.rec_seq, keys->seq,
+                    TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE );
+            info_len = sizeof( info.gcm128 );
+            break;
+
+        case MBEDTLS_CIPHER_AES_256_GCM:
+            if( keys->key_len != TLS_CIPHER_AES_GCM_256_KEY_SIZE ||
+                keys->iv_len != TLS_CIPHER_AES_GCM_256_SALT_SIZE )
+                return( MBEDTLS_ERR_NET_BAD_INPUT_DATA );
+
+            info.gcm256.info.version = TLS_1_2_VERSION;
+            info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+            memcpy( info.gcm256.key, keys->key, keys->key_len );
+            memcpy( info.gcm256.salt, keys->iv, keys->iv_len );
+            memcpy( info.gcm256.iv, keys->seq, TLS_CIPHER_AES_GCM_256_IV_SIZE );
+            memcpy( info.gcm256.rec_seq, keys->seq,
+                    TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE );
+            info_len = sizeof( info.gcm256 );
+            break;
+
+#if defined(TLS_CIPHER_CHACHA20_POLY1305)
+        case MBEDTLS_CIPHER_CHACHA20_POLY1305:
+            if( keys->key_len != TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE ||
+                keys->iv_len != TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE )
+                return( MBEDTLS_ERR_NET_BAD_INPUT_DATA );
+
+            info.chachapoly.info.version = TLS_1_2_VERSION;
+            info.chachapoly.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+            memcpy( info.chachapoly.key, keys->key, keys->key_len );
+            memcpy( info.chachapoly.iv, keys->iv, keys->iv_len );
+            memcpy( info.chachapoly.rec_seq, keys->seq,
+                    TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE );
+            info_len = sizeof( info.chachapoly );
+            break;
+#endif /* TLS_CIPHER_CHACHA20_POLY1305 */
+
+        default:
+            return( MBEDTLS_ERR_NET_KTLS_UNAVAILABLE );
+    }
+
+    /* The ULP is already attached if the other direction was enabled */
+    if( setsockopt( ctx->fd, IPPROTO_TCP, TCP_ULP, "tls",
+                    sizeof( "tls" ) ) != 0 && errno != EEXIST )
+    {
+        ret = MBEDTLS_ERR_NET_KTLS_UNAVAILABLE;
+        goto exit;
+    }
+
+    if( setsockopt( ctx->fd, SOL_TLS,
+                    direction == MBEDTLS_SSL_KTLS_TX ? TLS_TX : TLS_RX,
+                    &info, info_len ) != 0 )
+    {
+        ret = MBEDTLS_ERR_NET_KTLS_UNAVAILABLE;
+        goto exit;
     }
 
+    ret = 0;
+
+exit:
+    mbedtls_platform_zeroize( &info, sizeof( info ) );
+
     return( ret );
+#else
+    ((void) ctx);
+    ((void) direction);
+    ((void) keys);
+
+    return( MBEDTLS_ERR_NET_KTLS_UNAVAILABLE );
+#endif /* NET_HAVE_KTLS */
+}
+
+/*
+ * Read application data from a socket whose receive direction is handled
+ * by the kernel, reporting other records as errors
+ */
+int mbedtls_net_ktls_recv( void *ctx, unsigned char *buf, size_t len )
+{
+#if defined(NET_HAVE_KTLS)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int fd = ((mbedtls_net_context *) ctx)->fd;
+    unsigned char record_type;
+    char control[CMSG_SPACE( sizeof( record_type ) )];
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+
+    if( fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    /* Skip warning alerts, as mbedtls_ssl_read() does, without returning
+     * to the caller: a blocking socket must not report WANT_READ */
+    for( ;; )
+    {
+        record_type = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+
+        memset( &msg, 0, sizeof( msg ) );
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof( control );
+
+        ret = (int) recvmsg( fd, &msg, 0 );
+
+        if( ret < 0 )
+            return( net_recv_error( ctx ) );
+
+        cmsg = CMSG_FIRSTHDR( &msg );
+        if( cmsg != NULL && cmsg->cmsg_level == SOL_TLS &&
+            cmsg->cmsg_type == TLS_GET_RECORD_TYPE )
+        {
+            record_type = *(unsigned char *) CMSG_DATA( cmsg );
+        }
+
+        if( record_type == MBEDTLS_SSL_MSG_APPLICATION_DATA )
+            return( ret );
+
+        if( record_type != MBEDTLS_SSL_MSG_ALERT || ret != 2 )
+            break;
+
+        if( buf[1] == MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY )
+            return( MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY );
+
+        if( buf[0] == MBEDTLS_SSL_ALERT_LEVEL_FATAL )
+            return( MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE );
+    }
+
+    return( MBEDTLS_ERR_SSL_UNEXPECTED_MESSAGE );
+#else
+    return( mbedtls_net_recv( ctx, buf, len ) );
+#endif /* NET_HAVE_KTLS */
 }
+#endif /* MBEDTLS_SSL_KTLS */
 
 /*
  * Close the connection
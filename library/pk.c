@@ -122,6 +122,10 @@ const mbedtls_pk_info_t * mbedtls_pk_info_from_type( mbedtls_pk_type_t pk_type )
 #if defined(MBEDTLS_ECDSA_C)
         case MBEDTLS_PK_ECDSA:
             return( &mbedtls_ecdsa_info );
+#endif
+#if defined(MBEDTLS_ED25519_C)
+        case MBEDTLS_PK_ED25519:
+            return( &mbedtls_ed25519_info );
 #endif
         /* MBEDTLS_PK_RSA_ALT omitted on purpose */
         default:
@@ -529,6 +533,25 @@ int mbedtls_pk_check_pair( const mbedtls_pk_context *pub, const mbedtls_pk_conte
     return( prv->pk_info->check_pair_func( pub->pk_ctx, prv->pk_ctx ) );
 }
 
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+/*
+ * Pre-compute data for verification
+ */
+int mbedtls_pk_precompute( mbedtls_pk_context *ctx )
+{
+    PK_VALIDATE_RET( ctx != NULL );
+
+    if( ctx->pk_info == NULL )
+        return( MBEDTLS_ERR_PK_BAD_INPUT_DATA );
+
+    if( ctx->pk_info->type != MBEDTLS_PK_ECKEY &&
+        ctx->pk_info->type != MBEDTLS_PK_ECDSA )
+        return( 0 );
+
+    return( mbedtls_ecp_keypair_precompute( mbedtls_pk_ec( *ctx ) ) );
+}
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
+
 /*
  * Get key size in bits
  */
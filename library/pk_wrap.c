@@ -36,6 +36,10 @@
 #include "mbedtls/ecdsa.h"
 #endif
 
+#if defined(MBEDTLS_ED25519_C)
+#include "mbedtls/ed25519.h"
+#endif
+
 #if defined(MBEDTLS_USE_PSA_CRYPTO)
 #include "mbedtls/asn1write.h"
 #endif
@@ -246,6 +250,15 @@ static int eckey_verify_wrap( void *ctx, mbedtls_md_type_t md_alg,
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_ecdsa_context ecdsa;
 
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES) && !defined(MBEDTLS_USE_PSA_CRYPTO)
+    /* A copy would not have the table pre-computed by mbedtls_pk_precompute(),
+     * which also filled in the base point table, so that verifying with the
+     * key pair itself does not modify it */
+    if( ( (mbedtls_ecp_keypair *) ctx )->T != NULL )
+        return( ecdsa_verify_wrap( ctx, md_alg, hash, hash_len,
+                                   sig, sig_len ) );
+#endif
+
     mbedtls_ecdsa_init( &ecdsa );
 
     if( ( ret = mbedtls_ecdsa_from_keypair( &ecdsa, ctx ) ) == 0 )
@@ -737,6 +750,107 @@ const mbedtls_pk_info_t mbedtls_ecdsa_info = {
 };
 #endif /* MBEDTLS_ECDSA_C */
 
+#if defined(MBEDTLS_ED25519_C)
+/*
+ * Ed25519 signs the message itself: callers pass it in place of the hash,
+ * with md_alg set to MBEDTLS_MD_NONE.
+ */
+static size_t ed25519_get_bitlen( const void *ctx )
+{
+    ((void) ctx);
+    return( 256 );
+}
+
+static int ed25519_can_do( mbedtls_pk_type_t type )
+{
+    return( type == MBEDTLS_PK_ED25519 );
+}
+
+static int ed25519_verify_wrap( void *ctx, mbedtls_md_type_t md_alg,
+                       const unsigned char *hash, size_t hash_len,
+                       const unsigned char *sig, size_t sig_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( md_alg != MBEDTLS_MD_NONE )
+        return( MBEDTLS_ERR_PK_BAD_INPUT_DATA );
+
+    ret = mbedtls_ed25519_verify( (mbedtls_ed25519_context *) ctx,
+                                  hash, hash_len, sig, sig_len );
+
+    if( ret == MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH )
+        return( MBEDTLS_ERR_PK_SIG_LEN_MISMATCH );
+
+    return( ret );
+}
+
+static int ed25519_sign_wrap( void *ctx, mbedtls_md_type_t md_alg,
+                   const unsigned char *hash, size_t hash_len,
+                   unsigned char *sig, size_t *sig_len,
+                   int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ((void) f_rng);
+    ((void) p_rng);
+
+    if( md_alg != MBEDTLS_MD_NONE )
+        return( MBEDTLS_ERR_PK_BAD_INPUT_DATA );
+
+    ret = mbedtls_ed25519_sign( (mbedtls_ed25519_context *) ctx,
+                                hash, hash_len, sig );
+    if( ret == 0 )
+        *sig_len = MBEDTLS_ED25519_SIG_SIZE;
+
+    return( ret );
+}
+
+static int ed25519_check_pair( const void *pub, const void *prv )
+{
+    return( mbedtls_ed25519_check_pub_priv(
+                (const mbedtls_ed25519_context *) pub,
+                (const mbedtls_ed25519_context *) prv ) );
+}
+
+static void *ed25519_alloc_wrap( void )
+{
+    void *ctx = mbedtls_calloc( 1, sizeof( mbedtls_ed25519_context ) );
+
+    if( ctx != NULL )
+        mbedtls_ed25519_init( (mbedtls_ed25519_context *) ctx );
+
+    return( ctx );
+}
+
+static void ed25519_free_wrap( void *ctx )
+{
+    mbedtls_ed25519_free( (mbedtls_ed25519_context *) ctx );
+    mbedtls_free( ctx );
+}
+
+const mbedtls_pk_info_t mbedtls_ed25519_info = {
+    MBEDTLS_PK_ED25519,
+    "Ed25519",
+    ed25519_get_bitlen,
+    ed25519_can_do,
+    ed25519_verify_wrap,
+    ed25519_sign_wrap,
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECP_RESTARTABLE)
+    NULL,
+    NULL,
+#endif
+    NULL,
+    NULL,
+    ed25519_check_pair,
+    ed25519_alloc_wrap,
+    ed25519_free_wrap,
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECP_RESTARTABLE)
+    NULL,
+    NULL,
+#endif
+    NULL,
+};
+#endif /* MBEDTLS_ED25519_C */
+
 #if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
 /*
  * Support for alternative RSA-private implementations
@@ -599,6 +599,15 @@ static int pk_get_pk_alg( unsigned char **p,
         return( MBEDTLS_ERR_PK_INVALID_ALG );
     }
 
+    /*
+     * Parameters must be absent with Ed25519 (RFC 8410)
+     */
+    if( *pk_alg == MBEDTLS_PK_ED25519 &&
+        ( params->tag != 0 || params->len != 0 ) )
+    {
+        return( MBEDTLS_ERR_PK_INVALID_ALG );
+    }
+
     return( 0 );
 }
 
@@ -659,6 +668,18 @@ int mbedtls_pk_parse_subpubkey( unsigned char **p, const unsigned char *end,
             ret = pk_get_ecpubkey( p, end, mbedtls_pk_ec( *pk ) );
     } else
 #endif /* MBEDTLS_ECP_C */
+#if defined(MBEDTLS_ED25519_C)
+    if( pk_alg == MBEDTLS_PK_ED25519 )
+    {
+        /* The key is the raw 32-byte encoding of the point (RFC 8410) */
+        ret = mbedtls_ed25519_set_public_key( mbedtls_pk_ed25519( *pk ),
+                                              *p, (size_t) ( end - *p ) );
+        if( ret == 0 )
+            *p = (unsigned char *) end;
+        else
+            ret = MBEDTLS_ERR_PK_INVALID_PUBKEY;
+    } else
+#endif /* MBEDTLS_ED25519_C */
         ret = MBEDTLS_ERR_PK_UNKNOWN_PK_ALG;
 
     if( ret == 0 && *p != end )
@@ -983,6 +1004,36 @@ static int pk_parse_key_sec1_der( mbedtls_ecp_keypair *eck,
 }
 #endif /* MBEDTLS_ECP_C */
 
+#if defined(MBEDTLS_ED25519_C)
+/*
+ * Parse an Ed25519 private key (RFC 8410)
+ *
+ *    CurvePrivateKey ::= OCTET STRING
+ */
+static int pk_parse_key_ed25519_der( mbedtls_ed25519_context *ed25519,
+                                     const unsigned char *key,
+                                     size_t keylen )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t len;
+    unsigned char *p = (unsigned char *) key;
+    unsigned char *end = p + keylen;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+                                      MBEDTLS_ASN1_OCTET_STRING ) ) != 0 )
+        return( MBEDTLS_ERR_PK_KEY_INVALID_FORMAT + ret );
+
+    if( p + len != end )
+        return( MBEDTLS_ERR_PK_KEY_INVALID_FORMAT +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    if( mbedtls_ed25519_set_private_key( ed25519, p, len ) != 0 )
+        return( MBEDTLS_ERR_PK_KEY_INVALID_FORMAT );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_ED25519_C */
+
 /*
  * Parse an unencrypted PKCS#8 encoded private key
  *
@@ -1076,6 +1127,17 @@ static int pk_parse_key_pkcs8_unencrypted_der(
         }
     } else
 #endif /* MBEDTLS_ECP_C */
+#if defined(MBEDTLS_ED25519_C)
+    if( pk_alg == MBEDTLS_PK_ED25519 )
+    {
+        if( ( ret = pk_parse_key_ed25519_der( mbedtls_pk_ed25519( *pk ),
+                                              p, len ) ) != 0 )
+        {
+            mbedtls_pk_free( pk );
+            return( ret );
+        }
+    } else
+#endif /* MBEDTLS_ED25519_C */
         return( MBEDTLS_ERR_PK_UNKNOWN_PK_ALG );
 
     return( 0 );
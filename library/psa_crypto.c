@@ -68,6 +68,7 @@
 #include "mbedtls/cmac.h"
 #include "mbedtls/des.h"
 #include "mbedtls/ecdh.h"
+#include "mbedtls/ecdsa.h"
 #include "mbedtls/ecp.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/error.h"
@@ -3475,6 +3476,223 @@ psa_status_t psa_verify_hash( mbedtls_svc_key_id_t key,
     return( ( status == PSA_SUCCESS ) ? unlock_status : status );
 }
 
+#if ( defined(MBEDTLS_PSA_BUILTIN_ALG_ECDSA) || \
+      defined(MBEDTLS_PSA_BUILTIN_ALG_DETERMINISTIC_ECDSA) ) && \
+    !defined(MBEDTLS_PSA_CRYPTO_DRIVERS)
+/* Prepare an entry of psa_verify_hash_batch() for batch verification.
+ * On success, *ecp is set if the entry can be verified in a batch, and
+ * left NULL if it must be verified on its own. */
+static psa_status_t psa_verify_hash_batch_prepare(
+    const psa_verify_hash_batch_entry_t *entry,
+    mbedtls_ecp_keypair **ecp, mbedtls_mpi *r, mbedtls_mpi *s )
+{
+    psa_status_t status = PSA_ERROR_CORRUPTION_DETECTED;
+    psa_status_t unlock_status = PSA_ERROR_CORRUPTION_DETECTED;
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    psa_key_slot_t *slot;
+    size_t curve_bytes;
+
+    *ecp = NULL;
+
+    status = psa_get_and_lock_key_slot_with_policy( entry->key, &slot,
+                                                    PSA_KEY_USAGE_VERIFY_HASH,
+                                                    entry->alg );
+    if( status != PSA_SUCCESS )
+        return( status );
+
+    if( ! PSA_KEY_TYPE_IS_ECC( slot->attr.type ) ||
+        PSA_KEY_TYPE_ECC_GET_FAMILY( slot->attr.type ) ==
+        PSA_ECC_FAMILY_MONTGOMERY ||
+        ! PSA_ALG_IS_ECDSA( entry->alg ) ||
+        PSA_KEY_LIFETIME_GET_LOCATION( slot->attr.lifetime ) !=
+        PSA_KEY_LOCATION_LOCAL_STORAGE )
+    {
+        goto exit;
+    }
+
+    /* Same steps as the built-in verify_hash entry point */
+    status = mbedtls_psa_ecp_load_representation( slot->attr.type,
+                                                  slot->attr.bits,
+                                                  slot->key.data,
+                                                  slot->key.bytes,
+                                                  ecp );
+    if( status != PSA_SUCCESS )
+        goto exit;
+
+    curve_bytes = PSA_BITS_TO_BYTES( ( *ecp )->grp.pbits );
+    if( entry->signature_length != 2 * curve_bytes )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( r, entry->signature,
+                                              curve_bytes ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( s,
+                                              entry->signature + curve_bytes,
+                                              curve_bytes ) );
+
+    if( mbedtls_ecp_is_zero( &( *ecp )->Q ) )
+    {
+        MBEDTLS_MPI_CHK(
+            mbedtls_ecp_mul( &( *ecp )->grp, &( *ecp )->Q, &( *ecp )->d,
+                             &( *ecp )->grp.G,
+                             mbedtls_psa_get_random, MBEDTLS_PSA_RANDOM_STATE ) );
+    }
+
+cleanup:
+    status = mbedtls_to_psa_error( ret );
+    if( status != PSA_SUCCESS )
+    {
+        mbedtls_ecp_keypair_free( *ecp );
+        mbedtls_free( *ecp );
+        *ecp = NULL;
+    }
+
+exit:
+    unlock_status = psa_unlock_key_slot( slot );
+
+    return( ( status == PSA_SUCCESS ) ? unlock_status : status );
+}
+#endif /* ( BUILTIN_ALG_ECDSA || BUILTIN_ALG_DETERMINISTIC_ECDSA ) &&
+          !MBEDTLS_PSA_CRYPTO_DRIVERS */
+
+psa_status_t psa_verify_hash_batch( psa_verify_hash_batch_entry_t *entries,
+                                    size_t count )
+{
+    psa_status_t status = PSA_SUCCESS;
+    psa_verify_hash_batch_entry_t *entry;
+    size_t i;
+#if ( defined(MBEDTLS_PSA_BUILTIN_ALG_ECDSA) || \
+      defined(MBEDTLS_PSA_BUILTIN_ALG_DETERMINISTIC_ECDSA) ) && \
+    !defined(MBEDTLS_PSA_CRYPTO_DRIVERS)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t j, n = 0, start, end;
+    mbedtls_ecp_keypair **ecp = NULL;
+    mbedtls_mpi *rs = NULL;
+    mbedtls_ecdsa_batch_entry *batch = NULL;
+    size_t *idx = NULL;
+
+    if( count == 0 )
+        return( PSA_SUCCESS );
+
+    ecp = mbedtls_calloc( count, sizeof( *ecp ) );
+    rs = mbedtls_calloc( 2 * count, sizeof( *rs ) );
+    batch = mbedtls_calloc( count, sizeof( *batch ) );
+    idx = mbedtls_calloc( count, sizeof( *idx ) );
+    if( ecp == NULL || rs == NULL || batch == NULL || idx == NULL )
+    {
+        status = PSA_ERROR_INSUFFICIENT_MEMORY;
+        goto exit;
+    }
+
+    for( i = 0; i < 2 * count; i++ )
+        mbedtls_mpi_init( &rs[i] );
+
+    for( i = 0; i < count; i++ )
+    {
+        entry = &entries[i];
+
+        entry->status = psa_verify_hash_batch_prepare( entry, &ecp[n],
+                                                       &rs[2 * n],
+                                                       &rs[2 * n + 1] );
+        if( entry->status != PSA_SUCCESS )
+            continue;
+
+        if( ecp[n] == NULL )
+        {
+            entry->status = psa_verify_hash( entry->key, entry->alg,
+                                             entry->hash, entry->hash_length,
+                                             entry->signature,
+                                             entry->signature_length );
+            continue;
+        }
+
+        batch[n].buf = entry->hash;
+        batch[n].blen = entry->hash_length;
+        batch[n].Q = &ecp[n]->Q;
+        batch[n].r = &rs[2 * n];
+        batch[n].s = &rs[2 * n + 1];
+        idx[n] = i;
+        n++;
+    }
+
+    /* Verify runs of consecutive signatures on the same curve together */
+    for( start = 0; start < n; start = end )
+    {
+        for( end = start + 1; end < n; end++ )
+        {
+            if( ecp[end]->grp.id != ecp[start]->grp.id )
+                break;
+        }
+
+        /* Entries the batch function does not get to stay failed */
+        for( j = start; j < end; j++ )
+            batch[j].ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+        ret = mbedtls_ecdsa_verify_batch( &ecp[start]->grp, batch + start,
+                                          end - start,
+                                          mbedtls_psa_get_random,
+                                          MBEDTLS_PSA_RANDOM_STATE );
+
+        /* A failure is normally reported on the entries it concerns. If
+         * none of them carries it, fail the whole run. */
+        for( j = start; ret != 0 && j < end; j++ )
+        {
+            if( batch[j].ret != 0 )
+                break;
+        }
+        if( j == end && ret != 0 )
+        {
+            for( j = start; j < end; j++ )
+                batch[j].ret = ret;
+        }
+
+        for( j = start; j < end; j++ )
+            entries[idx[j]].status = mbedtls_to_psa_error( batch[j].ret );
+    }
+#else
+    for( i = 0; i < count; i++ )
+    {
+        entry = &entries[i];
+        entry->status = psa_verify_hash( entry->key, entry->alg,
+                                         entry->hash, entry->hash_length,
+                                         entry->signature,
+                                         entry->signature_length );
+    }
+#endif
+
+    for( i = 0; i < count; i++ )
+    {
+        if( entries[i].status != PSA_SUCCESS )
+        {
+            status = entries[i].status;
+            break;
+        }
+    }
+
+#if ( defined(MBEDTLS_PSA_BUILTIN_ALG_ECDSA) || \
+      defined(MBEDTLS_PSA_BUILTIN_ALG_DETERMINISTIC_ECDSA) ) && \
+    !defined(MBEDTLS_PSA_CRYPTO_DRIVERS)
+exit:
+    for( i = 0; ecp != NULL && i < n; i++ )
+    {
+        mbedtls_ecp_keypair_free( ecp[i] );
+        mbedtls_free( ecp[i] );
+    }
+
+    for( i = 0; rs != NULL && i < 2 * count; i++ )
+        mbedtls_mpi_free( &rs[i] );
+
+    mbedtls_free( ecp );
+    mbedtls_free( rs );
+    mbedtls_free( batch );
+    mbedtls_free( idx );
+#endif
+
+    return( status );
+}
+
 #if defined(MBEDTLS_PSA_BUILTIN_ALG_RSA_OAEP)
 static void psa_rsa_oaep_set_padding_mode( psa_algorithm_t alg,
                                            mbedtls_rsa_context *rsa )
@@ -45,12 +45,21 @@
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
 
+#include "bignum_internal.h"
+
 #include <string.h>
 
-#if defined(MBEDTLS_PKCS1_V21)
+#if defined(MBEDTLS_PKCS1_V21) || defined(MBEDTLS_RSA_GEN_KEY_THREADS)
 #include "mbedtls/md.h"
 #endif
 
+#if defined(MBEDTLS_RSA_GEN_KEY_THREADS) || \
+    defined(MBEDTLS_RSA_PRIVATE_THREADS) || \
+    ( defined(MBEDTLS_RSA_BLINDING_POOL_SIZE) && \
+      defined(MBEDTLS_THREADING_THREADS) )
+#include "mbedtls/threading.h"
+#endif
+
 #if defined(MBEDTLS_PKCS1_V15) && !defined(__OpenBSD__) && !defined(__NetBSD__)
 #include <stdlib.h>
 #endif
@@ -88,6 +97,66 @@ static inline int mbedtls_safer_memcmp( const void *a, const void *b, size_t n )
 }
 #endif /* MBEDTLS_PKCS1_V15 */
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+#if defined(MBEDTLS_THREADING_THREADS)
+/* Values of mbedtls_rsa_context::blinding_thread_state */
+#define RSA_BLINDING_THREAD_NONE    0   /* no thread to join            */
+#define RSA_BLINDING_THREAD_RUNNING 1   /* refilling                    */
+#define RSA_BLINDING_THREAD_DONE    2   /* finished, not joined yet     */
+
+/*
+ * Wait for the background refill of ctx to finish, if there is one. With
+ * stop, no background refill is started afterwards; without it, the
+ * refills requested so far are dropped.
+ */
+static void rsa_blinding_join( mbedtls_rsa_context *ctx, int stop )
+{
+    int state;
+
+    /* The mutex is gone once the context is freed */
+    if( ctx->ver == 0 || mbedtls_mutex_lock( &ctx->mutex ) != 0 )
+        return;
+
+    /* From now on, no thread is started nor joined by anyone else */
+    if( stop )
+        ctx->blinding_background = 0;
+    else
+        ctx->blinding_refill_pending = 0;
+    state = ctx->blinding_thread_state;
+
+    (void) mbedtls_mutex_unlock( &ctx->mutex );
+
+    if( state != RSA_BLINDING_THREAD_NONE )
+        (void) mbedtls_thread_join( &ctx->blinding_thread );
+
+    ctx->blinding_thread_state = RSA_BLINDING_THREAD_NONE;
+    ctx->blinding_refill_pending = 0;
+}
+#endif /* MBEDTLS_THREADING_THREADS */
+
+/*
+ * Drop the precomputed blinding values, which are only valid for the key
+ * they were computed for.
+ */
+static void rsa_blinding_pool_free( mbedtls_rsa_context *ctx )
+{
+    size_t i;
+
+#if defined(MBEDTLS_THREADING_THREADS)
+    /* A refill in progress would add values for the former key */
+    rsa_blinding_join( ctx, 0 );
+#endif
+
+    for( i = 0; i < MBEDTLS_RSA_BLINDING_POOL_SIZE; i++ )
+    {
+        mbedtls_mpi_free( &ctx->blinding_Vi[i] );
+        mbedtls_mpi_free( &ctx->blinding_Vf[i] );
+    }
+
+    ctx->blinding_count = 0;
+}
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE */
+
 int mbedtls_rsa_import( mbedtls_rsa_context *ctx,
                         const mbedtls_mpi *N,
                         const mbedtls_mpi *P, const mbedtls_mpi *Q,
@@ -96,6 +165,10 @@ int mbedtls_rsa_import( mbedtls_rsa_context *ctx,
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     RSA_VALIDATE_RET( ctx != NULL );
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    rsa_blinding_pool_free( ctx );
+#endif
+
     if( ( N != NULL && ( ret = mbedtls_mpi_copy( &ctx->N, N ) ) != 0 ) ||
         ( P != NULL && ( ret = mbedtls_mpi_copy( &ctx->P, P ) ) != 0 ) ||
         ( Q != NULL && ( ret = mbedtls_mpi_copy( &ctx->Q, Q ) ) != 0 ) ||
@@ -121,6 +194,10 @@ int mbedtls_rsa_import_raw( mbedtls_rsa_context *ctx,
     int ret = 0;
     RSA_VALIDATE_RET( ctx != NULL );
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    rsa_blinding_pool_free( ctx );
+#endif
+
     if( N != NULL )
     {
         MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &ctx->N, N, N_len ) );
@@ -251,6 +328,10 @@ int mbedtls_rsa_complete( mbedtls_rsa_context *ctx )
 
     RSA_VALIDATE_RET( ctx != NULL );
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    rsa_blinding_pool_free( ctx );
+#endif
+
     have_N = ( mbedtls_mpi_cmp_int( &ctx->N, 0 ) != 0 );
     have_P = ( mbedtls_mpi_cmp_int( &ctx->P, 0 ) != 0 );
     have_Q = ( mbedtls_mpi_cmp_int( &ctx->Q, 0 ) != 0 );
@@ -529,6 +610,280 @@ size_t mbedtls_rsa_get_len( const mbedtls_rsa_context *ctx )
  * This generation method follows the RSA key pair generation procedure of
  * FIPS 186-4 if 2^16 < exponent < 2^256 and nbits = 2048 or nbits = 3072.
  */
+#if defined(MBEDTLS_RSA_GEN_KEY_THREADS)
+/*
+ * Parallel prime generation for mbedtls_rsa_gen_key()
+ *
+ * P and Q are each searched for in a sequence of windows of candidates, as
+ * in mbedtls_mpi_gen_prime(). The windows are cut into work units, which
+ * the threads take in increasing order, P and Q interleaved. The result for
+ * each prime is the first prime in the lowest unit that contains one.
+ *
+ * Every unit draws its random numbers from its own stream, derived from a
+ * seed taken from the caller's RNG, the prime index and the unit index, so
+ * that the result only depends on the seed and not on the number of
+ * threads or on how they are scheduled. The streams are HMAC-SHA-256 in
+ * counter mode (NIST SP 800-108) rather than HMAC_DRBG contexts, which
+ * would create and destroy a mutex in every unit.
+ *
+ * The table of sieving primes is built once per key and shared read-only by
+ * all threads; each thread has its own sieve buffer for the current unit.
+ */
+#define RSA_GEN_KEY_SEED_LEN    32
+#define RSA_GEN_KEY_UNIT        128     /* Candidates per work unit */
+#define RSA_GEN_KEY_UNITS       64      /* Work units per window */
+
+typedef struct
+{
+    const unsigned char *seed;
+    unsigned char info[10];     /* Label, prime index, unit/window index */
+    uint32_t counter;
+}
+rsa_gen_key_stream;
+
+typedef struct
+{
+    struct rsa_gen_key_pool *pool;
+    mbedtls_threading_thread_t thread;
+    int ret;                    /* Error locking the pool */
+}
+rsa_gen_key_worker_ctx;
+
+typedef struct rsa_gen_key_pool
+{
+    mbedtls_threading_mutex_t mutex;
+    unsigned char seed[RSA_GEN_KEY_SEED_LEN];
+    size_t nbits;
+    int flags;
+    uint16_t *primes;           /* Sieving primes, read-only once shared */
+    size_t nprimes;
+    size_t next[2];             /* Next unit to hand out, for P and Q */
+    size_t found[2];            /* Lowest unit with a prime so far */
+    mbedtls_mpi prime[2];
+    int ret;                    /* First error, stops all workers */
+    rsa_gen_key_worker_ctx workers[MBEDTLS_RSA_GEN_KEY_THREADS];
+}
+rsa_gen_key_pool;
+
+static void rsa_gen_key_stream_init( rsa_gen_key_stream *stream,
+                                     const unsigned char *seed,
+                                     unsigned char label, int job,
+                                     size_t index )
+{
+    size_t i;
+
+    stream->seed = seed;
+    stream->info[0] = label;
+    stream->info[1] = (unsigned char) job;
+    for( i = 0; i < 8; i++ )
+        stream->info[2 + i] = (unsigned char)( (uint64_t) index >> ( 56 - 8 * i ) );
+    stream->counter = 0;
+}
+
+static int rsa_gen_key_stream_fill( void *p_stream, unsigned char *output,
+                                    size_t len )
+{
+    int ret = 0;
+    rsa_gen_key_stream *stream = (rsa_gen_key_stream *) p_stream;
+    const mbedtls_md_info_t *md_info;
+    unsigned char input[sizeof( stream->info ) + 4];
+    unsigned char block[32];
+    size_t use;
+
+    md_info = mbedtls_md_info_from_type( MBEDTLS_MD_SHA256 );
+    memcpy( input, stream->info, sizeof( stream->info ) );
+
+    while( len > 0 )
+    {
+        input[sizeof( stream->info )    ] = (unsigned char)( stream->counter >> 24 );
+        input[sizeof( stream->info ) + 1] = (unsigned char)( stream->counter >> 16 );
+        input[sizeof( stream->info ) + 2] = (unsigned char)( stream->counter >>  8 );
+        input[sizeof( stream->info ) + 3] = (unsigned char)( stream->counter       );
+        stream->counter++;
+
+        ret = mbedtls_md_hmac( md_info, stream->seed, RSA_GEN_KEY_SEED_LEN,
+                               input, sizeof( input ), block );
+        if( ret != 0 )
+            break;
+
+        use = ( len < sizeof( block ) ) ? len : sizeof( block );
+        memcpy( output, block, use );
+        output += use;
+        len -= use;
+    }
+
+    mbedtls_platform_zeroize( block, sizeof( block ) );
+
+    return( ret );
+}
+
+/*
+ * Search one work unit of prime number job (0 for P, 1 for Q)
+ */
+static int rsa_gen_key_unit( const rsa_gen_key_pool *pool, int job,
+                             size_t unit, mbedtls_mpi *X,
+                             unsigned char *sieve )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    rsa_gen_key_stream stream;
+
+    rsa_gen_key_stream_init( &stream, pool->seed, 'W', job,
+                             unit / RSA_GEN_KEY_UNITS );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime_start( X, pool->nbits, pool->flags,
+                                                  rsa_gen_key_stream_fill,
+                                                  &stream ) );
+
+    rsa_gen_key_stream_init( &stream, pool->seed, 'M', job, unit );
+    ret = mbedtls_mpi_gen_prime_range( X, pool->nbits, pool->flags,
+                                       pool->primes, pool->nprimes, sieve,
+                                       ( unit % RSA_GEN_KEY_UNITS ) *
+                                       RSA_GEN_KEY_UNIT, RSA_GEN_KEY_UNIT,
+                                       rsa_gen_key_stream_fill, &stream );
+
+cleanup:
+    return( ret );
+}
+
+static void rsa_gen_key_worker( void *arg )
+{
+    int ret, job;
+    rsa_gen_key_worker_ctx *worker = (rsa_gen_key_worker_ctx *) arg;
+    rsa_gen_key_pool *pool = worker->pool;
+    size_t unit = 0;
+    mbedtls_mpi X;
+    unsigned char sieve[RSA_GEN_KEY_UNIT];
+
+    mbedtls_mpi_init( &X );
+
+    while( 1 )
+    {
+        if( ( worker->ret = mbedtls_mutex_lock( &pool->mutex ) ) != 0 )
+            break;
+
+        /* Take the next unit of the prime that is furthest behind */
+        job = -1;
+        if( pool->ret == 0 && pool->next[0] < pool->found[0] )
+            job = 0;
+        if( pool->ret == 0 && pool->next[1] < pool->found[1] &&
+            ( job < 0 || pool->next[1] < pool->next[0] ) )
+            job = 1;
+        if( job >= 0 )
+            unit = pool->next[job]++;
+
+        if( ( worker->ret = mbedtls_mutex_unlock( &pool->mutex ) ) != 0 )
+            break;
+
+        if( job < 0 )
+            break;
+
+        ret = rsa_gen_key_unit( pool, job, unit, &X, sieve );
+
+        if( ( worker->ret = mbedtls_mutex_lock( &pool->mutex ) ) != 0 )
+            break;
+
+        if( ret == 0 && unit < pool->found[job] )
+        {
+            ret = mbedtls_mpi_copy( &pool->prime[job], &X );
+            if( ret == 0 )
+                pool->found[job] = unit;
+        }
+
+        if( ret != 0 && ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE && pool->ret == 0 )
+            pool->ret = ret;
+
+        if( ( worker->ret = mbedtls_mutex_unlock( &pool->mutex ) ) != 0 )
+            break;
+    }
+
+    mbedtls_mpi_free( &X );
+}
+
+/*
+ * Generate P and Q on MBEDTLS_RSA_GEN_KEY_THREADS threads, the calling
+ * thread included. If some threads can't be started, carry on with fewer.
+ *
+ * The pool lives on the heap and is only released once every started worker
+ * has been joined. If a join fails, the worker may still be using the pool,
+ * so it is deliberately left allocated and the error is fatal.
+ */
+static int rsa_gen_key_primes( mbedtls_mpi *P, mbedtls_mpi *Q, size_t nbits,
+                               int flags,
+                               int (*f_rng)(void *, unsigned char *, size_t),
+                               void *p_rng )
+{
+    int ret;
+    rsa_gen_key_pool *pool;
+    size_t i, started = 0;
+
+    pool = mbedtls_calloc( 1, sizeof( *pool ) );
+    if( pool == NULL )
+        return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
+
+    mbedtls_mutex_init( &pool->mutex );
+    mbedtls_mpi_init( &pool->prime[0] );
+    mbedtls_mpi_init( &pool->prime[1] );
+
+    if( ( ret = f_rng( p_rng, pool->seed, sizeof( pool->seed ) ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_mpi_gen_prime_table( &pool->primes,
+                                             &pool->nprimes ) ) != 0 )
+        goto cleanup;
+
+    pool->nbits = nbits;
+    pool->flags = flags;
+    pool->found[0] = pool->found[1] = (size_t) -1;
+
+    for( i = 0; i < MBEDTLS_RSA_GEN_KEY_THREADS; i++ )
+        pool->workers[i].pool = pool;
+
+    for( started = 1; started < MBEDTLS_RSA_GEN_KEY_THREADS; started++ )
+    {
+        if( mbedtls_thread_create( &pool->workers[started].thread,
+                                   rsa_gen_key_worker,
+                                   &pool->workers[started] ) != 0 )
+            break;
+    }
+
+    rsa_gen_key_worker( &pool->workers[0] );
+
+    /* Join every worker, even after a failure, before deciding anything */
+    for( i = 1; i < started; i++ )
+    {
+        if( mbedtls_thread_join( &pool->workers[i].thread ) != 0 )
+            ret = MBEDTLS_ERR_THREADING_THREAD_ERROR;
+    }
+
+    if( ret != 0 )
+        return( ret );
+
+    for( i = 0; i < started && ret == 0; i++ )
+        ret = pool->workers[i].ret;
+
+    if( ret == 0 )
+        ret = pool->ret;
+
+    if( ret == 0 && ( pool->found[0] == (size_t) -1 ||
+                      pool->found[1] == (size_t) -1 ) )
+        ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ret == 0 )
+        ret = mbedtls_mpi_copy( P, &pool->prime[0] );
+    if( ret == 0 )
+        ret = mbedtls_mpi_copy( Q, &pool->prime[1] );
+
+cleanup:
+    mbedtls_mutex_free( &pool->mutex );
+    mbedtls_mpi_free( &pool->prime[0] );
+    mbedtls_mpi_free( &pool->prime[1] );
+    mbedtls_free( pool->primes );
+    mbedtls_platform_zeroize( pool->seed, sizeof( pool->seed ) );
+    mbedtls_free( pool );
+
+    return( ret );
+}
+#endif /* MBEDTLS_RSA_GEN_KEY_THREADS */
+
 int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
                  int (*f_rng)(void *, unsigned char *, size_t),
                  void *p_rng,
@@ -568,11 +923,16 @@ int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
 
     do
     {
+#if defined(MBEDTLS_RSA_GEN_KEY_THREADS)
+        MBEDTLS_MPI_CHK( rsa_gen_key_primes( &ctx->P, &ctx->Q, nbits >> 1,
+                                             prime_quality, f_rng, p_rng ) );
+#else
         MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->P, nbits >> 1,
                                                 prime_quality, f_rng, p_rng ) );
 
         MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->Q, nbits >> 1,
                                                 prime_quality, f_rng, p_rng ) );
+#endif /* MBEDTLS_RSA_GEN_KEY_THREADS */
 
         /* make sure the difference between p and q is not too small (FIPS 186-4 §B.3.3 step 5.4) */
         MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &H, &ctx->P, &ctx->Q ) );
@@ -757,7 +1117,8 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
     }
 
     olen = ctx->len;
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &T, &T, &ctx->E, &ctx->N, &ctx->RN ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod_batch( &T, 1, &ctx->E, &ctx->N,
+                                                &ctx->RN ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &T, output, olen ) );
 
 cleanup:
@@ -774,6 +1135,125 @@ cleanup:
     return( 0 );
 }
 
+/*
+ * Draw a fresh pair of blinding values for ctx: Vf random and invertible
+ * mod N, and Vi = Vf^(-e) mod N. RR is the cache for mbedtls_mpi_exp_mod().
+ */
+static int rsa_gen_blinding( const mbedtls_rsa_context *ctx,
+                             mbedtls_mpi *Vi, mbedtls_mpi *Vf, mbedtls_mpi *RR,
+                             int (*f_rng)(void *, unsigned char *, size_t),
+                             void *p_rng )
+{
+    int ret, count = 0;
+    mbedtls_mpi R;
+
+    mbedtls_mpi_init( &R );
+
+    /* Unblinding value: Vf = random number, invertible mod N */
+    do {
+        if( count++ > 10 )
+        {
+            ret = MBEDTLS_ERR_RSA_RNG_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( Vf, ctx->len - 1, f_rng, p_rng ) );
+
+        /* Compute Vf^-1 as R * (R Vf)^-1 to avoid leaks from inv_mod. */
+        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &R, ctx->len - 1, f_rng, p_rng ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( Vi, Vf, &R ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( Vi, Vi, &ctx->N ) );
+
+        /* At this point, Vi is invertible mod N if and only if both Vf and R
+         * are invertible mod N. If one of them isn't, we don't need to know
+         * which one, we just loop and choose new values for both of them.
+         * (Each iteration succeeds with overwhelming probability.) */
+        ret = mbedtls_mpi_inv_mod( Vi, Vi, &ctx->N );
+        if( ret != 0 && ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+            goto cleanup;
+
+    } while( ret == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE );
+
+    /* Finish the computation of Vf^-1 = R * (R Vf)^-1 */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( Vi, Vi, &R ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( Vi, Vi, &ctx->N ) );
+
+    /* Blinding value: Vi = Vf^(-e) mod N
+     * (Vi already contains Vf^-1 at this point) */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( Vi, Vi, &ctx->E, &ctx->N, RR ) );
+
+
+cleanup:
+    mbedtls_mpi_free( &R );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE) && \
+    defined(MBEDTLS_THREADING_THREADS)
+static void rsa_blinding_refill_thread( void *arg )
+{
+    mbedtls_rsa_context *ctx = (mbedtls_rsa_context *) arg;
+    int (*f_rng)(void *, unsigned char *, size_t);
+    void *p_rng;
+
+    /* Serve the requests made while refilling, so that none is lost
+     * between the last refill and the end of the thread */
+    for( ;; )
+    {
+        if( mbedtls_mutex_lock( &ctx->mutex ) != 0 )
+            return;
+
+        if( ctx->blinding_refill_pending == 0 )
+        {
+            ctx->blinding_thread_state = RSA_BLINDING_THREAD_DONE;
+            (void) mbedtls_mutex_unlock( &ctx->mutex );
+            return;
+        }
+
+        ctx->blinding_refill_pending = 0;
+        f_rng = ctx->blinding_f_rng;
+        p_rng = ctx->blinding_p_rng;
+
+        if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+            return;
+
+        /* On failure, the next request starts over */
+        (void) mbedtls_rsa_blinding_refill( ctx, f_rng, p_rng );
+    }
+}
+
+/*
+ * Request a background refill, starting a thread unless one is running.
+ * Must be called with the context mutex held.
+ */
+static int rsa_blinding_request_refill( mbedtls_rsa_context *ctx )
+{
+    int ret;
+
+    ctx->blinding_refill_pending = 1;
+
+    if( ctx->blinding_thread_state == RSA_BLINDING_THREAD_RUNNING )
+        return( 0 );
+
+    /* The previous thread is past its last use of the mutex */
+    if( ctx->blinding_thread_state == RSA_BLINDING_THREAD_DONE )
+    {
+        (void) mbedtls_thread_join( &ctx->blinding_thread );
+        ctx->blinding_thread_state = RSA_BLINDING_THREAD_NONE;
+    }
+
+    if( ( ret = mbedtls_thread_create( &ctx->blinding_thread,
+                                       rsa_blinding_refill_thread,
+                                       ctx ) ) != 0 )
+        return( ret );
+
+    ctx->blinding_thread_state = RSA_BLINDING_THREAD_RUNNING;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE && MBEDTLS_THREADING_THREADS */
+
 /*
  * Generate or update blinding values, see section 10 of:
  *  KOCHER, Paul C. Timing attacks on implementations of Diffie-Hellman, RSA,
@@ -783,10 +1263,34 @@ cleanup:
 static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
                  int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
 {
-    int ret, count = 0;
-    mbedtls_mpi R;
+    int ret;
+
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    if( ctx->blinding_count > 0 )
+    {
+        /* Take a precomputed pair and discard the current one */
+        ctx->blinding_count--;
+        mbedtls_mpi_swap( &ctx->Vi, &ctx->blinding_Vi[ctx->blinding_count] );
+        mbedtls_mpi_swap( &ctx->Vf, &ctx->blinding_Vf[ctx->blinding_count] );
+        mbedtls_mpi_free( &ctx->blinding_Vi[ctx->blinding_count] );
+        mbedtls_mpi_free( &ctx->blinding_Vf[ctx->blinding_count] );
+
+#if defined(MBEDTLS_THREADING_THREADS)
+        /* If the thread can't be started, go on with what is left */
+        if( ctx->blinding_background &&
+            ctx->blinding_count <= MBEDTLS_RSA_BLINDING_POOL_SIZE / 2 )
+            (void) rsa_blinding_request_refill( ctx );
+#endif
 
-    mbedtls_mpi_init( &R );
+        return( 0 );
+    }
+
+#if defined(MBEDTLS_THREADING_THREADS)
+    /* The refills don't keep up: draw this pair here, but ask for more */
+    if( ctx->blinding_background )
+        (void) rsa_blinding_request_refill( ctx );
+#endif
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE */
 
     if( ctx->Vf.p != NULL )
     {
@@ -799,45 +1303,133 @@ static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
         goto cleanup;
     }
 
-    /* Unblinding value: Vf = random number, invertible mod N */
-    do {
-        if( count++ > 10 )
+    ret = rsa_gen_blinding( ctx, &ctx->Vi, &ctx->Vf, &ctx->RN, f_rng, p_rng );
+
+cleanup:
+    return( ret );
+}
+
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+/*
+ * Fill the pool of precomputed blinding values. The expensive part runs
+ * without holding the context mutex, so that private key operations on the
+ * same context can go on meanwhile.
+ */
+int mbedtls_rsa_blinding_refill( mbedtls_rsa_context *ctx,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng )
+{
+    int ret = 0;
+    size_t i, needed;
+    mbedtls_mpi Vi, Vf, RR;
+
+    RSA_VALIDATE_RET( ctx != NULL );
+    RSA_VALIDATE_RET( f_rng != NULL );
+
+    if( rsa_check_context( ctx, 1 /* private key checks */,
+                                1 /* blinding */ ) != 0 )
+    {
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    needed = MBEDTLS_RSA_BLINDING_POOL_SIZE - ctx->blinding_count;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    mbedtls_mpi_init( &Vi );
+    mbedtls_mpi_init( &Vf );
+    mbedtls_mpi_init( &RR );
+
+    for( i = 0; i < needed; i++ )
+    {
+        MBEDTLS_MPI_CHK( rsa_gen_blinding( ctx, &Vi, &Vf, &RR, f_rng, p_rng ) );
+
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+
+        /* Private key operations or another refill may have changed the
+         * pool meanwhile. */
+        if( ctx->blinding_count < MBEDTLS_RSA_BLINDING_POOL_SIZE )
         {
-            ret = MBEDTLS_ERR_RSA_RNG_FAILED;
+            mbedtls_mpi_swap( &ctx->blinding_Vi[ctx->blinding_count], &Vi );
+            mbedtls_mpi_swap( &ctx->blinding_Vf[ctx->blinding_count], &Vf );
+            ctx->blinding_count++;
+        }
+
+#if defined(MBEDTLS_THREADING_C)
+        if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        {
+            ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
             goto cleanup;
         }
+#endif
+    }
+
+cleanup:
+    mbedtls_mpi_free( &Vi );
+    mbedtls_mpi_free( &Vf );
+    mbedtls_mpi_free( &RR );
+
+    if( ret != 0 && ret >= -0x007f )
+        return( MBEDTLS_ERR_RSA_PRIVATE_FAILED + ret );
+
+    return( ret );
+}
 
-        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &ctx->Vf, ctx->len - 1, f_rng, p_rng ) );
+#if defined(MBEDTLS_THREADING_THREADS)
+int mbedtls_rsa_blinding_start_refill( mbedtls_rsa_context *ctx,
+                                       int (*f_rng)(void *, unsigned char *,
+                                                    size_t),
+                                       void *p_rng )
+{
+    int ret;
+
+    RSA_VALIDATE_RET( ctx != NULL );
+    RSA_VALIDATE_RET( f_rng != NULL );
+
+    if( rsa_check_context( ctx, 1 /* private key checks */,
+                                1 /* blinding */ ) != 0 )
+    {
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+    }
 
-        /* Compute Vf^-1 as R * (R Vf)^-1 to avoid leaks from inv_mod. */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &R, ctx->len - 1, f_rng, p_rng ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ctx->Vi, &ctx->Vf, &R ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &ctx->Vi, &ctx->Vi, &ctx->N ) );
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
 
-        /* At this point, Vi is invertible mod N if and only if both Vf and R
-         * are invertible mod N. If one of them isn't, we don't need to know
-         * which one, we just loop and choose new values for both of them.
-         * (Each iteration succeeds with overwhelming probability.) */
-        ret = mbedtls_mpi_inv_mod( &ctx->Vi, &ctx->Vi, &ctx->N );
-        if( ret != 0 && ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
-            goto cleanup;
+    ctx->blinding_f_rng = f_rng;
+    ctx->blinding_p_rng = p_rng;
+    ctx->blinding_background = 1;
 
-    } while( ret == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE );
+    if( ( ret = rsa_blinding_request_refill( ctx ) ) != 0 )
+        ctx->blinding_background = 0;
 
-    /* Finish the computation of Vf^-1 = R * (R Vf)^-1 */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ctx->Vi, &ctx->Vi, &R ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &ctx->Vi, &ctx->Vi, &ctx->N ) );
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
 
-    /* Blinding value: Vi = Vf^(-e) mod N
-     * (Vi already contains Vf^-1 at this point) */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->Vi, &ctx->Vi, &ctx->E, &ctx->N, &ctx->RN ) );
+    return( ret );
+}
 
+void mbedtls_rsa_blinding_stop_refill( mbedtls_rsa_context *ctx )
+{
+    RSA_VALIDATE( ctx != NULL );
 
-cleanup:
-    mbedtls_mpi_free( &R );
+    rsa_blinding_join( ctx, 1 );
 
-    return( ret );
+    ctx->blinding_f_rng = NULL;
+    ctx->blinding_p_rng = NULL;
 }
+#endif /* MBEDTLS_THREADING_THREADS */
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE */
 
 /*
  * Exponent blinding supposed to prevent side-channel attacks using multiple
@@ -860,6 +1452,29 @@ cleanup:
  */
 #define RSA_EXPONENT_BLINDING 28
 
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS)
+/*
+ * One of the two exponentiations of a CRT private key operation
+ */
+typedef struct
+{
+    mbedtls_mpi *X;
+    const mbedtls_mpi *A;
+    const mbedtls_mpi *E;
+    const mbedtls_mpi *N;
+    mbedtls_mpi *RR;
+    int ret;
+}
+rsa_exp_mod_job;
+
+static void rsa_exp_mod_worker( void *arg )
+{
+    rsa_exp_mod_job *job = (rsa_exp_mod_job *) arg;
+
+    job->ret = mbedtls_mpi_exp_mod( job->X, job->A, job->E, job->N, job->RR );
+}
+#endif /* MBEDTLS_RSA_PRIVATE_THREADS */
+
 /*
  * Do an RSA private key operation
  */
@@ -891,6 +1506,13 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
      * or the blinded ones, depending on the presence of a PRNG. */
     mbedtls_mpi *DP = &ctx->DP;
     mbedtls_mpi *DQ = &ctx->DQ;
+
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS)
+    /* The mod q exponentiation and the thread computing it. */
+    rsa_exp_mod_job job_q;
+    mbedtls_threading_thread_t thread_q;
+    int join_ret;
+#endif
 #else
     /* Temporary holding the blinded exponent (if used). */
     mbedtls_mpi D_blind;
@@ -1016,8 +1638,42 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
      * TQ = input ^ dQ mod Q
      */
 
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS)
+    /*
+     * Compute TQ on a second thread while this one computes TP. The two
+     * only share T, DP and DQ, which they read, and each caches its own
+     * RP or RQ in the context.
+     */
+    job_q.X = &TQ;
+    job_q.A = &T;
+    job_q.E = DQ;
+    job_q.N = &ctx->Q;
+    job_q.RR = &ctx->RQ;
+    job_q.ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( mbedtls_thread_create( &thread_q, rsa_exp_mod_worker, &job_q ) == 0 )
+    {
+        ret = mbedtls_mpi_exp_mod( &TP, &T, DP, &ctx->P, &ctx->RP );
+
+        join_ret = mbedtls_thread_join( &thread_q );
+        if( ret == 0 )
+            ret = join_ret;
+    }
+    else
+    {
+        ret = mbedtls_mpi_exp_mod( &TP, &T, DP, &ctx->P, &ctx->RP );
+        if( ret == 0 )
+            rsa_exp_mod_worker( &job_q );
+    }
+
+    if( ret == 0 )
+        ret = job_q.ret;
+    if( ret != 0 )
+        goto cleanup;
+#else
     MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &TP, &T, DP, &ctx->P, &ctx->RP ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &TQ, &T, DQ, &ctx->Q, &ctx->RQ ) );
+#endif /* MBEDTLS_RSA_PRIVATE_THREADS */
 
     /*
      * T = (TP - TQ) * (Q^-1 mod P) mod P
@@ -2175,22 +2831,21 @@ int mbedtls_rsa_pkcs1_sign( mbedtls_rsa_context *ctx,
 
 #if defined(MBEDTLS_PKCS1_V21)
 /*
- * Implementation of the PKCS#1 v2.1 RSASSA-PSS-VERIFY function
+ * Check the encoded message of a PKCS#1 v2.1 RSASSA-PSS signature, that is
+ * EMSA-PSS-VERIFY applied to the result of the RSA operation, which is in
+ * buf (ctx->len bytes, modified in place)
  */
-int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
-                               int (*f_rng)(void *, unsigned char *, size_t),
-                               void *p_rng,
-                               int mode,
-                               mbedtls_md_type_t md_alg,
-                               unsigned int hashlen,
-                               const unsigned char *hash,
-                               mbedtls_md_type_t mgf1_hash_id,
-                               int expected_salt_len,
-                               const unsigned char *sig )
+static int rsa_rsassa_pss_verify_em( const mbedtls_rsa_context *ctx,
+                                     mbedtls_md_type_t md_alg,
+                                     unsigned int hashlen,
+                                     const unsigned char *hash,
+                                     mbedtls_md_type_t mgf1_hash_id,
+                                     int expected_salt_len,
+                                     unsigned char *buf )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t siglen;
-    unsigned char *p;
+    size_t siglen = ctx->len;
+    unsigned char *p = buf;
     unsigned char *hash_start;
     unsigned char result[MBEDTLS_MD_MAX_SIZE];
     unsigned char zeros[8];
@@ -2198,32 +2853,6 @@ int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
     size_t observed_salt_len, msb;
     const mbedtls_md_info_t *md_info;
     mbedtls_md_context_t md_ctx;
-    unsigned char buf[MBEDTLS_MPI_MAX_SIZE];
-
-    RSA_VALIDATE_RET( ctx != NULL );
-    RSA_VALIDATE_RET( mode == MBEDTLS_RSA_PRIVATE ||
-                      mode == MBEDTLS_RSA_PUBLIC );
-    RSA_VALIDATE_RET( sig != NULL );
-    RSA_VALIDATE_RET( ( md_alg  == MBEDTLS_MD_NONE &&
-                        hashlen == 0 ) ||
-                      hash != NULL );
-
-    if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V21 )
-        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
-
-    siglen = ctx->len;
-
-    if( siglen < 16 || siglen > sizeof( buf ) )
-        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
-
-    ret = ( mode == MBEDTLS_RSA_PUBLIC )
-          ? mbedtls_rsa_public(  ctx, sig, buf )
-          : mbedtls_rsa_private( ctx, f_rng, p_rng, sig, buf );
-
-    if( ret != 0 )
-        return( ret );
-
-    p = buf;
 
     if( buf[siglen - 1] != 0xBC )
         return( MBEDTLS_ERR_RSA_INVALID_PADDING );
@@ -2324,6 +2953,51 @@ exit:
     return( ret );
 }
 
+/*
+ * Implementation of the PKCS#1 v2.1 RSASSA-PSS-VERIFY function
+ */
+int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
+                               int (*f_rng)(void *, unsigned char *, size_t),
+                               void *p_rng,
+                               int mode,
+                               mbedtls_md_type_t md_alg,
+                               unsigned int hashlen,
+                               const unsigned char *hash,
+                               mbedtls_md_type_t mgf1_hash_id,
+                               int expected_salt_len,
+                               const unsigned char *sig )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t siglen;
+    unsigned char buf[MBEDTLS_MPI_MAX_SIZE];
+
+    RSA_VALIDATE_RET( ctx != NULL );
+    RSA_VALIDATE_RET( mode == MBEDTLS_RSA_PRIVATE ||
+                      mode == MBEDTLS_RSA_PUBLIC );
+    RSA_VALIDATE_RET( sig != NULL );
+    RSA_VALIDATE_RET( ( md_alg  == MBEDTLS_MD_NONE &&
+                        hashlen == 0 ) ||
+                      hash != NULL );
+
+    if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V21 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    siglen = ctx->len;
+
+    if( siglen < 16 || siglen > sizeof( buf ) )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    ret = ( mode == MBEDTLS_RSA_PUBLIC )
+          ? mbedtls_rsa_public(  ctx, sig, buf )
+          : mbedtls_rsa_private( ctx, f_rng, p_rng, sig, buf );
+
+    if( ret != 0 )
+        return( ret );
+
+    return( rsa_rsassa_pss_verify_em( ctx, md_alg, hashlen, hash,
+                                      mgf1_hash_id, expected_salt_len, buf ) );
+}
+
 /*
  * Simplified PKCS#1 v2.1 RSASSA-PSS-VERIFY function
  */
@@ -2480,6 +3154,231 @@ int mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context *ctx,
     }
 }
 
+/*
+ * Maximum number of signatures that mbedtls_rsa_pkcs1_verify_batch()
+ * exponentiates together
+ */
+#define RSA_VERIFY_BATCH_SIZE   8
+
+/*
+ * The checks that mbedtls_rsa_pkcs1_verify() does before the RSA operation.
+ * buf is a scratch buffer of MBEDTLS_MPI_MAX_SIZE bytes.
+ */
+static int rsa_verify_batch_precheck( const mbedtls_rsa_batch_entry *entry,
+                                      unsigned char *buf )
+{
+    const mbedtls_rsa_context *ctx = entry->ctx;
+
+#if !defined(MBEDTLS_PKCS1_V15)
+    ((void) buf);
+#endif
+
+    switch( ctx->padding )
+    {
+#if defined(MBEDTLS_PKCS1_V15)
+        case MBEDTLS_RSA_PKCS_V15:
+            if( ctx->len > MBEDTLS_MPI_MAX_SIZE )
+                return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+            return( rsa_rsassa_pkcs1_v15_encode( entry->md_alg,
+                                                 entry->hashlen, entry->hash,
+                                                 ctx->len, buf ) );
+#endif
+
+#if defined(MBEDTLS_PKCS1_V21)
+        case MBEDTLS_RSA_PKCS_V21:
+            if( ctx->len < 16 || ctx->len > MBEDTLS_MPI_MAX_SIZE )
+                return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+            return( 0 );
+#endif
+
+        default:
+            return( MBEDTLS_ERR_RSA_INVALID_PADDING );
+    }
+}
+
+/*
+ * The checks that mbedtls_rsa_pkcs1_verify() does on the result of the RSA
+ * operation, which is in buf (modified in place).
+ */
+static int rsa_verify_batch_check( const mbedtls_rsa_batch_entry *entry,
+                                   unsigned char *buf )
+{
+    const mbedtls_rsa_context *ctx = entry->ctx;
+#if defined(MBEDTLS_PKCS1_V15)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *encoded_expected;
+#endif
+#if defined(MBEDTLS_PKCS1_V21)
+    mbedtls_md_type_t mgf1_hash_id;
+#endif
+
+    switch( ctx->padding )
+    {
+#if defined(MBEDTLS_PKCS1_V15)
+        case MBEDTLS_RSA_PKCS_V15:
+            if( ( encoded_expected = mbedtls_calloc( 1, ctx->len ) ) == NULL )
+                return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
+
+            ret = rsa_rsassa_pkcs1_v15_encode( entry->md_alg, entry->hashlen,
+                                               entry->hash, ctx->len,
+                                               encoded_expected );
+            if( ret == 0 &&
+                mbedtls_safer_memcmp( buf, encoded_expected, ctx->len ) != 0 )
+                ret = MBEDTLS_ERR_RSA_VERIFY_FAILED;
+
+            mbedtls_platform_zeroize( encoded_expected, ctx->len );
+            mbedtls_free( encoded_expected );
+
+            return( ret );
+#endif
+
+#if defined(MBEDTLS_PKCS1_V21)
+        case MBEDTLS_RSA_PKCS_V21:
+            mgf1_hash_id = ( ctx->hash_id != MBEDTLS_MD_NONE )
+                           ? (mbedtls_md_type_t) ctx->hash_id
+                           : entry->md_alg;
+
+            return( rsa_rsassa_pss_verify_em( ctx, entry->md_alg,
+                                              entry->hashlen, entry->hash,
+                                              mgf1_hash_id,
+                                              MBEDTLS_RSA_SALT_LEN_ANY,
+                                              buf ) );
+#endif
+
+        default:
+            return( MBEDTLS_ERR_RSA_INVALID_PADDING );
+    }
+}
+
+/*
+ * Verify n signatures that all use ctx and passed the prechecks. T is an
+ * array of n initialized MPIs and buf a scratch buffer of
+ * MBEDTLS_MPI_MAX_SIZE bytes.
+ */
+static void rsa_verify_batch_group( mbedtls_rsa_context *ctx,
+                                    mbedtls_rsa_batch_entry *group[],
+                                    size_t n, mbedtls_mpi T[],
+                                    unsigned char *buf )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t k, m;
+
+    if( rsa_check_context( ctx, 0 /* public */, 0 /* no blinding */ ) )
+    {
+        ret = MBEDTLS_ERR_RSA_BAD_INPUT_DATA;
+        goto exit;
+    }
+
+    /* Signatures that are not less than N fail as in mbedtls_rsa_public() */
+    for( k = 0, m = 0; k < n; k++ )
+    {
+        ret = mbedtls_mpi_read_binary( &T[m], group[k]->sig, ctx->len );
+        if( ret == 0 && mbedtls_mpi_cmp_mpi( &T[m], &ctx->N ) >= 0 )
+            ret = MBEDTLS_ERR_MPI_BAD_INPUT_DATA;
+
+        if( ret != 0 )
+            group[k]->ret = MBEDTLS_ERR_RSA_PUBLIC_FAILED + ret;
+        else
+            group[m++] = group[k];
+    }
+
+    n = m;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        goto exit;
+#endif
+
+    ret = mbedtls_mpi_exp_mod_batch( T, n, &ctx->E, &ctx->N, &ctx->RN );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+    {
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+        goto exit;
+    }
+#endif
+
+    if( ret != 0 )
+    {
+        ret = MBEDTLS_ERR_RSA_PUBLIC_FAILED + ret;
+        goto exit;
+    }
+
+    for( k = 0; k < n; k++ )
+    {
+        ret = mbedtls_mpi_write_binary( &T[k], buf, ctx->len );
+        group[k]->ret = ( ret != 0 ) ? MBEDTLS_ERR_RSA_PUBLIC_FAILED + ret
+                                     : rsa_verify_batch_check( group[k], buf );
+    }
+
+    return;
+
+exit:
+    for( k = 0; k < n; k++ )
+        group[k]->ret = ret;
+}
+
+/*
+ * Verify several signatures, sharing the RSA operations between consecutive
+ * entries that use the same context
+ */
+int mbedtls_rsa_pkcs1_verify_batch( mbedtls_rsa_batch_entry *entries,
+                                    size_t count )
+{
+    size_t i, j, k, n;
+    mbedtls_rsa_context *ctx;
+    mbedtls_rsa_batch_entry *group[RSA_VERIFY_BATCH_SIZE];
+    mbedtls_mpi T[RSA_VERIFY_BATCH_SIZE];
+    unsigned char buf[MBEDTLS_MPI_MAX_SIZE];
+
+    RSA_VALIDATE_RET( entries != NULL || count == 0 );
+
+    for( i = 0; i < count; i++ )
+    {
+        RSA_VALIDATE_RET( entries[i].ctx != NULL );
+        RSA_VALIDATE_RET( entries[i].sig != NULL );
+        RSA_VALIDATE_RET( ( entries[i].md_alg  == MBEDTLS_MD_NONE &&
+                            entries[i].hashlen == 0 ) ||
+                          entries[i].hash != NULL );
+    }
+
+    for( k = 0; k < RSA_VERIFY_BATCH_SIZE; k++ )
+        mbedtls_mpi_init( &T[k] );
+
+    for( i = 0; i < count; i = j )
+    {
+        ctx = entries[i].ctx;
+
+        for( j = i, n = 0;
+             j < count && n < RSA_VERIFY_BATCH_SIZE && entries[j].ctx == ctx;
+             j++ )
+        {
+            entries[j].ret = rsa_verify_batch_precheck( &entries[j], buf );
+            if( entries[j].ret == 0 )
+                group[n++] = &entries[j];
+        }
+
+        if( n > 0 )
+            rsa_verify_batch_group( ctx, group, n, T, buf );
+    }
+
+    for( k = 0; k < RSA_VERIFY_BATCH_SIZE; k++ )
+        mbedtls_mpi_free( &T[k] );
+
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    for( i = 0; i < count; i++ )
+    {
+        if( entries[i].ret != 0 )
+            return( entries[i].ret );
+    }
+
+    return( 0 );
+}
+
 /*
  * Copy the components of an RSA key
  */
@@ -2511,6 +3410,11 @@ int mbedtls_rsa_copy( mbedtls_rsa_context *dst, const mbedtls_rsa_context *src )
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &dst->Vi, &src->Vi ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &dst->Vf, &src->Vf ) );
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    /* Precomputed blinding values are not shared between contexts */
+    rsa_blinding_pool_free( dst );
+#endif
+
     dst->padding = src->padding;
     dst->hash_id = src->hash_id;
 
@@ -2529,6 +3433,12 @@ void mbedtls_rsa_free( mbedtls_rsa_context *ctx )
     if( ctx == NULL )
         return;
 
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+#if defined(MBEDTLS_THREADING_THREADS)
+    mbedtls_rsa_blinding_stop_refill( ctx );
+#endif
+    rsa_blinding_pool_free( ctx );
+#endif
     mbedtls_mpi_free( &ctx->Vi );
     mbedtls_mpi_free( &ctx->Vf );
     mbedtls_mpi_free( &ctx->RN );
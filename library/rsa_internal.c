@@ -226,8 +226,23 @@ int mbedtls_rsa_deduce_private_exponent( mbedtls_mpi const *P,
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &K, &K, &L ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_div_mpi( &K, NULL, &K, D ) );
 
-    /* Compute modular inverse of E in LCM(P-1, Q-1) */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( D, E, &K ) );
+    /* Compute modular inverse of E in LCM(P-1, Q-1).
+     *
+     * K is even, so use the constant-time inversion modulo the odd public
+     * exponent instead, with E^-1 mod K = ( 1 + K * ( E - K^-1 mod E ) ) / E.
+     * This keeps the secret K out of the binary extended Euclidean
+     * algorithm; the remaining reductions and divisions are by E. */
+    if( E->s > 0 && mbedtls_mpi_get_bit( E, 0 ) == 1 &&
+        mbedtls_mpi_cmp_int( E, 1 ) > 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &L, &K, E ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &L, E, &L ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( D, &K, &L ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( D, D, 1 ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_div_mpi( D, NULL, D, E ) );
+    }
+    else
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( D, E, &K ) );
 
 cleanup:
 
@@ -474,7 +489,10 @@ int mbedtls_rsa_deduce_crt( const mbedtls_mpi *P, const mbedtls_mpi *Q,
     /* QP = Q^{-1} mod P */
     if( QP != NULL )
     {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( QP, Q, P ) );
+        if( mbedtls_mpi_get_bit( P, 0 ) == 1 )
+            MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( QP, Q, P ) );
+        else
+            MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( QP, Q, P ) );
     }
 
 cleanup:
@@ -17,8 +17,8 @@
  *  limitations under the License.
  */
 /*
- * These session callbacks use a simple chained list
- * to store and retrieve the session information.
+ * These session callbacks use a hash table indexed by session ID, split into
+ * shards that each have their own lock and least recently used list.
  */
 
 #include "common.h"
@@ -35,18 +35,222 @@
 
 #include "mbedtls/ssl_cache.h"
 #include "mbedtls/ssl_internal.h"
+#include "mbedtls/platform_util.h"
 
 #include <string.h>
 
+/* Only use more shards if each of them can hold at least that many entries */
+#define SSL_CACHE_MIN_SHARD_ENTRIES     16
+
+static int ssl_cache_shard_count( int max_entries )
+{
+    int count = max_entries / SSL_CACHE_MIN_SHARD_ENTRIES;
+
+    if( count > MBEDTLS_SSL_CACHE_SHARDS )
+        count = MBEDTLS_SSL_CACHE_SHARDS;
+    if( count < 1 )
+        count = 1;
+
+    return( count );
+}
+
+/*
+ * Spread max_entries over the shards so that the total is exact
+ */
+static int ssl_cache_shard_capacity( const mbedtls_ssl_cache_context *cache,
+                                     const mbedtls_ssl_cache_shard *shard )
+{
+    int idx = (int)( shard - cache->shards );
+    int capacity = cache->max_entries / cache->shard_count;
+
+    if( idx < cache->max_entries % cache->shard_count )
+        capacity++;
+
+    return( capacity );
+}
+
+static mbedtls_ssl_cache_shard *ssl_cache_shard( mbedtls_ssl_cache_context *cache,
+                                                 uint32_t hash )
+{
+    return( &cache->shards[hash % (uint32_t) cache->shard_count] );
+}
+
+static size_t ssl_cache_bucket( const mbedtls_ssl_cache_context *cache,
+                                const mbedtls_ssl_cache_shard *shard,
+                                uint32_t hash )
+{
+    return( ( hash / (uint32_t) cache->shard_count ) &
+            ( shard->bucket_count - 1 ) );
+}
+
+static size_t ssl_cache_entry_bucket( const mbedtls_ssl_cache_context *cache,
+                                      const mbedtls_ssl_cache_shard *shard,
+                                      const mbedtls_ssl_cache_entry *entry )
+{
+    return( ssl_cache_bucket( cache, shard,
+                mbedtls_ssl_session_id_hash( entry->session_id,
+                                             entry->session_id_len ) ) );
+}
+
+/*
+ * Lock the shard a session ID hashes to. The shard count is read under the
+ * cache lock, but may change before the shard lock is taken, so check that
+ * the shard is still the right one. Once a shard lock is held, the geometry
+ * can no longer change, as mbedtls_ssl_cache_set_max_entries() takes them all.
+ */
+static int ssl_cache_lock_shard( mbedtls_ssl_cache_context *cache,
+                                 uint32_t hash,
+                                 mbedtls_ssl_cache_shard **shard )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int ret;
+
+    for( ;; )
+    {
+        if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+            return( ret );
+
+        *shard = ssl_cache_shard( cache, hash );
+
+        if( ( ret = mbedtls_mutex_unlock( &cache->mutex ) ) != 0 )
+            return( ret );
+
+        if( ( ret = mbedtls_mutex_lock( &(*shard)->mutex ) ) != 0 )
+            return( ret );
+
+        if( *shard == ssl_cache_shard( cache, hash ) )
+            return( 0 );
+
+        if( ( ret = mbedtls_mutex_unlock( &(*shard)->mutex ) ) != 0 )
+            return( ret );
+    }
+#else
+    *shard = ssl_cache_shard( cache, hash );
+    return( 0 );
+#endif
+}
+
+/*
+ * Size the hash table of a shard for the entries it may hold
+ */
+static int ssl_cache_alloc_buckets( mbedtls_ssl_cache_shard *shard,
+                                    int capacity )
+{
+    if( capacity == 0 )
+        return( 1 );
+
+    shard->bucket_count = 1;
+    while( shard->bucket_count < (size_t) capacity )
+        shard->bucket_count <<= 1;
+
+    shard->buckets = mbedtls_calloc( shard->bucket_count,
+                                     sizeof(mbedtls_ssl_cache_entry *) );
+    if( shard->buckets == NULL )
+    {
+        shard->bucket_count = 0;
+        return( 1 );
+    }
+
+    return( 0 );
+}
+
+static mbedtls_ssl_cache_entry *ssl_cache_find( const mbedtls_ssl_cache_shard *shard,
+                                                size_t bucket,
+                                                const unsigned char *id,
+                                                size_t id_len )
+{
+    mbedtls_ssl_cache_entry *cur;
+
+    if( shard->buckets == NULL )
+        return( NULL );
+
+    for( cur = shard->buckets[bucket]; cur != NULL; cur = cur->next )
+    {
+        if( cur->session_id_len == id_len &&
+            memcmp( cur->session_id, id, id_len ) == 0 )
+            return( cur );
+    }
+
+    return( NULL );
+}
+
+static void ssl_cache_lru_unlink( mbedtls_ssl_cache_shard *shard,
+                                  mbedtls_ssl_cache_entry *entry )
+{
+    if( entry->lru_prev != NULL )
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        shard->lru_head = entry->lru_next;
+
+    if( entry->lru_next != NULL )
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        shard->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void ssl_cache_lru_push( mbedtls_ssl_cache_shard *shard,
+                                mbedtls_ssl_cache_entry *entry )
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = shard->lru_head;
+
+    if( shard->lru_head != NULL )
+        shard->lru_head->lru_prev = entry;
+    else
+        shard->lru_tail = entry;
+
+    shard->lru_head = entry;
+}
+
+/*
+ * Take an entry out of its bucket and of the LRU list, without freeing it
+ */
+static void ssl_cache_unlink( mbedtls_ssl_cache_shard *shard,
+                              size_t bucket,
+                              mbedtls_ssl_cache_entry *entry )
+{
+    mbedtls_ssl_cache_entry **cur = &shard->buckets[bucket];
+
+    while( *cur != entry )
+        cur = &(*cur)->next;
+    *cur = entry->next;
+    entry->next = NULL;
+
+    ssl_cache_lru_unlink( shard, entry );
+    shard->entries--;
+}
+
+static void ssl_cache_entry_clear( mbedtls_ssl_cache_entry *entry )
+{
+    if( entry->session != NULL )
+    {
+        mbedtls_platform_zeroize( entry->session, entry->session_len );
+        mbedtls_free( entry->session );
+    }
+
+    entry->session = NULL;
+    entry->session_len = 0;
+}
+
 void mbedtls_ssl_cache_init( mbedtls_ssl_cache_context *cache )
 {
+#if defined(MBEDTLS_THREADING_C)
+    int i;
+#endif
+
     memset( cache, 0, sizeof( mbedtls_ssl_cache_context ) );
 
     cache->timeout = MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT;
     cache->max_entries = MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES;
+    cache->shard_count = ssl_cache_shard_count( cache->max_entries );
 
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_init( &cache->mutex );
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
+        mbedtls_mutex_init( &cache->shards[i].mutex );
 #endif
 }
 
@@ -57,82 +261,83 @@ int mbedtls_ssl_cache_get( void *data, mbedtls_ssl_session *session )
     mbedtls_time_t t = mbedtls_time( NULL );
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *entry;
+    mbedtls_ssl_cache_shard *shard;
+    mbedtls_ssl_cache_entry *entry;
+    mbedtls_ssl_session restored;
+    unsigned char *buf = NULL;
+    size_t buf_len = 0;
+    uint32_t hash;
+    size_t bucket;
 
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+    hash = mbedtls_ssl_session_id_hash( session->id, session->id_len );
+
+    if( ssl_cache_lock_shard( cache, hash, &shard ) != 0 )
         return( 1 );
-#endif
 
-    cur = cache->chain;
-    entry = NULL;
+    if( shard->buckets == NULL )
+        goto unlock;
 
-    while( cur != NULL )
-    {
-        entry = cur;
-        cur = cur->next;
+    bucket = ssl_cache_bucket( cache, shard, hash );
+    entry = ssl_cache_find( shard, bucket, session->id, session->id_len );
+    if( entry == NULL )
+        goto unlock;
 
 #if defined(MBEDTLS_HAVE_TIME)
-        if( cache->timeout != 0 &&
-            (int) ( t - entry->timestamp ) > cache->timeout )
-            continue;
+    if( cache->timeout != 0 &&
+        (int) ( t - entry->timestamp ) > cache->timeout )
+    {
+        /* expired, make room for new entries right away */
+        ssl_cache_unlink( shard, bucket, entry );
+        ssl_cache_entry_clear( entry );
+        mbedtls_free( entry );
+        goto unlock;
+    }
 #endif
 
-        if( session->ciphersuite != entry->session.ciphersuite ||
-            session->compression != entry->session.compression ||
-            session->id_len != entry->session.id_len )
-            continue;
+    /* Take a copy so that the session is restored without holding the
+     * lock: this may involve parsing the peer certificate */
+    buf = mbedtls_calloc( 1, entry->session_len );
+    if( buf == NULL )
+        goto unlock;
 
-        if( memcmp( session->id, entry->session.id,
-                    entry->session.id_len ) != 0 )
-            continue;
+    memcpy( buf, entry->session, entry->session_len );
+    buf_len = entry->session_len;
 
-        ret = mbedtls_ssl_session_copy( session, &entry->session );
-        if( ret != 0 )
-        {
-            ret = 1;
-            goto exit;
-        }
+    /* Resumed sessions are the last ones to be replaced */
+    ssl_cache_lru_unlink( shard, entry );
+    ssl_cache_lru_push( shard, entry );
 
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-        /*
-         * Restore peer certificate (without rest of the original chain)
-         */
-        if( entry->peer_cert.p != NULL )
-        {
-            /* `session->peer_cert` is NULL after the call to
-             * mbedtls_ssl_session_copy(), because cache entries
-             * have the `peer_cert` field set to NULL. */
+unlock:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &shard->mutex ) != 0 )
+        goto exit;
+#endif
 
-            if( ( session->peer_cert = mbedtls_calloc( 1,
-                                 sizeof(mbedtls_x509_crt) ) ) == NULL )
-            {
-                ret = 1;
-                goto exit;
-            }
+    if( buf == NULL )
+        goto exit;
 
-            mbedtls_x509_crt_init( session->peer_cert );
-            if( mbedtls_x509_crt_parse( session->peer_cert, entry->peer_cert.p,
-                                entry->peer_cert.len ) != 0 )
-            {
-                mbedtls_free( session->peer_cert );
-                session->peer_cert = NULL;
-                ret = 1;
-                goto exit;
-            }
-        }
-#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+    mbedtls_ssl_session_init( &restored );
+    if( mbedtls_ssl_session_load( &restored, buf, buf_len ) != 0 )
+        goto exit;
 
-        ret = 0;
+    if( session->ciphersuite != restored.ciphersuite ||
+        session->compression != restored.compression )
+    {
+        mbedtls_ssl_session_free( &restored );
         goto exit;
     }
 
+    mbedtls_ssl_session_free( session );
+    *session = restored;
+
+    ret = 0;
+
 exit:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
-        ret = 1;
-#endif
+    if( buf != NULL )
+    {
+        mbedtls_platform_zeroize( buf, buf_len );
+        mbedtls_free( buf );
+    }
 
     return( ret );
 }
@@ -141,84 +346,74 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
 {
     int ret = 1;
 #if defined(MBEDTLS_HAVE_TIME)
-    mbedtls_time_t t = mbedtls_time( NULL ), oldest = 0;
-    mbedtls_ssl_cache_entry *old = NULL;
+    mbedtls_time_t t = mbedtls_time( NULL );
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *prv;
-    int count = 0;
+    mbedtls_ssl_cache_shard *shard;
+    mbedtls_ssl_cache_entry *cur = NULL;
+    unsigned char *buf = NULL;
+    size_t buf_len = 0;
+    uint32_t hash;
+    size_t bucket;
+    int capacity;
+
+    if( session->id_len > sizeof( cur->session_id ) )
+        return( 1 );
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
-        return( ret );
-#endif
+    /*
+     * Serialize the session before taking the lock
+     */
+    if( mbedtls_ssl_session_save( session, NULL, 0, &buf_len ) !=
+        MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL )
+        return( 1 );
 
-    cur = cache->chain;
-    prv = NULL;
+    buf = mbedtls_calloc( 1, buf_len );
+    if( buf == NULL )
+        return( 1 );
 
-    while( cur != NULL )
-    {
-        count++;
+    if( mbedtls_ssl_session_save( session, buf, buf_len, &buf_len ) != 0 )
+        goto free_buf;
 
-#if defined(MBEDTLS_HAVE_TIME)
-        if( cache->timeout != 0 &&
-            (int) ( t - cur->timestamp ) > cache->timeout )
-        {
-            cur->timestamp = t;
-            break; /* expired, reuse this slot, update timestamp */
-        }
-#endif
+    hash = mbedtls_ssl_session_id_hash( session->id, session->id_len );
 
-        if( memcmp( session->id, cur->session.id, cur->session.id_len ) == 0 )
-            break; /* client reconnected, keep timestamp for session id */
+    if( ssl_cache_lock_shard( cache, hash, &shard ) != 0 )
+        goto free_buf;
 
-#if defined(MBEDTLS_HAVE_TIME)
-        if( oldest == 0 || cur->timestamp < oldest )
-        {
-            oldest = cur->timestamp;
-            old = cur;
-        }
-#endif
+    capacity = ssl_cache_shard_capacity( cache, shard );
 
-        prv = cur;
-        cur = cur->next;
+    if( shard->buckets == NULL &&
+        ssl_cache_alloc_buckets( shard, capacity ) != 0 )
+    {
+        ret = 1;
+        goto exit;
     }
 
-    if( cur == NULL )
-    {
-#if defined(MBEDTLS_HAVE_TIME)
-        /*
-         * Reuse oldest entry if max_entries reached
-         */
-        if( count >= cache->max_entries )
-        {
-            if( old == NULL )
-            {
-                ret = 1;
-                goto exit;
-            }
+    bucket = ssl_cache_bucket( cache, shard, hash );
+    cur = ssl_cache_find( shard, bucket, session->id, session->id_len );
 
-            cur = old;
-        }
-#else /* MBEDTLS_HAVE_TIME */
-        /*
-         * Reuse first entry in chain if max_entries reached,
-         * but move to last place
-         */
-        if( count >= cache->max_entries )
+    if( cur != NULL )
+    {
+        /* client reconnected, keep timestamp for session id */
+        ssl_cache_unlink( shard, bucket, cur );
+    }
+    else
+    {
+        if( shard->entries >= capacity )
         {
-            if( cache->chain == NULL )
+            /*
+             * Reuse least recently used entry if max_entries reached
+             */
+            if( shard->lru_tail == NULL )
             {
                 ret = 1;
                 goto exit;
             }
 
-            cur = cache->chain;
-            cache->chain = cur->next;
-            cur->next = NULL;
-            prv->next = cur;
+            cur = shard->lru_tail;
+            ssl_cache_unlink( shard,
+                              ssl_cache_entry_bucket( cache, shard, cur ),
+                              cur );
         }
-#endif /* MBEDTLS_HAVE_TIME */
         else
         {
             /*
@@ -230,11 +425,6 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
                 ret = 1;
                 goto exit;
             }
-
-            if( prv == NULL )
-                cache->chain = cur;
-            else
-                prv->next = cur;
         }
 
 #if defined(MBEDTLS_HAVE_TIME)
@@ -242,62 +432,37 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
 #endif
     }
 
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
     /*
-     * If we're reusing an entry, free its certificate first
+     * If we're reusing an entry, free its contents first
      */
-    if( cur->peer_cert.p != NULL )
-    {
-        mbedtls_free( cur->peer_cert.p );
-        memset( &cur->peer_cert, 0, sizeof(mbedtls_x509_buf) );
-    }
-#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
-
-    /* Copy the entire session; this temporarily makes a copy of the
-     * X.509 CRT structure even though we only want to store the raw CRT.
-     * This inefficiency will go away as soon as we implement on-demand
-     * parsing of CRTs, in which case there's no need for the `peer_cert`
-     * field anymore in the first place, and we're done after this call. */
-    ret = mbedtls_ssl_session_copy( &cur->session, session );
-    if( ret != 0 )
-    {
-        ret = 1;
-        goto exit;
-    }
-
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-    /* If present, free the X.509 structure and only store the raw CRT data. */
-    if( cur->session.peer_cert != NULL )
-    {
-        cur->peer_cert.p =
-            mbedtls_calloc( 1, cur->session.peer_cert->raw.len );
-        if( cur->peer_cert.p == NULL )
-        {
-            ret = 1;
-            goto exit;
-        }
+    ssl_cache_entry_clear( cur );
 
-        memcpy( cur->peer_cert.p,
-                cur->session.peer_cert->raw.p,
-                cur->session.peer_cert->raw.len );
-        cur->peer_cert.len = session->peer_cert->raw.len;
+    memcpy( cur->session_id, session->id, session->id_len );
+    cur->session_id_len = session->id_len;
+    cur->session = buf;
+    cur->session_len = buf_len;
+    buf = NULL;
 
-        mbedtls_x509_crt_free( cur->session.peer_cert );
-        mbedtls_free( cur->session.peer_cert );
-        cur->session.peer_cert = NULL;
-    }
-#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+    cur->next = shard->buckets[bucket];
+    shard->buckets[bucket] = cur;
+    ssl_cache_lru_push( shard, cur );
+    shard->entries++;
 
     ret = 0;
 
 exit:
 #if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
+    if( mbedtls_mutex_unlock( &shard->mutex ) != 0 )
         ret = 1;
 #endif
 
+free_buf:
+    if( buf != NULL )
+    {
+        mbedtls_platform_zeroize( buf, buf_len );
+        mbedtls_free( buf );
+    }
+
     return( ret );
 }
 
@@ -310,38 +475,169 @@ void mbedtls_ssl_cache_set_timeout( mbedtls_ssl_cache_context *cache, int timeou
 }
 #endif /* MBEDTLS_HAVE_TIME */
 
+/*
+ * Insert an entry into the shard it hashes to, replacing the least recently
+ * used entry of the shard if it is full. Used when redistributing entries.
+ */
+static void ssl_cache_reinsert( mbedtls_ssl_cache_context *cache,
+                                mbedtls_ssl_cache_entry *entry )
+{
+    uint32_t hash = mbedtls_ssl_session_id_hash( entry->session_id,
+                                                 entry->session_id_len );
+    mbedtls_ssl_cache_shard *shard = ssl_cache_shard( cache, hash );
+    mbedtls_ssl_cache_entry *old;
+    int capacity = ssl_cache_shard_capacity( cache, shard );
+    size_t bucket;
+
+    if( shard->buckets == NULL &&
+        ssl_cache_alloc_buckets( shard, capacity ) != 0 )
+    {
+        ssl_cache_entry_clear( entry );
+        mbedtls_free( entry );
+        return;
+    }
+
+    if( shard->entries >= capacity )
+    {
+        old = shard->lru_tail;
+        ssl_cache_unlink( shard,
+                          ssl_cache_entry_bucket( cache, shard, old ),
+                          old );
+        ssl_cache_entry_clear( old );
+        mbedtls_free( old );
+    }
+
+    bucket = ssl_cache_bucket( cache, shard, hash );
+    entry->next = shard->buckets[bucket];
+    shard->buckets[bucket] = entry;
+    ssl_cache_lru_push( shard, entry );
+    shard->entries++;
+}
+
 void mbedtls_ssl_cache_set_max_entries( mbedtls_ssl_cache_context *cache, int max )
 {
+    mbedtls_ssl_cache_shard *shard;
+    mbedtls_ssl_cache_entry *lists[MBEDTLS_SSL_CACHE_SHARDS];
+    mbedtls_ssl_cache_entry **tail, *cur, *prv;
+    int i, left;
+
     if( max < 0 ) max = 0;
 
+#if defined(MBEDTLS_THREADING_C)
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
+    {
+        if( mbedtls_mutex_lock( &cache->shards[i].mutex ) != 0 )
+        {
+            while( --i >= 0 )
+                (void) mbedtls_mutex_unlock( &cache->shards[i].mutex );
+            return;
+        }
+    }
+
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+    {
+        for( i = MBEDTLS_SSL_CACHE_SHARDS - 1; i >= 0; i-- )
+            (void) mbedtls_mutex_unlock( &cache->shards[i].mutex );
+        return;
+    }
+#endif
+
+    /*
+     * Changing the capacity changes the shard and bucket each session ID
+     * maps to: take the entries out of every shard, least recently used
+     * first, and empty the shards.
+     */
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
+    {
+        shard = &cache->shards[i];
+        lists[i] = NULL;
+        tail = &lists[i];
+
+        for( cur = shard->lru_tail; cur != NULL; cur = prv )
+        {
+            prv = cur->lru_prev;
+            cur->lru_prev = NULL;
+            cur->lru_next = NULL;
+            cur->next = NULL;
+            *tail = cur;
+            tail = &cur->next;
+        }
+
+        mbedtls_free( shard->buckets );
+        shard->buckets = NULL;
+        shard->bucket_count = 0;
+        shard->lru_head = NULL;
+        shard->lru_tail = NULL;
+        shard->entries = 0;
+    }
+
     cache->max_entries = max;
+    cache->shard_count = ssl_cache_shard_count( max );
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+
+    /*
+     * Insert them again with the new geometry, taking one entry from each
+     * former shard in turn so that the most recently used entries overall
+     * are the ones kept if the cache shrinks.
+     */
+    do
+    {
+        left = 0;
+
+        for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
+        {
+            if( ( cur = lists[i] ) == NULL )
+                continue;
+
+            lists[i] = cur->next;
+            cur->next = NULL;
+            ssl_cache_reinsert( cache, cur );
+            left |= ( lists[i] != NULL );
+        }
+    }
+    while( left );
+
+#if defined(MBEDTLS_THREADING_C)
+    for( i = MBEDTLS_SSL_CACHE_SHARDS - 1; i >= 0; i-- )
+        (void) mbedtls_mutex_unlock( &cache->shards[i].mutex );
+#endif
 }
 
 void mbedtls_ssl_cache_free( mbedtls_ssl_cache_context *cache )
 {
+    mbedtls_ssl_cache_shard *shard;
     mbedtls_ssl_cache_entry *cur, *prv;
+    int i;
 
-    cur = cache->chain;
-
-    while( cur != NULL )
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
     {
-        prv = cur;
-        cur = cur->next;
+        shard = &cache->shards[i];
+        cur = shard->lru_head;
 
-        mbedtls_ssl_session_free( &prv->session );
+        while( cur != NULL )
+        {
+            prv = cur;
+            cur = cur->lru_next;
+
+            ssl_cache_entry_clear( prv );
+            mbedtls_free( prv );
+        }
 
-#if defined(MBEDTLS_X509_CRT_PARSE_C) && \
-    defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
-        mbedtls_free( prv->peer_cert.p );
-#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+        mbedtls_free( shard->buckets );
 
-        mbedtls_free( prv );
+#if defined(MBEDTLS_THREADING_C)
+        mbedtls_mutex_free( &shard->mutex );
+#endif
     }
 
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_free( &cache->mutex );
 #endif
-    cache->chain = NULL;
+
+    memset( cache->shards, 0, sizeof( cache->shards ) );
 }
 
 #endif /* MBEDTLS_SSL_CACHE_C */
@@ -0,0 +1,577 @@
+/*
+ *  SSL session cache shared between processes
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*
+ * These session callbacks store serialized sessions in fixed-size slots of
+ * a memory-mapped file. Slots are grouped in sets, each protected by a POSIX
+ * record lock on its byte range of the file, so that processes only wait
+ * for each other when they work on the same set. Record locks are released
+ * by the kernel if a process dies while holding one.
+ */
+
+/* Enable definition of ftruncate(), pread() and friends even when compiling
+ * with -std=c99. Must be set before config.h, which pulls in glibc's
+ * features.h indirectly. Harmless on other platforms. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+
+#if !defined(unix) && !defined(__unix__) && !defined(__unix) && \
+    !defined(__APPLE__) && !defined(__QNXNTO__) && \
+    !defined(__HAIKU__) && !defined(__midipix__)
+#error "This module only works on Unix, see MBEDTLS_SSL_CACHE_SHM_C in config.h"
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#endif
+
+#include "mbedtls/ssl_cache_shm.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Number of slots a session ID may be stored in */
+#define SSL_CACHE_SHM_WAYS      4
+
+#define SSL_CACHE_SHM_ALIGN( n )    ( ( ( n ) + 7 ) & ~( (size_t) 7 ) )
+
+static const unsigned char ssl_cache_shm_magic[8] =
+    { 'M', 'B', 'T', 'L', 'S', 'S', 'C', 1 };
+
+/*
+ * Layout of the file: a header, then set_count sets, each made of a
+ * set header and SSL_CACHE_SHM_WAYS slots. Each slot is a slot header
+ * followed by slot_size bytes of serialized session.
+ */
+typedef struct
+{
+    unsigned char magic[8];
+    uint32_t set_count;
+    uint32_t ways;
+    uint32_t slot_size;
+    uint32_t slot_stride;
+}
+ssl_cache_shm_header;
+
+typedef struct
+{
+    uint32_t tick;              /* last use counter of the set  */
+    uint32_t reserved;
+}
+ssl_cache_shm_set;
+
+typedef struct
+{
+    int64_t timestamp;          /* time the session was stored  */
+    uint32_t last_used;         /* tick of the last use         */
+    uint32_t data_len;          /* 0 if the slot is empty       */
+    unsigned char id_len;
+    unsigned char id[32];
+}
+ssl_cache_shm_slot;
+
+#define SSL_CACHE_SHM_HEADER_LEN    SSL_CACHE_SHM_ALIGN( sizeof( ssl_cache_shm_header ) )
+#define SSL_CACHE_SHM_SET_LEN       SSL_CACHE_SHM_ALIGN( sizeof( ssl_cache_shm_set ) )
+#define SSL_CACHE_SHM_SLOT_LEN      SSL_CACHE_SHM_ALIGN( sizeof( ssl_cache_shm_slot ) )
+
+static size_t ssl_cache_shm_set_offset( const mbedtls_ssl_cache_shm_context *cache,
+                                        uint32_t set )
+{
+    return( SSL_CACHE_SHM_HEADER_LEN + (size_t) set * cache->set_stride );
+}
+
+static ssl_cache_shm_set *ssl_cache_shm_get_set( const mbedtls_ssl_cache_shm_context *cache,
+                                                 uint32_t set )
+{
+    return( (ssl_cache_shm_set *)
+            ( cache->base + ssl_cache_shm_set_offset( cache, set ) ) );
+}
+
+static ssl_cache_shm_slot *ssl_cache_shm_get_slot( const mbedtls_ssl_cache_shm_context *cache,
+                                                   uint32_t set, int way )
+{
+    return( (ssl_cache_shm_slot *)
+            ( cache->base + ssl_cache_shm_set_offset( cache, set ) +
+              SSL_CACHE_SHM_SET_LEN + (size_t) way * cache->slot_stride ) );
+}
+
+static unsigned char *ssl_cache_shm_slot_data( ssl_cache_shm_slot *slot )
+{
+    return( (unsigned char *) slot + SSL_CACHE_SHM_SLOT_LEN );
+}
+
+/*
+ * Take or release the record lock on a byte range of the file
+ */
+static int ssl_cache_shm_fcntl_lock( int fd, short type,
+                                     size_t start, size_t len )
+{
+    struct flock fl;
+
+    memset( &fl, 0, sizeof( fl ) );
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = (off_t) start;
+    fl.l_len = (off_t) len;
+
+    while( fcntl( fd, F_SETLKW, &fl ) != 0 )
+    {
+        if( errno != EINTR )
+            return( -1 );
+    }
+
+    return( 0 );
+}
+
+static int ssl_cache_shm_lock( mbedtls_ssl_cache_shm_context *cache,
+                               uint32_t set )
+{
+#if defined(MBEDTLS_THREADING_C)
+    /* Record locks are owned by the process: they do not exclude the
+     * other threads of this process. Threads working on sets that map to
+     * different mutexes still proceed in parallel. */
+    mbedtls_threading_mutex_t *mutex =
+        &cache->mutex[set % MBEDTLS_SSL_CACHE_SHM_MUTEXES];
+
+    if( mbedtls_mutex_lock( mutex ) != 0 )
+        return( -1 );
+#endif
+
+    if( ssl_cache_shm_fcntl_lock( cache->fd, F_WRLCK,
+                                  ssl_cache_shm_set_offset( cache, set ),
+                                  cache->set_stride ) != 0 )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        (void) mbedtls_mutex_unlock( mutex );
+#endif
+        return( -1 );
+    }
+
+    return( 0 );
+}
+
+static int ssl_cache_shm_unlock( mbedtls_ssl_cache_shm_context *cache,
+                                 uint32_t set )
+{
+    int ret = 0;
+
+    if( ssl_cache_shm_fcntl_lock( cache->fd, F_UNLCK,
+                                  ssl_cache_shm_set_offset( cache, set ),
+                                  cache->set_stride ) != 0 )
+        ret = -1;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock(
+            &cache->mutex[set % MBEDTLS_SSL_CACHE_SHM_MUTEXES] ) != 0 )
+        ret = -1;
+#endif
+
+    return( ret );
+}
+
+static void ssl_cache_shm_slot_clear( mbedtls_ssl_cache_shm_context *cache,
+                                      ssl_cache_shm_slot *slot )
+{
+    slot->data_len = 0;
+    slot->id_len = 0;
+    mbedtls_platform_zeroize( slot->id, sizeof( slot->id ) );
+    mbedtls_platform_zeroize( ssl_cache_shm_slot_data( slot ),
+                              cache->slot_size );
+}
+
+void mbedtls_ssl_cache_shm_init( mbedtls_ssl_cache_shm_context *cache )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int i;
+#endif
+
+    memset( cache, 0, sizeof( mbedtls_ssl_cache_shm_context ) );
+
+    cache->fd = -1;
+    cache->timeout = MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT;
+
+#if defined(MBEDTLS_THREADING_C)
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHM_MUTEXES; i++ )
+        mbedtls_mutex_init( &cache->mutex[i] );
+#endif
+}
+
+int mbedtls_ssl_cache_shm_setup( mbedtls_ssl_cache_shm_context *cache,
+                                 const char *path,
+                                 size_t slots, size_t slot_size )
+{
+    int ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    ssl_cache_shm_header *header;
+    struct stat st;
+    size_t set_count, slot_stride, set_stride, map_len;
+    void *base;
+
+    if( cache->base != NULL || path == NULL ||
+        slots == 0 || slot_size == 0 || slot_size > UINT32_MAX / 2 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    set_count = ( slots + SSL_CACHE_SHM_WAYS - 1 ) / SSL_CACHE_SHM_WAYS;
+    slot_stride = SSL_CACHE_SHM_SLOT_LEN + SSL_CACHE_SHM_ALIGN( slot_size );
+    set_stride = SSL_CACHE_SHM_SET_LEN + SSL_CACHE_SHM_WAYS * slot_stride;
+
+    if( set_count > UINT32_MAX ||
+        set_count > ( SIZE_MAX - SSL_CACHE_SHM_HEADER_LEN ) / set_stride )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    map_len = SSL_CACHE_SHM_HEADER_LEN + set_count * set_stride;
+
+    cache->fd = open( path, O_RDWR | O_CREAT, 0600 );
+    if( cache->fd < 0 )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    /* Keep other processes away while checking or formatting the file */
+    if( ssl_cache_shm_fcntl_lock( cache->fd, F_WRLCK, 0, 0 ) != 0 )
+        goto cleanup;
+
+    if( fstat( cache->fd, &st ) != 0 )
+        goto unlock;
+
+    if( st.st_size != 0 )
+    {
+        /* Other processes may have the file mapped: never resize or
+         * reformat it, only attach if it has the requested geometry */
+        ssl_cache_shm_header existing;
+
+        if( (size_t) st.st_size != map_len ||
+            pread( cache->fd, &existing, sizeof( existing ), 0 ) !=
+            (ssize_t) sizeof( existing ) ||
+            memcmp( existing.magic, ssl_cache_shm_magic,
+                    sizeof( ssl_cache_shm_magic ) ) != 0 ||
+            existing.set_count != (uint32_t) set_count ||
+            existing.ways != SSL_CACHE_SHM_WAYS ||
+            existing.slot_size != (uint32_t) slot_size ||
+            existing.slot_stride != (uint32_t) slot_stride )
+        {
+            ret = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            goto unlock;
+        }
+    }
+    else if( ftruncate( cache->fd, (off_t) map_len ) != 0 )
+        goto unlock;
+
+    base = mmap( NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 cache->fd, 0 );
+    if( base == MAP_FAILED )
+        goto unlock;
+
+    cache->base = base;
+    cache->map_len = map_len;
+    cache->set_count = (uint32_t) set_count;
+    cache->slot_size = slot_size;
+    cache->slot_stride = slot_stride;
+    cache->set_stride = set_stride;
+
+    if( st.st_size == 0 )
+    {
+        /* New file: ftruncate() filled it with zeros, i.e. empty slots */
+        header = (ssl_cache_shm_header *) cache->base;
+        header->set_count = cache->set_count;
+        header->ways = SSL_CACHE_SHM_WAYS;
+        header->slot_size = (uint32_t) slot_size;
+        header->slot_stride = (uint32_t) slot_stride;
+        memcpy( header->magic, ssl_cache_shm_magic,
+                sizeof( ssl_cache_shm_magic ) );
+    }
+
+    ret = 0;
+
+unlock:
+    if( ssl_cache_shm_fcntl_lock( cache->fd, F_UNLCK, 0, 0 ) != 0 && ret == 0 )
+        ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+
+cleanup:
+    if( ret != 0 )
+    {
+        if( cache->base != NULL )
+            munmap( cache->base, cache->map_len );
+        close( cache->fd );
+
+        cache->base = NULL;
+        cache->map_len = 0;
+        cache->fd = -1;
+    }
+
+    return( ret );
+}
+
+int mbedtls_ssl_cache_shm_get( void *data, mbedtls_ssl_session *session )
+{
+    int ret = 1;
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_time_t t = mbedtls_time( NULL );
+#endif
+    mbedtls_ssl_cache_shm_context *cache = (mbedtls_ssl_cache_shm_context *) data;
+    ssl_cache_shm_slot *slot = NULL;
+    mbedtls_ssl_session restored;
+    unsigned char *buf = NULL;
+    size_t buf_len = 0;
+    uint32_t set;
+    int way;
+
+    if( cache->base == NULL || session->id_len == 0 ||
+        session->id_len > sizeof( slot->id ) )
+        return( 1 );
+
+    set = mbedtls_ssl_session_id_hash( session->id, session->id_len ) %
+          cache->set_count;
+
+    if( ssl_cache_shm_lock( cache, set ) != 0 )
+        return( 1 );
+
+    for( way = 0; way < SSL_CACHE_SHM_WAYS; way++ )
+    {
+        slot = ssl_cache_shm_get_slot( cache, set, way );
+
+        if( slot->data_len != 0 &&
+            slot->id_len == session->id_len &&
+            memcmp( slot->id, session->id, session->id_len ) == 0 )
+            break;
+    }
+
+    if( way == SSL_CACHE_SHM_WAYS || slot->data_len > cache->slot_size )
+        goto unlock;
+
+#if defined(MBEDTLS_HAVE_TIME)
+    if( cache->timeout != 0 &&
+        (int) ( t - (mbedtls_time_t) slot->timestamp ) > cache->timeout )
+    {
+        /* expired, make room for new entries right away */
+        ssl_cache_shm_slot_clear( cache, slot );
+        goto unlock;
+    }
+#endif
+
+    /* Take a copy so that the session is restored without holding the
+     * lock: this may involve parsing the peer certificate */
+    buf = mbedtls_calloc( 1, slot->data_len );
+    if( buf == NULL )
+        goto unlock;
+
+    memcpy( buf, ssl_cache_shm_slot_data( slot ), slot->data_len );
+    buf_len = slot->data_len;
+
+    slot->last_used = ++ssl_cache_shm_get_set( cache, set )->tick;
+
+unlock:
+    if( ssl_cache_shm_unlock( cache, set ) != 0 )
+        goto exit;
+
+    if( buf == NULL )
+        goto exit;
+
+    mbedtls_ssl_session_init( &restored );
+    if( mbedtls_ssl_session_load( &restored, buf, buf_len ) != 0 )
+        goto exit;
+
+    if( session->ciphersuite != restored.ciphersuite ||
+        session->compression != restored.compression )
+    {
+        mbedtls_ssl_session_free( &restored );
+        goto exit;
+    }
+
+    mbedtls_ssl_session_free( session );
+    *session = restored;
+
+    ret = 0;
+
+exit:
+    if( buf != NULL )
+    {
+        mbedtls_platform_zeroize( buf, buf_len );
+        mbedtls_free( buf );
+    }
+
+    return( ret );
+}
+
+int mbedtls_ssl_cache_shm_set( void *data, const mbedtls_ssl_session *session )
+{
+    int ret = 1;
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_time_t t = mbedtls_time( NULL );
+#endif
+    mbedtls_ssl_cache_shm_context *cache = (mbedtls_ssl_cache_shm_context *) data;
+    ssl_cache_shm_set *set_hdr;
+    ssl_cache_shm_slot *slot, *cur;
+    unsigned char *buf = NULL;
+    size_t buf_len = 0;
+    uint32_t set;
+    int way;
+
+    if( cache->base == NULL || session->id_len == 0 ||
+        session->id_len > sizeof( slot->id ) )
+        return( 1 );
+
+    /*
+     * Serialize the session before taking the lock
+     */
+    if( mbedtls_ssl_session_save( session, NULL, 0, &buf_len ) !=
+        MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL )
+        return( 1 );
+
+    /* Sessions too large for a slot are not cached */
+    if( buf_len > cache->slot_size )
+        return( 1 );
+
+    buf = mbedtls_calloc( 1, buf_len );
+    if( buf == NULL )
+        return( 1 );
+
+    if( mbedtls_ssl_session_save( session, buf, buf_len, &buf_len ) != 0 )
+        goto exit;
+
+    set = mbedtls_ssl_session_id_hash( session->id, session->id_len ) %
+          cache->set_count;
+
+    if( ssl_cache_shm_lock( cache, set ) != 0 )
+        goto exit;
+
+    set_hdr = ssl_cache_shm_get_set( cache, set );
+
+    /*
+     * Pick the slot with the same session ID, or else an empty one,
+     * or else an expired one, or else the least recently used one
+     */
+    slot = NULL;
+    for( way = 0; way < SSL_CACHE_SHM_WAYS; way++ )
+    {
+        cur = ssl_cache_shm_get_slot( cache, set, way );
+
+        if( cur->data_len != 0 &&
+            cur->id_len == session->id_len &&
+            memcmp( cur->id, session->id, session->id_len ) == 0 )
+        {
+            slot = cur;
+            break;
+        }
+    }
+
+    if( slot == NULL )
+    {
+        for( way = 0; way < SSL_CACHE_SHM_WAYS; way++ )
+        {
+            cur = ssl_cache_shm_get_slot( cache, set, way );
+
+            if( cur->data_len == 0 )
+            {
+                slot = cur;
+                break;
+            }
+
+#if defined(MBEDTLS_HAVE_TIME)
+            if( cache->timeout != 0 &&
+                (int) ( t - (mbedtls_time_t) cur->timestamp ) > cache->timeout )
+            {
+                slot = cur;
+                break;
+            }
+#endif
+
+            /* Counters wrap around: the oldest use is the furthest away */
+            if( slot == NULL ||
+                set_hdr->tick - cur->last_used > set_hdr->tick - slot->last_used )
+            {
+                slot = cur;
+            }
+        }
+
+        ssl_cache_shm_slot_clear( cache, slot );
+        slot->id_len = (unsigned char) session->id_len;
+        memcpy( slot->id, session->id, session->id_len );
+#if defined(MBEDTLS_HAVE_TIME)
+        slot->timestamp = (int64_t) t;
+#endif
+    }
+    else
+    {
+        /* client reconnected, keep timestamp for session id */
+        slot->data_len = 0;
+        mbedtls_platform_zeroize( ssl_cache_shm_slot_data( slot ),
+                                  cache->slot_size );
+    }
+
+    memcpy( ssl_cache_shm_slot_data( slot ), buf, buf_len );
+    slot->data_len = (uint32_t) buf_len;
+    slot->last_used = ++set_hdr->tick;
+
+    ret = 0;
+
+    if( ssl_cache_shm_unlock( cache, set ) != 0 )
+        ret = 1;
+
+exit:
+    mbedtls_platform_zeroize( buf, buf_len );
+    mbedtls_free( buf );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_HAVE_TIME)
+void mbedtls_ssl_cache_shm_set_timeout( mbedtls_ssl_cache_shm_context *cache,
+                                        int timeout )
+{
+    if( timeout < 0 ) timeout = 0;
+
+    cache->timeout = timeout;
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+void mbedtls_ssl_cache_shm_free( mbedtls_ssl_cache_shm_context *cache )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int i;
+#endif
+
+    if( cache->base != NULL )
+        munmap( cache->base, cache->map_len );
+
+    if( cache->fd >= 0 )
+        close( cache->fd );
+
+#if defined(MBEDTLS_THREADING_C)
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHM_MUTEXES; i++ )
+        mbedtls_mutex_free( &cache->mutex[i] );
+#endif
+
+    cache->base = NULL;
+    cache->map_len = 0;
+    cache->fd = -1;
+}
+
+#endif /* MBEDTLS_SSL_CACHE_SHM_C */
@@ -247,6 +247,11 @@ static int ssl_write_signature_algorithms_ext( mbedtls_ssl_context *ssl,
     if( sig_alg_len == 0 )
         return( MBEDTLS_ERR_SSL_BAD_CONFIG );
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+    /* ed25519, which does not depend on sig_hashes */
+    sig_alg_len += 2;
+#endif
+
     MBEDTLS_SSL_CHK_BUF_PTR( p, end, sig_alg_len + 6 );
 
     /*
@@ -266,6 +271,11 @@ static int ssl_write_signature_algorithms_ext( mbedtls_ssl_context *ssl,
 #endif
     }
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+    sig_alg_list[sig_alg_len++] = MBEDTLS_SSL_HASH_INTRINSIC;
+    sig_alg_list[sig_alg_len++] = MBEDTLS_SSL_SIG_ED25519;
+#endif
+
     /*
      * enum {
      *     none(0), md5(1), sha1(2), sha224(3), sha256(4), sha384(5),
@@ -2944,6 +2954,20 @@ static int ssl_parse_signature_algorithm( mbedtls_ssl_context *ssl,
     if( (*p) + 2 > end )
         return( MBEDTLS_ERR_SSL_BAD_HS_SERVER_KEY_EXCHANGE );
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+    /*
+     * ed25519, which we always offer: its first byte is not a hash
+     */
+    if( (*p)[0] == MBEDTLS_SSL_HASH_INTRINSIC &&
+        (*p)[1] == MBEDTLS_SSL_SIG_ED25519 )
+    {
+        *pk_alg = MBEDTLS_PK_ED25519;
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "Server used ed25519" ) );
+        *p += 2;
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_ED25519_ENABLED */
+
     /*
      * Get hash algorithm
      */
@@ -2989,6 +3013,70 @@ static int ssl_parse_signature_algorithm( mbedtls_ssl_context *ssl,
           MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED */
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+/*
+ * Verify the Ed25519 signature of a ServerKeyExchange (RFC 8422). EdDSA
+ * has no separate hash step: the signature covers the client and server
+ * randoms followed by the parameters themselves.
+ */
+static int ssl_verify_server_key_exchange_ed25519( mbedtls_ssl_context *ssl,
+                                                   const unsigned char *params,
+                                                   size_t params_len,
+                                                   const unsigned char *sig,
+                                                   size_t sig_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_pk_context *peer_pk;
+    unsigned char *data;
+
+#if !defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    peer_pk = &ssl->handshake->peer_pubkey;
+#else /* !MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+    if( ssl->session_negotiate->peer_cert == NULL )
+    {
+        /* Should never happen */
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
+    peer_pk = &ssl->session_negotiate->peer_cert->pk;
+#endif /* MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+
+    if( ! mbedtls_pk_can_do( peer_pk, MBEDTLS_PK_ED25519 ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad server key exchange message" ) );
+        mbedtls_ssl_send_alert_message( ssl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
+                                        MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE );
+        return( MBEDTLS_ERR_SSL_PK_TYPE_MISMATCH );
+    }
+
+    data = mbedtls_calloc( 1, 64 + params_len );
+    if( data == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    memcpy( data, ssl->handshake->randbytes, 64 );
+    memcpy( data + 64, params, params_len );
+
+    ret = mbedtls_pk_verify( peer_pk, MBEDTLS_MD_NONE, data, 64 + params_len,
+                             sig, sig_len );
+    mbedtls_free( data );
+
+    if( ret != 0 )
+    {
+        mbedtls_ssl_send_alert_message( ssl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
+                                        MBEDTLS_SSL_ALERT_MSG_DECRYPT_ERROR );
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_pk_verify", ret );
+        return( ret );
+    }
+
+#if !defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    /* We don't need the peer's public key anymore. */
+    mbedtls_pk_free( peer_pk );
+#endif
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_ED25519_ENABLED */
+
 #if defined(MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED) || \
     defined(MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED)
 static int ssl_get_ecdh_params_from_cert( mbedtls_ssl_context *ssl )
@@ -3271,6 +3359,9 @@ start_processing:
 #if defined(MBEDTLS_SSL_PROTO_TLS1_2)
         if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_3 )
         {
+            mbedtls_pk_type_t suite_pk_alg =
+                mbedtls_ssl_get_ciphersuite_sig_pk_alg( ciphersuite_info );
+
             if( ssl_parse_signature_algorithm( ssl, &p, end,
                                                &md_alg, &pk_alg ) != 0 )
             {
@@ -3283,8 +3374,14 @@ start_processing:
                 return( MBEDTLS_ERR_SSL_BAD_HS_SERVER_KEY_EXCHANGE );
             }
 
-            if( pk_alg !=
-                mbedtls_ssl_get_ciphersuite_sig_pk_alg( ciphersuite_info ) )
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+            /* ECDHE_ECDSA suites may also be signed with Ed25519 */
+            if( suite_pk_alg == MBEDTLS_PK_ECDSA &&
+                pk_alg == MBEDTLS_PK_ED25519 )
+                suite_pk_alg = MBEDTLS_PK_ED25519;
+#endif
+
+            if( pk_alg != suite_pk_alg )
             {
                 MBEDTLS_SSL_DEBUG_MSG( 1,
                     ( "bad server key exchange message" ) );
@@ -3342,6 +3439,17 @@ start_processing:
 
         MBEDTLS_SSL_DEBUG_BUF( 3, "signature", p, sig_len );
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+        if( pk_alg == MBEDTLS_PK_ED25519 )
+        {
+            if( ( ret = ssl_verify_server_key_exchange_ed25519( ssl,
+                            params, params_len, p, sig_len ) ) != 0 )
+                return( ret );
+
+            goto exit;
+        }
+#endif /* MBEDTLS_SSL_ED25519_ENABLED */
+
         /*
          * Compute the hash that has been signed
          */
@@ -4163,6 +4271,16 @@ static int ssl_write_certificate_verify( mbedtls_ssl_context *ssl )
         return( MBEDTLS_ERR_SSL_PRIVATE_KEY_REQUIRED );
     }
 
+#if defined(MBEDTLS_ED25519_C)
+    /* Ed25519 would have to sign the handshake messages themselves, while
+     * only their running hashes are kept. */
+    if( mbedtls_pk_get_type( mbedtls_ssl_own_key( ssl ) ) == MBEDTLS_PK_ED25519 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "Ed25519 client authentication is not supported" ) );
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+#endif
+
     /*
      * Make a signature of the handshake digests
      */
@@ -4416,7 +4534,12 @@ int mbedtls_ssl_handshake_client_step( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "client state: %d", ssl->state ) );
 
-    if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+    /* Records held back for a vectored send are only flushed at the end of
+     * the handshake, or when reading the peer's next flight. */
+    if( ( ssl->out_left != 0 ||
+          ssl->state == MBEDTLS_SSL_FLUSH_BUFFERS ||
+          ssl->state == MBEDTLS_SSL_HANDSHAKE_WRAPUP ) &&
+        ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
         return( ret );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
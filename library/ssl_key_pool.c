@@ -0,0 +1,432 @@
+/*
+ *  SSL ephemeral ECDHE key pool implementation
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*
+ * The pool keeps a stack of key pairs per curve. Only the private and
+ * public keys are stored: the group is reloaded from its static
+ * parameters when a key pair is handed out, which is cheap, rather than
+ * keeping a copy of it (and of its precomputed tables) per key pair.
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_SSL_KEY_POOL_C)
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#endif
+
+#include "mbedtls/ssl_key_pool.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_THREADING_THREADS)
+/* Values of mbedtls_ssl_key_pool::thread_state */
+#define KEY_POOL_THREAD_NONE        0   /* no thread to join            */
+#define KEY_POOL_THREAD_RUNNING     1   /* refilling                    */
+#define KEY_POOL_THREAD_DONE        2   /* finished, not joined yet     */
+#endif
+
+void mbedtls_ssl_key_pool_init( mbedtls_ssl_key_pool *pool )
+{
+    memset( pool, 0, sizeof( mbedtls_ssl_key_pool ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &pool->mutex );
+#endif
+}
+
+int mbedtls_ssl_key_pool_setup( mbedtls_ssl_key_pool *pool,
+                                const mbedtls_ecp_group_id *curves,
+                                size_t size )
+{
+    size_t nb_curves, i, j;
+    mbedtls_ssl_key_pool_curve *cur;
+
+    if( pool->curves != NULL || size == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    for( nb_curves = 0; curves[nb_curves] != MBEDTLS_ECP_DP_NONE; nb_curves++ )
+    {
+        if( mbedtls_ecp_curve_info_from_grp_id( curves[nb_curves] ) == NULL )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    if( nb_curves == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    pool->curves = mbedtls_calloc( nb_curves, sizeof( *pool->curves ) );
+    if( pool->curves == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    pool->nb_curves = nb_curves;
+    pool->size = size;
+
+    for( i = 0; i < nb_curves; i++ )
+    {
+        cur = &pool->curves[i];
+        cur->grp_id = curves[i];
+        cur->d = mbedtls_calloc( size, sizeof( mbedtls_mpi ) );
+        cur->Q = mbedtls_calloc( size, sizeof( mbedtls_ecp_point ) );
+
+        if( cur->d == NULL || cur->Q == NULL )
+        {
+            mbedtls_ssl_key_pool_free( pool );
+            mbedtls_ssl_key_pool_init( pool );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+
+        for( j = 0; j < size; j++ )
+        {
+            mbedtls_mpi_init( &cur->d[j] );
+            mbedtls_ecp_point_init( &cur->Q[j] );
+        }
+    }
+
+    return( 0 );
+}
+
+/*
+ * Add a key pair to a curve's stack if it is not full yet.
+ * Returns 1 if the key pair was taken over, 0 if the caller keeps it.
+ */
+static int key_pool_push( mbedtls_ssl_key_pool *pool,
+                          mbedtls_ssl_key_pool_curve *cur,
+                          mbedtls_mpi *d, mbedtls_ecp_point *Q )
+{
+    int pushed = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( 0 );
+#endif
+
+    if( cur->count < pool->size )
+    {
+        cur->d[cur->count] = *d;
+        cur->Q[cur->count] = *Q;
+        cur->count++;
+        pushed = 1;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &pool->mutex );
+#endif
+
+    return( pushed );
+}
+
+int mbedtls_ssl_key_pool_refill( mbedtls_ssl_key_pool *pool,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng )
+{
+    int ret = 0;
+    size_t i;
+    mbedtls_ssl_key_pool_curve *cur;
+    mbedtls_ecp_group grp;
+    mbedtls_mpi d;
+    mbedtls_ecp_point Q;
+
+    mbedtls_ecp_group_init( &grp );
+
+    for( i = 0; i < pool->nb_curves; i++ )
+    {
+        cur = &pool->curves[i];
+
+        /* One group per curve and per call, so that its precomputed
+         * tables are shared by the whole batch but never by two threads */
+        mbedtls_ecp_group_free( &grp );
+        if( ( ret = mbedtls_ecp_group_load( &grp, cur->grp_id ) ) != 0 )
+            goto cleanup;
+
+        while( mbedtls_ssl_key_pool_count( pool, cur->grp_id ) < pool->size )
+        {
+            mbedtls_mpi_init( &d );
+            mbedtls_ecp_point_init( &Q );
+
+            ret = mbedtls_ecp_gen_keypair( &grp, &d, &Q, f_rng, p_rng );
+
+            if( ret != 0 || key_pool_push( pool, cur, &d, &Q ) == 0 )
+            {
+                /* Generation failed, or a concurrent refill got there
+                 * first */
+                mbedtls_mpi_free( &d );
+                mbedtls_ecp_point_free( &Q );
+                if( ret != 0 )
+                    goto cleanup;
+                break;
+            }
+        }
+    }
+
+cleanup:
+    mbedtls_ecp_group_free( &grp );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_THREADING_THREADS)
+static void key_pool_refill_thread( void *arg )
+{
+    mbedtls_ssl_key_pool *pool = (mbedtls_ssl_key_pool *) arg;
+    int (*f_rng)(void *, unsigned char *, size_t);
+    void *p_rng;
+
+    /* Serve the requests made while refilling, so that none is lost
+     * between the last refill and the end of the thread */
+    for( ;; )
+    {
+        if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+            return;
+
+        if( pool->refill_pending == 0 )
+        {
+            pool->thread_state = KEY_POOL_THREAD_DONE;
+            (void) mbedtls_mutex_unlock( &pool->mutex );
+            return;
+        }
+
+        pool->refill_pending = 0;
+        f_rng = pool->f_rng;
+        p_rng = pool->p_rng;
+
+        if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+            return;
+
+        /* On failure, the next request starts over */
+        (void) mbedtls_ssl_key_pool_refill( pool, f_rng, p_rng );
+    }
+}
+
+/*
+ * Request a background refill, starting a thread unless one is running.
+ * Must be called with the pool's mutex held.
+ */
+static int key_pool_request_refill( mbedtls_ssl_key_pool *pool )
+{
+    int ret;
+
+    pool->refill_pending = 1;
+
+    if( pool->thread_state == KEY_POOL_THREAD_RUNNING )
+        return( 0 );
+
+    /* The previous thread is past its last use of the mutex */
+    if( pool->thread_state == KEY_POOL_THREAD_DONE )
+    {
+        (void) mbedtls_thread_join( &pool->thread );
+        pool->thread_state = KEY_POOL_THREAD_NONE;
+    }
+
+    if( ( ret = mbedtls_thread_create( &pool->thread,
+                                       key_pool_refill_thread, pool ) ) != 0 )
+        return( ret );
+
+    pool->thread_state = KEY_POOL_THREAD_RUNNING;
+
+    return( 0 );
+}
+
+int mbedtls_ssl_key_pool_start_refill( mbedtls_ssl_key_pool *pool,
+                                       int (*f_rng)(void *, unsigned char *,
+                                                    size_t),
+                                       void *p_rng )
+{
+    int ret;
+
+    if( pool->curves == NULL || f_rng == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ( ret = mbedtls_mutex_lock( &pool->mutex ) ) != 0 )
+        return( ret );
+
+    pool->f_rng = f_rng;
+    pool->p_rng = p_rng;
+    pool->background = 1;
+
+    if( ( ret = key_pool_request_refill( pool ) ) != 0 )
+        pool->background = 0;
+
+    if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( ret );
+}
+
+void mbedtls_ssl_key_pool_stop_refill( mbedtls_ssl_key_pool *pool )
+{
+    int state;
+
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return;
+
+    /* From now on, no thread is started nor joined by anyone else */
+    pool->background = 0;
+    state = pool->thread_state;
+
+    (void) mbedtls_mutex_unlock( &pool->mutex );
+
+    if( state != KEY_POOL_THREAD_NONE )
+        (void) mbedtls_thread_join( &pool->thread );
+
+    pool->thread_state = KEY_POOL_THREAD_NONE;
+    pool->refill_pending = 0;
+    pool->f_rng = NULL;
+    pool->p_rng = NULL;
+}
+#endif /* MBEDTLS_THREADING_THREADS */
+
+int mbedtls_ssl_key_pool_get( void *data, mbedtls_ecp_group_id grp_id,
+                              mbedtls_ecp_keypair *key )
+{
+    int ret = 1;
+    size_t i;
+    mbedtls_ssl_key_pool *pool = (mbedtls_ssl_key_pool *) data;
+    mbedtls_ssl_key_pool_curve *cur;
+    mbedtls_mpi d;
+    mbedtls_ecp_point Q;
+
+    mbedtls_mpi_init( &d );
+    mbedtls_ecp_point_init( &Q );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( 1 );
+#endif
+
+    for( i = 0; i < pool->nb_curves; i++ )
+    {
+        cur = &pool->curves[i];
+        if( cur->grp_id != grp_id )
+            continue;
+
+        if( cur->count > 0 )
+        {
+            cur->count--;
+            d = cur->d[cur->count];
+            Q = cur->Q[cur->count];
+            mbedtls_mpi_init( &cur->d[cur->count] );
+            mbedtls_ecp_point_init( &cur->Q[cur->count] );
+            ret = 0;
+        }
+
+#if defined(MBEDTLS_THREADING_THREADS)
+        /* If the thread can't be started, keep serving what is left */
+        if( pool->background && cur->count <= pool->size / 2 )
+            (void) key_pool_request_refill( pool );
+#endif
+        break;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+    {
+        mbedtls_mpi_free( &d );
+        mbedtls_ecp_point_free( &Q );
+        return( 1 );
+    }
+#endif
+
+    if( ret != 0 )
+        return( ret );
+
+    mbedtls_ecp_keypair_free( key );
+    mbedtls_ecp_keypair_init( key );
+    key->d = d;
+    key->Q = Q;
+
+    if( mbedtls_ecp_group_load( &key->grp, grp_id ) != 0 )
+    {
+        mbedtls_ecp_keypair_free( key );
+        mbedtls_ecp_keypair_init( key );
+        return( 1 );
+    }
+
+    return( 0 );
+}
+
+size_t mbedtls_ssl_key_pool_count( mbedtls_ssl_key_pool *pool,
+                                   mbedtls_ecp_group_id grp_id )
+{
+    size_t i, count = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( 0 );
+#endif
+
+    for( i = 0; i < pool->nb_curves; i++ )
+    {
+        if( pool->curves[i].grp_id == grp_id )
+        {
+            count = pool->curves[i].count;
+            break;
+        }
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+        return( 0 );
+#endif
+
+    return( count );
+}
+
+void mbedtls_ssl_key_pool_free( mbedtls_ssl_key_pool *pool )
+{
+    size_t i, j;
+    mbedtls_ssl_key_pool_curve *cur;
+
+    if( pool == NULL )
+        return;
+
+#if defined(MBEDTLS_THREADING_THREADS)
+    mbedtls_ssl_key_pool_stop_refill( pool );
+#endif
+
+    for( i = 0; i < pool->nb_curves && pool->curves != NULL; i++ )
+    {
+        cur = &pool->curves[i];
+
+        for( j = 0; j < pool->size; j++ )
+        {
+            if( cur->d != NULL )
+                mbedtls_mpi_free( &cur->d[j] );
+            if( cur->Q != NULL )
+                mbedtls_ecp_point_free( &cur->Q[j] );
+        }
+
+        mbedtls_free( cur->d );
+        mbedtls_free( cur->Q );
+    }
+
+    mbedtls_free( pool->curves );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &pool->mutex );
+#endif
+
+    mbedtls_platform_zeroize( pool, sizeof( mbedtls_ssl_key_pool ) );
+}
+
+#endif /* MBEDTLS_SSL_KEY_POOL_C */
@@ -1984,6 +1984,202 @@ static int ssl_decompress_buf( mbedtls_ssl_context *ssl )
 }
 #endif /* MBEDTLS_ZLIB_SUPPORT */
 
+/*
+ * Check whether mbedtls_ssl_fetch_input() may read past the data it was
+ * asked for (TLS only)
+ */
+static int ssl_read_ahead_enabled( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    /* Decompression uses all of the input buffer past the record */
+    (void) ssl;
+    return( 0 );
+#else
+    if( ssl->conf->read_ahead != MBEDTLS_SSL_READ_AHEAD_ENABLED )
+        return( 0 );
+
+#if defined(MBEDTLS_SSL_SRV_C)
+    /* ssl_parse_client_hello() expects the initial ClientHello record alone
+     * in the buffer; the client sends nothing else before our reply. */
+    if( ssl->conf->endpoint == MBEDTLS_SSL_IS_SERVER &&
+        ssl->state == MBEDTLS_SSL_CLIENT_HELLO )
+        return( 0 );
+#endif
+
+    return( 1 );
+#endif /* MBEDTLS_ZLIB_SUPPORT */
+}
+
+/*
+ * Output queue: with a vectored send callback, sealed TLS records are held
+ * back and sent together, rather than one f_send() call per record. This is
+ * used for the records of a handshake flight, which are sent when the flight
+ * is complete, and for those of an application data write that is longer
+ * than one record.
+ */
+static int ssl_out_queue_pending( const mbedtls_ssl_context *ssl )
+{
+    return( ssl->out_queue != NULL && ssl->out_queue->cnt != 0 );
+}
+
+/*
+ * Whether the handshake record that was just written may wait in the output
+ * queue
+ */
+static int ssl_out_queue_accepts( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( 0 );
+#endif
+
+    return( ssl->f_send_vec != NULL &&
+            ssl->handshake != NULL &&
+            ( ssl->out_queue == NULL ||
+              ssl->out_queue->cnt < MBEDTLS_SSL_OUT_QUEUE_MAX ) &&
+            ( ssl->out_msgtype == MBEDTLS_SSL_MSG_HANDSHAKE ||
+              ssl->out_msgtype == MBEDTLS_SSL_MSG_CHANGE_CIPHER_SPEC ) );
+}
+
+/*
+ * Move the pending content of the output buffer to the output queue
+ */
+static int ssl_out_queue_append( mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_out_queue *q;
+    unsigned char *data;
+
+    if( ssl->out_queue == NULL )
+    {
+        ssl->out_queue = mbedtls_calloc( 1, sizeof( mbedtls_ssl_out_queue ) );
+        if( ssl->out_queue == NULL )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%" MBEDTLS_PRINTF_SIZET
+                                        " bytes) failed",
+                                        sizeof( mbedtls_ssl_out_queue ) ) );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+    }
+    q = ssl->out_queue;
+
+    if( ( data = mbedtls_calloc( 1, ssl->out_left ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc %" MBEDTLS_PRINTF_SIZET " bytes failed",
+                                    ssl->out_left ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    memcpy( data, ssl->out_hdr - ssl->out_left, ssl->out_left );
+    q->rec[q->cnt].data = data;
+    q->rec[q->cnt].len  = ssl->out_left;
+    q->cnt++;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "record queued, %" MBEDTLS_PRINTF_SIZET
+                                " record(s) pending", q->cnt ) );
+
+    ssl->out_left = 0;
+    ssl->out_hdr  = ssl->out_buf + 8;
+    mbedtls_ssl_update_out_pointers( ssl, ssl->transform_out );
+
+    return( 0 );
+}
+
+/*
+ * Send the output queue, followed by the content of the output buffer,
+ * until the queue is empty. What remains in the output buffer is left to
+ * the caller.
+ */
+static int ssl_out_queue_flush( mbedtls_ssl_context *ssl )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ssl_out_queue * const q = ssl->out_queue;
+    mbedtls_ssl_iovec iov[MBEDTLS_SSL_OUT_QUEUE_MAX + 1];
+    size_t iovcnt, i, sent;
+
+    while( ssl_out_queue_pending( ssl ) )
+    {
+        iov[0].base = q->rec[0].data + q->sent;
+        iov[0].len  = q->rec[0].len - q->sent;
+        for( i = 1; i < q->cnt; i++ )
+        {
+            iov[i].base = q->rec[i].data;
+            iov[i].len  = q->rec[i].len;
+        }
+        iovcnt = q->cnt;
+
+        if( ssl->out_left > 0 )
+        {
+            iov[iovcnt].base = ssl->out_hdr - ssl->out_left;
+            iov[iovcnt].len  = ssl->out_left;
+            iovcnt++;
+        }
+
+        /* The callback may have been removed since the records were queued */
+        if( ssl->f_send_vec != NULL )
+        {
+            ret = ssl->f_send_vec( ssl->p_bio, iov, iovcnt );
+            MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send_vec", ret );
+        }
+        else
+        {
+            ret = ssl->f_send( ssl->p_bio, iov[0].base, iov[0].len );
+            MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send", ret );
+        }
+
+        if( ret <= 0 )
+            return( ret );
+
+        /* Release the records that went out entirely */
+        sent = (size_t) ret;
+        while( sent > 0 && q->cnt > 0 )
+        {
+            size_t left = q->rec[0].len - q->sent;
+
+            if( sent < left )
+            {
+                q->sent += sent;
+                sent = 0;
+                break;
+            }
+
+            sent -= left;
+            mbedtls_free( q->rec[0].data );
+            q->cnt--;
+            q->sent = 0;
+            memmove( &q->rec[0], &q->rec[1], q->cnt * sizeof( q->rec[0] ) );
+        }
+
+        if( sent > ssl->out_left )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "f_send_vec returned %d bytes, more "
+                                        "than requested", ret ) );
+            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        }
+
+        ssl->out_left -= sent;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Free the output queue and the records still waiting in it
+ */
+void mbedtls_ssl_out_queue_free( mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_out_queue * const q = ssl->out_queue;
+    size_t i;
+
+    if( q == NULL )
+        return;
+
+    for( i = 0; i < q->cnt; i++ )
+        mbedtls_free( q->rec[i].data );
+
+    mbedtls_free( q );
+    ssl->out_queue = NULL;
+}
+
 /*
  * Fill the input message buffer by appending data to it.
  * The amount of data already fetched is in ssl->in_left.
@@ -1998,6 +2194,9 @@ static int ssl_decompress_buf( mbedtls_ssl_context *ssl )
  *
  * For DTLS, it is up to the caller to set ssl->next_record_offset when
  * they're done reading a record.
+ *
+ * With TLS and read-ahead, on success ssl->in_left >= nb_want as well,
+ * and the same applies to the bytes that were read past the current record.
  */
 int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
 {
@@ -2024,6 +2223,43 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
+    /*
+     * The peer can only answer once it got the records we held back
+     */
+    if( ssl_out_queue_pending( ssl ) &&
+        ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+        return( ret );
+    }
+
+    /*
+     * Move to the next record in the already read datagram (DTLS) or among
+     * the bytes read ahead (TLS) if applicable
+     */
+    if( ssl->next_record_offset != 0 )
+    {
+        if( ssl->in_left < ssl->next_record_offset )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        }
+
+        ssl->in_left -= ssl->next_record_offset;
+
+        if( ssl->in_left != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 2, ( "next record already read, offset: %"
+                                        MBEDTLS_PRINTF_SIZET,
+                                ssl->next_record_offset ) );
+            memmove( ssl->in_hdr,
+                     ssl->in_hdr + ssl->next_record_offset,
+                     ssl->in_left );
+        }
+
+        ssl->next_record_offset = 0;
+    }
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
     {
@@ -2036,32 +2272,6 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
          * header) and/or some other records in the same datagram.
          */
 
-        /*
-         * Move to the next record in the already read datagram if applicable
-         */
-        if( ssl->next_record_offset != 0 )
-        {
-            if( ssl->in_left < ssl->next_record_offset )
-            {
-                MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-                return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-            }
-
-            ssl->in_left -= ssl->next_record_offset;
-
-            if( ssl->in_left != 0 )
-            {
-                MBEDTLS_SSL_DEBUG_MSG( 2, ( "next record in same datagram, offset: %"
-                                            MBEDTLS_PRINTF_SIZET,
-                                    ssl->next_record_offset ) );
-                memmove( ssl->in_hdr,
-                         ssl->in_hdr + ssl->next_record_offset,
-                         ssl->in_left );
-            }
-
-            ssl->next_record_offset = 0;
-        }
-
         MBEDTLS_SSL_DEBUG_MSG( 2, ( "in_left: %" MBEDTLS_PRINTF_SIZET
                                     ", nb_want: %" MBEDTLS_PRINTF_SIZET,
                        ssl->in_left, nb_want ) );
@@ -2172,6 +2382,11 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         {
             len = nb_want - ssl->in_left;
 
+            /* Ask for as much as fits, to get the next records along */
+            if( ssl_read_ahead_enabled( ssl ) )
+                len = in_buf_len - (size_t)( ssl->in_hdr - ssl->in_buf ) -
+                      ssl->in_left;
+
             if( mbedtls_ssl_check_timer( ssl ) != 0 )
                 ret = MBEDTLS_ERR_SSL_TIMEOUT;
             else
@@ -2235,12 +2450,16 @@ int mbedtls_ssl_flush_output( mbedtls_ssl_context *ssl )
     }
 
     /* Avoid incrementing counter if data is flushed */
-    if( ssl->out_left == 0 )
+    if( ssl->out_left == 0 && ! ssl_out_queue_pending( ssl ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= flush output" ) );
         return( 0 );
     }
 
+    /* Queued records come first, and may take the output buffer along */
+    if( ( ret = ssl_out_queue_flush( ssl ) ) != 0 )
+        return( ret );
+
     while( ssl->out_left > 0 )
     {
         MBEDTLS_SSL_DEBUG_MSG( 2, ( "message length: %" MBEDTLS_PRINTF_SIZET
@@ -2809,6 +3028,27 @@ int mbedtls_ssl_write_handshake_msg( mbedtls_ssl_context *ssl )
  * Record layer functions
  */
 
+/*
+ * Move to the sequence number of the next outgoing record
+ */
+static int ssl_increment_out_ctr( mbedtls_ssl_context *ssl )
+{
+    unsigned i;
+
+    for( i = 8; i > mbedtls_ssl_ep_len( ssl ); i-- )
+        if( ++ssl->cur_out_ctr[i - 1] != 0 )
+            break;
+
+    /* The loop goes to its end iff the counter is wrapping */
+    if( i == mbedtls_ssl_ep_len( ssl ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "outgoing message counter would wrap" ) );
+        return( MBEDTLS_ERR_SSL_COUNTER_WRAPPING );
+    }
+
+    return( 0 );
+}
+
 /*
  * Write current record.
  *
@@ -2857,7 +3097,6 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl, uint8_t force_flush )
 #endif /* MBEDTLS_SSL_HW_RECORD_ACCEL */
     if( !done )
     {
-        unsigned i;
         size_t protected_record_size;
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
         size_t out_buf_len = ssl->out_buf_len;
@@ -2950,16 +3189,8 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl, uint8_t force_flush )
         ssl->out_hdr  += protected_record_size;
         mbedtls_ssl_update_out_pointers( ssl, ssl->transform_out );
 
-        for( i = 8; i > mbedtls_ssl_ep_len( ssl ); i-- )
-            if( ++ssl->cur_out_ctr[i - 1] != 0 )
-                break;
-
-        /* The loop goes to its end iff the counter is wrapping */
-        if( i == mbedtls_ssl_ep_len( ssl ) )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "outgoing message counter would wrap" ) );
-            return( MBEDTLS_ERR_SSL_COUNTER_WRAPPING );
-        }
+        if( ( ret = ssl_increment_out_ctr( ssl ) ) != 0 )
+            return( ret );
     }
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -2987,6 +3218,17 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl, uint8_t force_flush )
     }
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
+    /* Hold handshake records back until the flight is complete */
+    if( flush == SSL_FORCE_FLUSH && ssl_out_queue_accepts( ssl ) )
+    {
+        if( ( ret = ssl_out_queue_append( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "ssl_out_queue_append", ret );
+            return( ret );
+        }
+        flush = SSL_DONT_FORCE_FLUSH;
+    }
+
     if( ( flush == SSL_FORCE_FLUSH ) &&
         ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
     {
@@ -4799,7 +5041,14 @@ static int ssl_get_next_record( mbedtls_ssl_context *ssl )
             return( ret );
         }
 
-        ssl->in_left = 0;
+        /* Keep the bytes read ahead, if any, for the next record */
+        if( ssl->in_left > rec.buf_len )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "more data read past the record" ) );
+            ssl->next_record_offset = rec.buf_len;
+        }
+        else
+            ssl->in_left = 0;
     }
 
     /*
@@ -5064,6 +5313,20 @@ int mbedtls_ssl_send_alert_message( mbedtls_ssl_context *ssl,
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls & MBEDTLS_SSL_KTLS_TX )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alerts cannot be sent once record "
+                                    "protection is offloaded" ) );
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+#endif
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> send alert message" ) );
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "send alert level=%u message=%u", level, message ));
 
@@ -5339,6 +5602,23 @@ int mbedtls_ssl_check_pending( const mbedtls_ssl_context *ssl )
     }
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
+    /*
+     * Case B': A complete record was read ahead (TLS).
+     */
+
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_STREAM &&
+        ssl->in_left > ssl->next_record_offset )
+    {
+        const unsigned char *rec = ssl->in_hdr + ssl->next_record_offset;
+        size_t avail = ssl->in_left - ssl->next_record_offset;
+
+        if( avail >= 5 && avail - 5 >= ( ( (size_t) rec[3] << 8 ) | rec[4] ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "ssl_check_pending: record read ahead" ) );
+            return( 1 );
+        }
+    }
+
     /*
      * Case C: A handshake message is being processed.
      */
@@ -5429,6 +5709,33 @@ int mbedtls_ssl_get_record_expansion( const mbedtls_ssl_context *ssl )
     return( (int)( out_hdr_len + transform_expansion ) );
 }
 
+int mbedtls_ssl_get_record_headroom( const mbedtls_ssl_context *ssl )
+{
+    int ret = mbedtls_ssl_get_record_expansion( ssl );
+    size_t headroom = mbedtls_ssl_out_hdr_len( ssl );
+
+    if( ret < 0 )
+        return( ret );
+
+    if( ssl->transform_out != NULL )
+        headroom += ssl_transform_get_explicit_iv_len( ssl->transform_out );
+
+    return( (int) headroom );
+}
+
+int mbedtls_ssl_get_record_tailroom( const mbedtls_ssl_context *ssl )
+{
+    int expansion = mbedtls_ssl_get_record_expansion( ssl );
+    int headroom = mbedtls_ssl_get_record_headroom( ssl );
+
+    if( expansion < 0 )
+        return( expansion );
+    if( headroom < 0 )
+        return( headroom );
+
+    return( expansion - headroom );
+}
+
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
 /*
  * Check record counters and renegotiate if they're above the limit.
@@ -5461,70 +5768,237 @@ static int ssl_check_ctr_renegotiate( mbedtls_ssl_context *ssl )
 }
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
+#if defined(MBEDTLS_SSL_KTLS)
 /*
- * Receive application data decrypted from the SSL layer
+ * Kernel TLS: export the record protection parameters of one direction
  */
-int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+int mbedtls_ssl_export_record_keys( const mbedtls_ssl_context *ssl,
+                                    int direction,
+                                    mbedtls_ssl_record_keys *keys )
 {
-    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t n;
+    const mbedtls_ssl_transform *transform;
+    const mbedtls_cipher_context_t *cipher_ctx;
+    const unsigned char *key, *iv, *ctr;
 
-    if( ssl == NULL || ssl->conf == NULL )
+    if( ssl == NULL || ssl->conf == NULL || keys == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
-    {
-        if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
-            return( ret );
-
-        if( ssl->handshake != NULL &&
-            ssl->handshake->retransmit_state == MBEDTLS_SSL_RETRANS_SENDING )
-        {
-            if( ( ret = mbedtls_ssl_flight_transmit( ssl ) ) != 0 )
-                return( ret );
-        }
-    }
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
 #endif
 
-    /*
-     * Check if renegotiation is necessary and/or handshake is
-     * in process. If yes, perform/continue, and fall through
-     * if an unexpected packet is received while the client
-     * is waiting for the ServerHello.
-     *
-     * (There is no equivalent to the last condition on
-     *  the server-side as it is not treated as within
-     *  a handshake while waiting for the ClientHello
-     *  after a renegotiation request.)
-     */
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    if( ssl->session->compression == MBEDTLS_SSL_COMPRESS_DEFLATE )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
 
-#if defined(MBEDTLS_SSL_RENEGOTIATION)
-    ret = ssl_check_ctr_renegotiate( ssl );
-    if( ret != MBEDTLS_ERR_SSL_WAITING_SERVER_HELLO_RENEGO &&
-        ret != 0 )
+    if( direction == MBEDTLS_SSL_KTLS_TX )
     {
-        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_check_ctr_renegotiate", ret );
-        return( ret );
+        /* Everything we wrote must have been sent */
+        if( ssl->out_left != 0 )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+        transform  = ssl->transform_out;
+        cipher_ctx = transform != NULL ? &transform->cipher_ctx_enc : NULL;
+        key = transform != NULL ? transform->key_enc : NULL;
+        iv  = transform != NULL ? transform->iv_enc : NULL;
+        ctr = ssl->cur_out_ctr;
     }
+    else if( direction == MBEDTLS_SSL_KTLS_RX )
+    {
+        /* Nothing received may be left for us to decrypt */
+        if( mbedtls_ssl_check_pending( ssl ) != 0 || ssl->in_left != 0 )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+        transform  = ssl->transform_in;
+        cipher_ctx = transform != NULL ? &transform->cipher_ctx_dec : NULL;
+        key = transform != NULL ? transform->key_dec : NULL;
+        iv  = transform != NULL ? transform->iv_dec : NULL;
+        ctr = ssl->in_ctr;
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        /* The input buffer may be back in the pool */
+        if( ssl->in_buf == NULL )
+            ctr = ssl->in_ctr_idle;
 #endif
+    }
+    else
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    if( transform == NULL ||
+        transform->minor_ver != MBEDTLS_SSL_MINOR_VERSION_3 ||
+        transform->keylen == 0 )
     {
-        ret = mbedtls_ssl_handshake( ssl );
-        if( ret != MBEDTLS_ERR_SSL_WAITING_SERVER_HELLO_RENEGO &&
-            ret != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_handshake", ret );
-            return( ret );
-        }
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+
+    memset( keys, 0, sizeof( *keys ) );
+    keys->cipher = mbedtls_cipher_get_type( cipher_ctx );
+
+    switch( keys->cipher )
+    {
+        case MBEDTLS_CIPHER_AES_128_GCM:
+        case MBEDTLS_CIPHER_AES_256_GCM:
+        case MBEDTLS_CIPHER_CHACHA20_POLY1305:
+            break;
+
+        default:
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "cipher %d cannot be exported",
+                                        (int) keys->cipher ) );
+            return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+
+    if( transform->fixed_ivlen > sizeof( keys->iv ) )
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+
+    memcpy( keys->key, key, transform->keylen );
+    keys->key_len = transform->keylen;
+    memcpy( keys->iv, iv, transform->fixed_ivlen );
+    keys->iv_len = transform->fixed_ivlen;
+    memcpy( keys->seq, ctr, sizeof( keys->seq ) );
+
+    return( 0 );
+}
+
+int mbedtls_ssl_set_ktls( mbedtls_ssl_context *ssl, int directions )
+{
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        ( directions & ~( MBEDTLS_SSL_KTLS_TX | MBEDTLS_SSL_KTLS_RX ) ) != 0 )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "record protection offloaded: tx %d rx %d",
+                                ( directions & MBEDTLS_SSL_KTLS_TX ) != 0,
+                                ( directions & MBEDTLS_SSL_KTLS_RX ) != 0 ) );
+
+    ssl->ktls |= (unsigned char) directions;
+
+    return( 0 );
+}
+
+/*
+ * With the records protected by the transport, application data goes
+ * straight through the BIO callbacks.
+ */
+static int ssl_ktls_read( mbedtls_ssl_context *ssl,
+                          unsigned char *buf, size_t len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ssl->f_recv_timeout != NULL )
+        ret = ssl->f_recv_timeout( ssl->p_bio, buf, len,
+                                   ssl->conf->read_timeout );
+    else if( ssl->f_recv != NULL )
+        ret = ssl->f_recv( ssl->p_bio, buf, len );
+    else
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_recv(_timeout)()", ret );
+
+    /* A return value of 0 means that the transport was closed without a
+     * CloseNotify, which mbedtls_ssl_read() reports as 0 as well */
+    return( ret );
+}
+
+static int ssl_ktls_write( mbedtls_ssl_context *ssl,
+                           const unsigned char *buf, size_t len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ssl->f_send == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ret = ssl->f_send( ssl->p_bio, buf, len );
+
+    MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send", ret );
+
+    return( ret );
+}
+#endif /* MBEDTLS_SSL_KTLS */
+
+/*
+ * Make sure application data is available in ssl->in_offt, reading records
+ * and processing renegotiation as needed. Returns 0 with ssl->in_offt still
+ * NULL if the underlying transport was closed without a CloseNotify.
+ */
+static int ssl_read_fetch( mbedtls_ssl_context *ssl )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls & MBEDTLS_SSL_KTLS_RX )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+            return( ret );
+
+        if( ssl->handshake != NULL &&
+            ssl->handshake->retransmit_state == MBEDTLS_SSL_RETRANS_SENDING )
+        {
+            if( ( ret = mbedtls_ssl_flight_transmit( ssl ) ) != 0 )
+                return( ret );
+        }
+    }
+#endif
+
+    /*
+     * Check if renegotiation is necessary and/or handshake is
+     * in process. If yes, perform/continue, and fall through
+     * if an unexpected packet is received while the client
+     * is waiting for the ServerHello.
+     *
+     * (There is no equivalent to the last condition on
+     *  the server-side as it is not treated as within
+     *  a handshake while waiting for the ClientHello
+     *  after a renegotiation request.)
+     */
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    ret = ssl_check_ctr_renegotiate( ssl );
+    if( ret != MBEDTLS_ERR_SSL_WAITING_SERVER_HELLO_RENEGO &&
+        ret != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_check_ctr_renegotiate", ret );
+        return( ret );
+    }
+#endif
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        ret = mbedtls_ssl_handshake( ssl );
+        if( ret != MBEDTLS_ERR_SSL_WAITING_SERVER_HELLO_RENEGO &&
+            ret != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_handshake", ret );
+            return( ret );
+        }
     }
 
     /* Loop as long as no application data record is available */
     while( ssl->in_offt == NULL )
     {
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        /* A renegotiation that just completed may have released the buffers */
+        if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+            return( ret );
+#endif
+
         /* Start timer if not already running */
         if( ssl->f_get_timer != NULL &&
             ssl->f_get_timer( ssl->p_timer ) == -1 )
@@ -5744,10 +6218,14 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
     }
 
-    n = ( len < ssl->in_msglen )
-        ? len : ssl->in_msglen;
+    return( 0 );
+}
 
-    memcpy( buf, ssl->in_offt, n );
+/*
+ * Consume n bytes of the application data available in ssl->in_offt
+ */
+static void ssl_read_consume( mbedtls_ssl_context *ssl, size_t n )
+{
     ssl->in_msglen -= n;
 
     /* Zeroising the plaintext buffer to erase unused application data
@@ -5765,10 +6243,103 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
         /* more data available */
         ssl->in_offt += n;
     }
+}
+
+/*
+ * Receive application data decrypted from the SSL layer
+ */
+int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t n;
+
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
+
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls & MBEDTLS_SSL_KTLS_RX )
+        return( ssl_ktls_read( ssl, buf, len ) );
+#endif
+
+    if( ( ret = ssl_read_fetch( ssl ) ) != 0 )
+        goto exit;
+
+    /* ret is 0 here: the transport was closed without a CloseNotify */
+    if( ssl->in_offt == NULL )
+        goto exit;
+
+    n = ( len < ssl->in_msglen )
+        ? len : ssl->in_msglen;
+
+    memcpy( buf, ssl->in_offt, n );
+    ssl_read_consume( ssl, n );
+    ret = (int) n;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read" ) );
 
-    return( (int) n );
+exit:
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
+    return( ret );
+}
+
+/*
+ * Give access to application data in place, without copying it
+ */
+int mbedtls_ssl_read_record_view( mbedtls_ssl_context *ssl,
+                                  const unsigned char **buf, size_t *len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ssl == NULL || ssl->conf == NULL || buf == NULL || len == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read record view" ) );
+
+    *buf = NULL;
+    *len = 0;
+
+    if( ( ret = ssl_read_fetch( ssl ) ) != 0 )
+        goto exit;
+
+    if( ssl->in_offt != NULL )
+    {
+        *buf = ssl->in_offt;
+        *len = ssl->in_msglen;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read record view" ) );
+
+exit:
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
+    return( ret );
+}
+
+int mbedtls_ssl_read_release( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( len == 0 )
+        return( 0 );
+
+    if( ssl->in_offt == NULL || len > ssl->in_msglen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ssl_read_consume( ssl, len );
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
+    return( 0 );
 }
 
 /*
@@ -5783,6 +6354,67 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
  * Therefore, it is possible that the input message length is 0 and the
  * corresponding return code is 0 on success.
  */
+/*
+ * Seal an application data write that is longer than one record into as
+ * many records as the output queue holds, plus the one in the output buffer,
+ * and send them together through the vectored send callback.
+ *
+ * Returns the number of bytes covered by the records, which may be less than
+ * len, or a negative error code. On MBEDTLS_ERR_SSL_WANT_WRITE, the records
+ * are sealed already: the retried call to ssl_write_real() only flushes them
+ * and returns the number of bytes they cover.
+ */
+static int ssl_write_vec( mbedtls_ssl_context *ssl,
+                          const unsigned char *buf, size_t len,
+                          size_t max_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t written = 0, n;
+
+    for( ;; )
+    {
+        n = len - written < max_len ? len - written : max_len;
+
+        ssl->out_msglen  = n;
+        ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+        memcpy( ssl->out_msg, buf + written, n );
+
+        if( ( ret = mbedtls_ssl_write_record( ssl, SSL_DONT_FORCE_FLUSH ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_write_record", ret );
+            if( written == 0 )
+                return( ret );
+            break;
+        }
+        written += n;
+
+        /* The last record stays in the output buffer. If it cannot be
+         * queued, send what is sealed so far rather than failing: the
+         * records already have their sequence numbers. */
+        if( written == len ||
+            ( ssl->out_queue != NULL &&
+              ssl->out_queue->cnt == MBEDTLS_SSL_OUT_QUEUE_MAX ) ||
+            ssl_out_queue_append( ssl ) != 0 )
+        {
+            break;
+        }
+    }
+
+    if( ssl->out_queue != NULL )
+        ssl->out_queue->app_len = written;
+
+    if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+        return( ret );
+    }
+
+    if( ssl->out_queue != NULL )
+        ssl->out_queue->app_len = 0;
+
+    return( (int) written );
+}
+
 static int ssl_write_real( mbedtls_ssl_context *ssl,
                            const unsigned char *buf, size_t len )
 {
@@ -5808,10 +6440,11 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
         }
         else
 #endif
+        if( ssl->f_send_vec == NULL )
             len = max_len;
     }
 
-    if( ssl->out_left != 0 )
+    if( ssl->out_left != 0 || ssl_out_queue_pending( ssl ) )
     {
         /*
          * The user has previously tried to send the data and
@@ -5824,6 +6457,20 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
             MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
             return( ret );
         }
+
+        /* A coalesced write covers more than one record */
+        if( ssl->out_queue != NULL && ssl->out_queue->app_len != 0 )
+        {
+            len = ssl->out_queue->app_len;
+            ssl->out_queue->app_len = 0;
+        }
+        else if( len > max_len )
+            len = max_len;
+    }
+    else if( len > max_len )
+    {
+        /* Only reached with a vectored send callback over TLS */
+        return( ssl_write_vec( ssl, buf, len, max_len ) );
     }
     else
     {
@@ -5896,6 +6543,16 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls & MBEDTLS_SSL_KTLS_TX )
+        return( ssl_ktls_write( ssl, buf, len ) );
+#endif
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     if( ( ret = ssl_check_ctr_renegotiate( ssl ) ) != 0 )
     {
@@ -5913,17 +6570,282 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
         }
     }
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    /* A handshake that just completed may have released the buffers */
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     ret = ssl_write_split( ssl, buf, len );
 #else
     ret = ssl_write_real( ssl, buf, len );
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write" ) );
 
     return( ret );
 }
 
+/*
+ * Protect a record of application data in the caller's buffer and send it
+ * from there. Only what f_send() does not take right away is copied into
+ * the internal output buffer, to be sent by a later call.
+ */
+static int ssl_write_in_place_real( mbedtls_ssl_context *ssl,
+                                    unsigned char *buf, size_t buf_len,
+                                    size_t headroom, size_t len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t hdr_len = mbedtls_ssl_out_hdr_len( ssl );
+    size_t record_len, sent = 0, remaining;
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t out_buf_len = ssl->out_buf_len;
+#else
+    size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+#endif
+    unsigned char *len_p;
+    mbedtls_record rec;
+
+    if( ssl->out_left != 0 )
+    {
+        /*
+         * The record was protected and partly sent by a previous call that
+         * returned MBEDTLS_ERR_SSL_WANT_WRITE; the rest of it is waiting in
+         * the internal output buffer.
+         */
+        if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+            return( ret );
+        }
+
+        return( (int) len );
+    }
+
+    if( ssl->f_send == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "Bad usage of mbedtls_ssl_set_bio() "
+                            "or mbedtls_ssl_set_bio()" ) );
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    rec.buf         = buf + hdr_len;
+    rec.buf_len     = buf_len - hdr_len;
+    rec.data_len    = len;
+    rec.data_offset = headroom - hdr_len;
+
+    memcpy( &rec.ctr[0], ssl->cur_out_ctr, 8 );
+    mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
+                               ssl->conf->transport, rec.ver );
+    rec.type = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+    /* The CID is set by mbedtls_ssl_encrypt_buf(). */
+    rec.cid_len = 0;
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID */
+
+    if( ( ret = mbedtls_ssl_encrypt_buf( ssl, ssl->transform_out, &rec,
+                                 ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_encrypt_buf", ret );
+        return( ret );
+    }
+
+    if( rec.data_offset != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
+
+    /* Write the record header in the headroom */
+    buf[0] = rec.type;
+    mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
+                               ssl->conf->transport, buf + 1 );
+    len_p = buf + 3;
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        memcpy( buf + 3, ssl->cur_out_ctr, 8 );
+        len_p += 8;
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+        memcpy( len_p, rec.cid, rec.cid_len );
+        len_p += rec.cid_len;
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID */
+    }
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+    len_p[0] = (unsigned char)( rec.data_len >> 8 );
+    len_p[1] = (unsigned char)( rec.data_len      );
+
+    record_len = hdr_len + rec.data_len;
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "output record: msgtype = %u, "
+                                "version = [%u:%u], msglen = %" MBEDTLS_PRINTF_SIZET,
+                                buf[0], buf[1], buf[2], rec.data_len ) );
+
+    MBEDTLS_SSL_DEBUG_BUF( 4, "output record sent to network",
+                           buf, record_len );
+
+    if( ( ret = ssl_increment_out_ctr( ssl ) ) != 0 )
+        return( ret );
+
+    while( sent < record_len )
+    {
+        ret = ssl->f_send( ssl->p_bio, buf + sent, record_len - sent );
+
+        MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send", ret );
+
+        if( ret <= 0 )
+            break;
+
+        if( (size_t)ret > record_len - sent || ( INT_MAX > SIZE_MAX && ret > (int)SIZE_MAX ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1,
+                ( "f_send returned %d bytes but only %" MBEDTLS_PRINTF_SIZET " bytes were sent",
+                ret, record_len - sent ) );
+            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        }
+
+        sent += ret;
+    }
+
+    if( sent < record_len )
+    {
+        /* The caller may reuse its buffer as soon as we return, so keep
+         * the rest of the record for mbedtls_ssl_flush_output() */
+        remaining = record_len - sent;
+        if( remaining > out_buf_len - (size_t)( ssl->out_hdr - ssl->out_buf ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        }
+
+        memcpy( ssl->out_hdr, buf + sent, remaining );
+        ssl->out_left = remaining;
+        ssl->out_hdr += remaining;
+        mbedtls_ssl_update_out_pointers( ssl, ssl->transform_out );
+
+        return( ret );
+    }
+
+    return( (int) len );
+}
+
+/*
+ * Write application data from a caller-owned buffer with room for the
+ * record header and protection (public-facing wrapper)
+ */
+int mbedtls_ssl_write_in_place( mbedtls_ssl_context *ssl, unsigned char *buf,
+                                size_t buf_len, size_t len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t headroom, tailroom, max_len;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write in place" ) );
+
+    if( ssl == NULL || ssl->conf == NULL || buf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls & MBEDTLS_SSL_KTLS_TX )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if( ( ret = ssl_check_ctr_renegotiate( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_check_ctr_renegotiate", ret );
+        return( ret );
+    }
+#endif
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        if( ( ret = mbedtls_ssl_handshake( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_handshake", ret );
+            return( ret );
+        }
+    }
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    /* A handshake that just completed may have released the buffers */
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
+    if( ( ret = mbedtls_ssl_get_record_headroom( ssl ) ) < 0 )
+        return( ret );
+    headroom = (size_t) ret;
+
+    if( ( ret = mbedtls_ssl_get_record_tailroom( ssl ) ) < 0 )
+        return( ret );
+    tailroom = (size_t) ret;
+
+    if( buf_len < headroom || buf_len - headroom < len ||
+        buf_len - headroom - len < tailroom )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "no room for the record header and "
+                                    "protection around the data" ) );
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    if( ( ret = mbedtls_ssl_get_max_out_record_payload( ssl ) ) < 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_get_max_out_record_payload", ret );
+        return( ret );
+    }
+    max_len = (size_t) ret;
+
+    /* The data is already in place, so it can't be split over records */
+    if( len > max_len )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "fragment larger than the (negotiated) "
+                            "maximum fragment length: %" MBEDTLS_PRINTF_SIZET
+                            " > %" MBEDTLS_PRINTF_SIZET,
+                            len, max_len ) );
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    /* Record splitting and hardware record acceleration both work on the
+     * internal buffer: let them have a copy of the data */
+#if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+    if( ssl->conf->cbc_record_splitting ==
+            MBEDTLS_SSL_CBC_RECORD_SPLITTING_ENABLED &&
+        len > 1 &&
+        ssl->minor_ver <= MBEDTLS_SSL_MINOR_VERSION_1 &&
+        mbedtls_cipher_get_cipher_mode( &ssl->transform_out->cipher_ctx_enc )
+                                == MBEDTLS_MODE_CBC )
+    {
+        ret = ssl_write_split( ssl, buf + headroom, len );
+    }
+    else
+#endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+#if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
+    if( mbedtls_ssl_hw_record_write != NULL )
+        ret = ssl_write_real( ssl, buf + headroom, len );
+    else
+#endif /* MBEDTLS_SSL_HW_RECORD_ACCEL */
+        ret = ssl_write_in_place_real( ssl, buf, buf_len, headroom, len );
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write in place" ) );
+
+    return( ret );
+}
+
 /*
  * Notify the peer that the connection is being closed
  */
@@ -5950,6 +6872,10 @@ int mbedtls_ssl_close_notify( mbedtls_ssl_context *ssl )
         }
     }
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write close notify" ) );
 
     return( 0 );
@@ -276,6 +276,17 @@ static int ssl_parse_signature_algorithms_ext( mbedtls_ssl_context *ssl,
 
     for( p = buf + 2; p < end; p += 2 )
     {
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+        if( p[0] == MBEDTLS_SSL_HASH_INTRINSIC &&
+            p[1] == MBEDTLS_SSL_SIG_ED25519 )
+        {
+            ssl->handshake->hash_algs.ed25519 = 1;
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "client hello v3, signature_algorithm ext:"
+                                        " ed25519" ) );
+            continue;
+        }
+#endif
+
         /* Silently ignore unknown signature or hash algorithms. */
 
         if( ( sig_cur = mbedtls_ssl_pk_alg_from_sig( p[1] ) ) == MBEDTLS_PK_NONE )
@@ -922,6 +933,22 @@ static int ssl_check_key_curve( mbedtls_pk_context *pk,
 }
 #endif /* MBEDTLS_ECDSA_C */
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+/*
+ * Return 1 if the Ed25519 key pk may sign for a suite of type pk_alg:
+ * ECDHE_ECDSA suites in TLS 1.2, if the client offered ed25519.
+ */
+static int ssl_can_use_ed25519_cert( const mbedtls_ssl_context *ssl,
+                                     mbedtls_pk_type_t pk_alg,
+                                     const mbedtls_pk_context *pk )
+{
+    return( pk_alg == MBEDTLS_PK_ECDSA &&
+            mbedtls_pk_get_type( pk ) == MBEDTLS_PK_ED25519 &&
+            ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_3 &&
+            ssl->handshake->hash_algs.ed25519 != 0 );
+}
+#endif /* MBEDTLS_SSL_ED25519_ENABLED */
+
 /*
  * Try picking a certificate for this ciphersuite,
  * return 0 on success and -1 on failure.
@@ -933,6 +960,7 @@ static int ssl_pick_cert( mbedtls_ssl_context *ssl,
     mbedtls_pk_type_t pk_alg =
         mbedtls_ssl_get_ciphersuite_sig_pk_alg( ciphersuite_info );
     uint32_t flags;
+    int cert_is_ed25519;
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     if( ssl->handshake->sni_key_cert != NULL )
@@ -958,12 +986,31 @@ static int ssl_pick_cert( mbedtls_ssl_context *ssl,
         MBEDTLS_SSL_DEBUG_CRT( 3, "candidate certificate chain, certificate",
                           cur->cert );
 
-        if( ! mbedtls_pk_can_do( &cur->cert->pk, pk_alg ) )
+        cert_is_ed25519 = 0;
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+        cert_is_ed25519 = ssl_can_use_ed25519_cert( ssl, pk_alg,
+                                                    &cur->cert->pk );
+#endif
+
+        if( ! cert_is_ed25519 &&
+            ! mbedtls_pk_can_do( &cur->cert->pk, pk_alg ) )
         {
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "certificate mismatch: key type" ) );
             continue;
         }
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+        /* The suite may have been accepted for ed25519 alone */
+        if( ! cert_is_ed25519 && pk_alg == MBEDTLS_PK_ECDSA &&
+            ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_3 &&
+            mbedtls_ssl_sig_hash_set_find( &ssl->handshake->hash_algs,
+                                           MBEDTLS_PK_ECDSA ) == MBEDTLS_MD_NONE )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "certificate mismatch: no hash for ecdsa" ) );
+            continue;
+        }
+#endif
+
         /*
          * This avoids sending the client a cert it'll reject based on
          * keyUsage or other extensions.
@@ -981,7 +1028,7 @@ static int ssl_pick_cert( mbedtls_ssl_context *ssl,
         }
 
 #if defined(MBEDTLS_ECDSA_C)
-        if( pk_alg == MBEDTLS_PK_ECDSA &&
+        if( pk_alg == MBEDTLS_PK_ECDSA && ! cert_is_ed25519 &&
             ssl_check_key_curve( &cur->cert->pk, ssl->handshake->curves ) != 0 )
         {
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "certificate mismatch: elliptic curve" ) );
@@ -1113,6 +1160,10 @@ static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl, int suite_id,
     {
         sig_type = mbedtls_ssl_get_ciphersuite_sig_alg( suite_info );
         if( sig_type != MBEDTLS_PK_NONE &&
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+            ! ( sig_type == MBEDTLS_PK_ECDSA &&
+                ssl->handshake->hash_algs.ed25519 != 0 ) &&
+#endif
             mbedtls_ssl_sig_hash_set_find( &ssl->handshake->hash_algs, sig_type ) == MBEDTLS_MD_NONE )
         {
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "ciphersuite mismatch: no suitable hash algorithm "
@@ -3260,6 +3311,96 @@ static int ssl_resume_server_key_exchange( mbedtls_ssl_context *ssl,
 #endif /* defined(MBEDTLS_KEY_EXCHANGE_WITH_SERVER_SIGNATURE_ENABLED) &&
           defined(MBEDTLS_SSL_ASYNC_PRIVATE) */
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+/*
+ * Sign the ServerKeyExchange parameters with Ed25519 (RFC 8422). EdDSA
+ * has no separate hash step: the signature covers the client and server
+ * randoms followed by the parameters themselves.
+ */
+static int ssl_sign_server_key_exchange_ed25519( mbedtls_ssl_context *ssl,
+                                                 const unsigned char *dig_signed,
+                                                 size_t dig_signed_len,
+                                                 size_t *signature_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *data;
+
+    data = mbedtls_calloc( 1, 64 + dig_signed_len );
+    if( data == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    memcpy( data, ssl->handshake->randbytes, 64 );
+    memcpy( data + 64, dig_signed, dig_signed_len );
+
+    ssl->out_msg[ssl->out_msglen++] = MBEDTLS_SSL_HASH_INTRINSIC;
+    ssl->out_msg[ssl->out_msglen++] = MBEDTLS_SSL_SIG_ED25519;
+
+    /* As in the general case, leave 2 bytes for the signature length */
+    ret = mbedtls_pk_sign( mbedtls_ssl_own_key( ssl ), MBEDTLS_MD_NONE,
+                           data, 64 + dig_signed_len,
+                           ssl->out_msg + ssl->out_msglen + 2,
+                           signature_len,
+                           ssl->conf->f_rng, ssl->conf->p_rng );
+    mbedtls_free( data );
+
+    if( ret != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_pk_sign", ret );
+        return( ret );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_ED25519_ENABLED */
+
+#if defined(MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED)
+/*
+ * Write the ServerECDHParams from a key pair handed out by the
+ * f_get_ecdhe_key callback, if there is one. Returns
+ * MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if the key pair has to be
+ * generated as usual.
+ */
+static int ssl_use_pooled_ecdhe_key( mbedtls_ssl_context *ssl,
+                                     mbedtls_ecp_group_id grp_id,
+                                     size_t *len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecp_keypair key;
+
+    if( ssl->conf->f_get_ecdhe_key == NULL )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    mbedtls_ecp_keypair_init( &key );
+
+    if( ssl->conf->f_get_ecdhe_key( ssl->conf->p_ecdhe_key,
+                                    grp_id, &key ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+        goto cleanup;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "using a pre-generated ECDHE key" ) );
+
+    if( ( ret = mbedtls_ecdh_get_params( &ssl->handshake->ecdh_ctx, &key,
+                                         MBEDTLS_ECDH_OURS ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ecdh_get_params", ret );
+        goto cleanup;
+    }
+
+    ret = mbedtls_ecdh_write_params( &ssl->handshake->ecdh_ctx, len,
+                                     ssl->out_msg + ssl->out_msglen,
+                                     MBEDTLS_SSL_OUT_CONTENT_LEN -
+                                     ssl->out_msglen );
+    if( ret != 0 && ret != MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE )
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ecdh_write_params", ret );
+
+cleanup:
+    mbedtls_ecp_keypair_free( &key );
+    return( ret );
+}
+#endif /* MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED */
+
 /* Prepare the ServerKeyExchange message, up to and including
  * calculating the signature if any, but excluding formatting the
  * signature and sending the message. */
@@ -3424,14 +3565,21 @@ curve_matching_done:
             return( ret );
         }
 
-        if( ( ret = mbedtls_ecdh_make_params(
-                  &ssl->handshake->ecdh_ctx, &len,
-                  ssl->out_msg + ssl->out_msglen,
-                  MBEDTLS_SSL_OUT_CONTENT_LEN - ssl->out_msglen,
-                  ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
+        if( ( ret = ssl_use_pooled_ecdhe_key( ssl, (*curve)->grp_id,
+                                              &len ) ) != 0 )
         {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ecdh_make_params", ret );
-            return( ret );
+            if( ret != MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE )
+                return( ret );
+
+            if( ( ret = mbedtls_ecdh_make_params(
+                      &ssl->handshake->ecdh_ctx, &len,
+                      ssl->out_msg + ssl->out_msglen,
+                      MBEDTLS_SSL_OUT_CONTENT_LEN - ssl->out_msglen,
+                      ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ecdh_make_params", ret );
+                return( ret );
+            }
         }
 
 #if defined(MBEDTLS_KEY_EXCHANGE_WITH_SERVER_SIGNATURE_ENABLED)
@@ -3459,6 +3607,17 @@ curve_matching_done:
         unsigned char hash[MBEDTLS_MD_MAX_SIZE];
         int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
 
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+        if( mbedtls_ssl_own_key( ssl ) != NULL &&
+            mbedtls_pk_get_type( mbedtls_ssl_own_key( ssl ) ) ==
+                MBEDTLS_PK_ED25519 )
+        {
+            return( ssl_sign_server_key_exchange_ed25519( ssl, dig_signed,
+                                                          dig_signed_len,
+                                                          signature_len ) );
+        }
+#endif
+
         /*
          * 2.1: Choose hash algorithm:
          * A: For TLS 1.2, obey signature-hash-algorithm extension
@@ -4662,7 +4821,12 @@ int mbedtls_ssl_handshake_server_step( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "server state: %d", ssl->state ) );
 
-    if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+    /* Records held back for a vectored send are only flushed at the end of
+     * the handshake, or when reading the peer's next flight. */
+    if( ( ssl->out_left != 0 ||
+          ssl->state == MBEDTLS_SSL_FLUSH_BUFFERS ||
+          ssl->state == MBEDTLS_SSL_HANDSHAKE_WRAPUP ) &&
+        ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
         return( ret );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -36,6 +36,13 @@
 
 #include <string.h>
 
+#if defined(MBEDTLS_THREADING_THREADS) && defined(MBEDTLS_HAVE_TIME)
+/* Values of mbedtls_ssl_ticket_context::thread_state */
+#define TICKET_THREAD_NONE          0   /* no thread to join            */
+#define TICKET_THREAD_RUNNING       1   /* rotating                     */
+#define TICKET_THREAD_DONE          2   /* finished, not joined yet     */
+#endif
+
 /*
  * Initialze context
  */
@@ -48,9 +55,9 @@ void mbedtls_ssl_ticket_init( mbedtls_ssl_ticket_context *ctx )
 #endif
 }
 
-#define MAX_KEY_BYTES 32    /* 256 bits */
+#define MAX_KEY_BYTES MBEDTLS_SSL_TICKET_MAX_KEY_BYTES
 
-#define TICKET_KEY_NAME_BYTES    4
+#define TICKET_KEY_NAME_BYTES   MBEDTLS_SSL_TICKET_KEY_NAME_BYTES
 #define TICKET_IV_BYTES         12
 #define TICKET_CRYPT_LEN_BYTES   2
 #define TICKET_AUTH_TAG_BYTES   16
@@ -64,14 +71,14 @@ void mbedtls_ssl_ticket_init( mbedtls_ssl_ticket_context *ctx )
                               TICKET_CRYPT_LEN_BYTES )
 
 /*
- * Generate/update a key
+ * Generate a key
  */
 static int ssl_ticket_gen_key( mbedtls_ssl_ticket_context *ctx,
-                               unsigned char index )
+                               mbedtls_ssl_ticket_key *key )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    unsigned char buf[MAX_KEY_BYTES];
-    mbedtls_ssl_ticket_key *key = ctx->keys + index;
+
+    memset( key, 0, sizeof( mbedtls_ssl_ticket_key ) );
 
 #if defined(MBEDTLS_HAVE_TIME)
     key->generation_time = (uint32_t) mbedtls_time( NULL );
@@ -80,45 +87,507 @@ static int ssl_ticket_gen_key( mbedtls_ssl_ticket_context *ctx,
     if( ( ret = ctx->f_rng( ctx->p_rng, key->name, sizeof( key->name ) ) ) != 0 )
         return( ret );
 
-    if( ( ret = ctx->f_rng( ctx->p_rng, buf, sizeof( buf ) ) ) != 0 )
+    return( ctx->f_rng( ctx->p_rng, key->key,
+                        ctx->cipher_info->key_bitlen / 8 ) );
+}
+
+/*
+ * Prepare a cipher context for protecting or checking tickets with a key.
+ *
+ * Cipher contexts hold per-operation state, so they are not shared between
+ * the threads using a key set: each operation takes one from the pool of
+ * its key, see ssl_ticket_cipher_get().
+ */
+static int ssl_ticket_cipher_setup( const mbedtls_ssl_ticket_context *ctx,
+                                    const mbedtls_ssl_ticket_key *key,
+                                    mbedtls_cipher_context_t *cipher )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+#if defined(MBEDTLS_USE_PSA_CRYPTO)
+    ret = mbedtls_cipher_setup_psa( cipher, ctx->cipher_info,
+                                    TICKET_AUTH_TAG_BYTES );
+    if( ret != 0 && ret != MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
+        return( ret );
+    /* We don't yet expect to support all ciphers through PSA,
+     * so allow fallback to ordinary mbedtls_cipher_setup(). */
+    if( ret == MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
+#endif /* MBEDTLS_USE_PSA_CRYPTO */
+    if( ( ret = mbedtls_cipher_setup( cipher, ctx->cipher_info ) ) != 0 )
         return( ret );
 
     /* With GCM and CCM, same context can encrypt & decrypt */
-    ret = mbedtls_cipher_setkey( &key->ctx, buf,
-                                 mbedtls_cipher_get_key_bitlen( &key->ctx ),
-                                 MBEDTLS_ENCRYPT );
+    return( mbedtls_cipher_setkey( cipher, key->key,
+                                   ctx->cipher_info->key_bitlen,
+                                   MBEDTLS_ENCRYPT ) );
+}
+
+static void ssl_ticket_cipher_free( mbedtls_cipher_context_t *cipher )
+{
+    if( cipher == NULL )
+        return;
+
+    mbedtls_cipher_free( cipher );
+    mbedtls_free( cipher );
+}
+
+/*
+ * Drop a reference to a key set, and free it with the last one.
+ * Must be called with the context's mutex held.
+ */
+static void ssl_ticket_unref_keys( mbedtls_ssl_ticket_key_set *keys )
+{
+    size_t i, j;
+
+    if( --keys->refs != 0 )
+        return;
+
+    for( i = 0; i < MBEDTLS_SSL_TICKET_MAX_KEYS; i++ )
+    {
+        for( j = 0; j < keys->cipher_count[i]; j++ )
+            ssl_ticket_cipher_free( keys->ciphers[i][j] );
+    }
+
+    mbedtls_platform_zeroize( keys, sizeof( mbedtls_ssl_ticket_key_set ) );
+    mbedtls_free( keys );
+}
+
+/*
+ * Take a reference to the current key set.
+ *
+ * Key sets are immutable, so the mutex is only held while taking and
+ * dropping references, not while tickets are protected or checked.
+ */
+static int ssl_ticket_get_keys( mbedtls_ssl_ticket_context *ctx,
+                                mbedtls_ssl_ticket_key_set **keys )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#endif
 
-    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+    *keys = ctx->keys;
+    if( *keys != NULL )
+        (*keys)->refs++;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    /* Not set up */
+    if( *keys == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    return( 0 );
+}
+
+/*
+ * Release a reference taken with ssl_ticket_get_keys()
+ */
+static int ssl_ticket_put_keys( mbedtls_ssl_ticket_context *ctx,
+                                mbedtls_ssl_ticket_key_set *keys )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#else
+    ((void) ctx);
+#endif
+
+    ssl_ticket_unref_keys( keys );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( 0 );
+}
+
+/*
+ * Take a cipher context set up with key i of a key set we hold a reference
+ * to, from the pool of the key, or set up a new one if the pool is empty.
+ */
+static int ssl_ticket_cipher_get( mbedtls_ssl_ticket_context *ctx,
+                                  mbedtls_ssl_ticket_key_set *keys, size_t i,
+                                  mbedtls_cipher_context_t **cipher )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    *cipher = NULL;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( keys->cipher_count[i] > 0 )
+        *cipher = keys->ciphers[i][--keys->cipher_count[i]];
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+    {
+        ssl_ticket_cipher_free( *cipher );
+        *cipher = NULL;
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+    }
+#endif
+
+    if( *cipher != NULL )
+        return( 0 );
+
+    /* Set up outside of the critical section */
+    *cipher = mbedtls_calloc( 1, sizeof( mbedtls_cipher_context_t ) );
+    if( *cipher == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    mbedtls_cipher_init( *cipher );
+
+    if( ( ret = ssl_ticket_cipher_setup( ctx, &keys->keys[i], *cipher ) ) != 0 )
+    {
+        ssl_ticket_cipher_free( *cipher );
+        *cipher = NULL;
+        return( ret );
+    }
+
+    return( 0 );
+}
+
+/*
+ * Give a cipher context taken with ssl_ticket_cipher_get() back to the pool
+ * of its key, or free it if the pool is full.
+ */
+static int ssl_ticket_cipher_put( mbedtls_ssl_ticket_context *ctx,
+                                  mbedtls_ssl_ticket_key_set *keys, size_t i,
+                                  mbedtls_cipher_context_t *cipher )
+{
+#if defined(MBEDTLS_THREADING_C)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+#endif
+
+    if( cipher == NULL )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+    {
+        ssl_ticket_cipher_free( cipher );
+        return( ret );
+    }
+#else
+    ((void) ctx);
+#endif
+
+    if( keys->cipher_count[i] < MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE )
+    {
+        keys->ciphers[i][keys->cipher_count[i]++] = cipher;
+        cipher = NULL;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+    {
+        ssl_ticket_cipher_free( cipher );
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+    }
+#endif
+
+    ssl_ticket_cipher_free( cipher );
+
+    return( 0 );
+}
+
+/*
+ * Publish a new key set, made of a new active key followed by the keys of
+ * the current set that may still be needed to parse tickets.
+ *
+ * If expected is not NULL, the new key is only published if the current
+ * set is still the expected one, so that the threads that notice an
+ * expired key at the same time rotate it only once.
+ */
+static int ssl_ticket_publish_key( mbedtls_ssl_ticket_context *ctx,
+                                   const mbedtls_ssl_ticket_key *key,
+                                   const mbedtls_ssl_ticket_key_set *expected )
+{
+    int ret = 0;
+    mbedtls_ssl_ticket_key_set *keys, *old;
+    size_t i;
+
+    /* Allocate outside of the critical section */
+    keys = mbedtls_calloc( 1, sizeof( mbedtls_ssl_ticket_key_set ) );
+    if( keys == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    keys->keys[0] = *key;
+    keys->count = 1;
+    keys->refs = 1;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+    {
+        ssl_ticket_unref_keys( keys );
+        return( ret );
+    }
+#endif
+
+    old = ctx->keys;
+
+    if( expected != NULL && old != expected )
+    {
+        /* Another thread rotated the keys in the meantime */
+        ssl_ticket_unref_keys( keys );
+        goto exit;
+    }
+
+    if( old != NULL )
+    {
+        for( i = 0; i < old->count &&
+                    keys->count < MBEDTLS_SSL_TICKET_MAX_KEYS; i++ )
+        {
+#if defined(MBEDTLS_HAVE_TIME)
+            /* A key stopped protecting new tickets when the next one was
+             * generated. Once the tickets it protected have expired, it is
+             * only a threat to forward secrecy: drop it, as well as the
+             * older keys. */
+            uint32_t superseded = i == 0 ? key->generation_time
+                                         : old->keys[i - 1].generation_time;
+
+            if( ctx->ticket_lifetime != 0 &&
+                key->generation_time >= superseded &&
+                key->generation_time - superseded > ctx->ticket_lifetime )
+            {
+                break;
+            }
+#endif
+
+            /* A key pushed again replaces its previous copy */
+            if( memcmp( old->keys[i].name, key->name,
+                        TICKET_KEY_NAME_BYTES ) == 0 )
+            {
+                continue;
+            }
+
+            /* The prepared cipher contexts move along with the key. Those
+             * in use are given back to the old set, and freed with it. */
+            memcpy( keys->ciphers[keys->count], old->ciphers[i],
+                    sizeof( old->ciphers[i] ) );
+            keys->cipher_count[keys->count] = old->cipher_count[i];
+            old->cipher_count[i] = 0;
+
+            keys->keys[keys->count++] = old->keys[i];
+        }
+
+        ssl_ticket_unref_keys( old );
+    }
+
+    ctx->keys = keys;
+
+exit:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
 
     return( ret );
 }
 
+#if defined(MBEDTLS_HAVE_TIME)
+/*
+ * Whether the active key of a set is max_age seconds old or more, or was
+ * generated in the future according to the clock
+ */
+static int ssl_ticket_key_is_old( const mbedtls_ssl_ticket_key_set *keys,
+                                  uint32_t max_age )
+{
+    uint32_t current_time = (uint32_t) mbedtls_time( NULL );
+    uint32_t key_time = keys->keys[0].generation_time;
+
+    return( current_time < key_time || current_time - key_time >= max_age );
+}
+
+/*
+ * Rotate the keys if the active one is max_age seconds old or more,
+ * replacing *keys with a reference to the new set.
+ */
+static int ssl_ticket_rotate_old_key( mbedtls_ssl_ticket_context *ctx,
+                                      mbedtls_ssl_ticket_key_set **keys,
+                                      uint32_t max_age )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ssl_ticket_key key;
+
+    if( ! ssl_ticket_key_is_old( *keys, max_age ) )
+        return( 0 );
+
+    if( ( ret = ssl_ticket_gen_key( ctx, &key ) ) == 0 )
+        ret = ssl_ticket_publish_key( ctx, &key, *keys );
+
+    mbedtls_platform_zeroize( &key, sizeof( key ) );
+
+    if( ret != 0 )
+        return( ret );
+
+    ret = ssl_ticket_put_keys( ctx, *keys );
+    *keys = NULL;
+    if( ret != 0 )
+        return( ret );
+
+    return( ssl_ticket_get_keys( ctx, keys ) );
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+#if defined(MBEDTLS_THREADING_THREADS) && defined(MBEDTLS_HAVE_TIME)
+static void ssl_ticket_rotation_thread( void *arg )
+{
+    mbedtls_ssl_ticket_context *ctx = (mbedtls_ssl_ticket_context *) arg;
+    mbedtls_ssl_ticket_key_set *keys;
+
+    /* Serve the requests made while rotating, so that none is lost
+     * between the last rotation and the end of the thread */
+    for( ;; )
+    {
+        if( mbedtls_mutex_lock( &ctx->mutex ) != 0 )
+            return;
+
+        if( ctx->rotation_pending == 0 )
+        {
+            ctx->thread_state = TICKET_THREAD_DONE;
+            (void) mbedtls_mutex_unlock( &ctx->mutex );
+            return;
+        }
+
+        ctx->rotation_pending = 0;
+
+        if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+            return;
+
+        /* Requests pile up until the new key is published: rotate once.
+         * On failure, the next request starts over. */
+        if( ssl_ticket_get_keys( ctx, &keys ) != 0 )
+            continue;
+
+        (void) ssl_ticket_rotate_old_key( ctx, &keys,
+                                          ctx->ticket_lifetime / 2 );
+
+        if( keys != NULL )
+            (void) ssl_ticket_put_keys( ctx, keys );
+    }
+}
+
+/*
+ * Request a background rotation, starting a thread unless one is running.
+ * Must be called with the context's mutex held.
+ */
+static int ssl_ticket_request_rotation( mbedtls_ssl_ticket_context *ctx )
+{
+    int ret;
+
+    ctx->rotation_pending = 1;
+
+    if( ctx->thread_state == TICKET_THREAD_RUNNING )
+        return( 0 );
+
+    /* The previous thread is past its last use of the mutex */
+    if( ctx->thread_state == TICKET_THREAD_DONE )
+    {
+        (void) mbedtls_thread_join( &ctx->thread );
+        ctx->thread_state = TICKET_THREAD_NONE;
+    }
+
+    if( ( ret = mbedtls_thread_create( &ctx->thread,
+                                       ssl_ticket_rotation_thread,
+                                       ctx ) ) != 0 )
+        return( ret );
+
+    ctx->thread_state = TICKET_THREAD_RUNNING;
+
+    return( 0 );
+}
+
+int mbedtls_ssl_ticket_start_rotation( mbedtls_ssl_ticket_context *ctx )
+{
+    int ret;
+
+    /* Not set up, or keys that never expire */
+    if( ctx == NULL || ctx->cipher_info == NULL || ctx->f_rng == NULL ||
+        ctx->ticket_lifetime == 0 )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+
+    ctx->background = 1;
+
+    if( ( ret = ssl_ticket_request_rotation( ctx ) ) != 0 )
+        ctx->background = 0;
+
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( ret );
+}
+
+void mbedtls_ssl_ticket_stop_rotation( mbedtls_ssl_ticket_context *ctx )
+{
+    int state;
+
+    if( mbedtls_mutex_lock( &ctx->mutex ) != 0 )
+        return;
+
+    /* From now on, no thread is started nor joined by anyone else */
+    ctx->background = 0;
+    state = ctx->thread_state;
+
+    (void) mbedtls_mutex_unlock( &ctx->mutex );
+
+    if( state != TICKET_THREAD_NONE )
+        (void) mbedtls_thread_join( &ctx->thread );
+
+    ctx->thread_state = TICKET_THREAD_NONE;
+    ctx->rotation_pending = 0;
+}
+#endif /* MBEDTLS_THREADING_THREADS && MBEDTLS_HAVE_TIME */
+
 /*
- * Rotate/generate keys if necessary
+ * Rotate the keys if the active one is too old, replacing *keys with a
+ * reference to the new set. This is the fallback for applications that do
+ * not call mbedtls_ssl_ticket_rotate() often enough.
  */
-static int ssl_ticket_update_keys( mbedtls_ssl_ticket_context *ctx )
+static int ssl_ticket_update_keys( mbedtls_ssl_ticket_context *ctx,
+                                   mbedtls_ssl_ticket_key_set **keys )
 {
 #if !defined(MBEDTLS_HAVE_TIME)
     ((void) ctx);
+    ((void) keys);
 #else
     if( ctx->ticket_lifetime != 0 )
     {
-        uint32_t current_time = (uint32_t) mbedtls_time( NULL );
-        uint32_t key_time = ctx->keys[ctx->active].generation_time;
-
-        if( current_time >= key_time &&
-            current_time - key_time < ctx->ticket_lifetime )
+#if defined(MBEDTLS_THREADING_THREADS)
+        /* Have the key replaced in the background well before it expires.
+         * If the thread can't be started, the fallback below remains. */
+        if( ssl_ticket_key_is_old( *keys, ctx->ticket_lifetime / 2 ) &&
+            mbedtls_mutex_lock( &ctx->mutex ) == 0 )
         {
-            return( 0 );
-        }
+            if( ctx->background )
+                (void) ssl_ticket_request_rotation( ctx );
 
-        ctx->active = 1 - ctx->active;
+            if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+                return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+        }
+#endif
 
-        return( ssl_ticket_gen_key( ctx, ctx->active ) );
+        return( ssl_ticket_rotate_old_key( ctx, keys, ctx->ticket_lifetime ) );
     }
-    else
 #endif /* MBEDTLS_HAVE_TIME */
-        return( 0 );
+
+    return( 0 );
 }
 
 /*
@@ -131,6 +600,8 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     const mbedtls_cipher_info_t *cipher_info;
+    mbedtls_ssl_ticket_key key;
+    mbedtls_cipher_context_t cipher_ctx;
 
     ctx->f_rng = f_rng;
     ctx->p_rng = p_rng;
@@ -150,35 +621,74 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
     if( cipher_info->key_bitlen > 8 * MAX_KEY_BYTES )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-#if defined(MBEDTLS_USE_PSA_CRYPTO)
-    ret = mbedtls_cipher_setup_psa( &ctx->keys[0].ctx,
-                                    cipher_info, TICKET_AUTH_TAG_BYTES );
-    if( ret != 0 && ret != MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
-        return( ret );
-    /* We don't yet expect to support all ciphers through PSA,
-     * so allow fallback to ordinary mbedtls_cipher_setup(). */
-    if( ret == MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
-#endif /* MBEDTLS_USE_PSA_CRYPTO */
-    if( ( ret = mbedtls_cipher_setup( &ctx->keys[0].ctx, cipher_info ) ) != 0 )
-        return( ret );
+    ctx->cipher_info = cipher_info;
 
-#if defined(MBEDTLS_USE_PSA_CRYPTO)
-    ret = mbedtls_cipher_setup_psa( &ctx->keys[1].ctx,
-                                    cipher_info, TICKET_AUTH_TAG_BYTES );
-    if( ret != 0 && ret != MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
-        return( ret );
-    if( ret == MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE )
-#endif /* MBEDTLS_USE_PSA_CRYPTO */
-    if( ( ret = mbedtls_cipher_setup( &ctx->keys[1].ctx, cipher_info ) ) != 0 )
-        return( ret );
+    if( ctx->keys != NULL )
+    {
+        ssl_ticket_unref_keys( ctx->keys );
+        ctx->keys = NULL;
+    }
+
+    mbedtls_cipher_init( &cipher_ctx );
 
-    if( ( ret = ssl_ticket_gen_key( ctx, 0 ) ) != 0 ||
-        ( ret = ssl_ticket_gen_key( ctx, 1 ) ) != 0 )
+    /* Check that the cipher can be set up before publishing the key */
+    if( ( ret = ssl_ticket_gen_key( ctx, &key ) ) == 0 &&
+        ( ret = ssl_ticket_cipher_setup( ctx, &key, &cipher_ctx ) ) == 0 )
     {
-        return( ret );
+        ret = ssl_ticket_publish_key( ctx, &key, NULL );
     }
 
-    return( 0 );
+    mbedtls_cipher_free( &cipher_ctx );
+    mbedtls_platform_zeroize( &key, sizeof( key ) );
+
+    return( ret );
+}
+
+/*
+ * Make a new key active
+ */
+int mbedtls_ssl_ticket_rotate( mbedtls_ssl_ticket_context *ctx,
+                               const unsigned char *name, size_t nlength,
+                               const unsigned char *k, size_t klength )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ssl_ticket_key key;
+
+    /* Not set up */
+    if( ctx == NULL || ctx->cipher_info == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( name == NULL && k == NULL )
+    {
+        if( ctx->f_rng == NULL )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+        ret = ssl_ticket_gen_key( ctx, &key );
+    }
+    else
+    {
+        if( name == NULL || k == NULL ||
+            nlength != TICKET_KEY_NAME_BYTES ||
+            klength < ctx->cipher_info->key_bitlen / 8 )
+        {
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+        }
+
+        memset( &key, 0, sizeof( key ) );
+        memcpy( key.name, name, TICKET_KEY_NAME_BYTES );
+        memcpy( key.key, k, ctx->cipher_info->key_bitlen / 8 );
+#if defined(MBEDTLS_HAVE_TIME)
+        key.generation_time = (uint32_t) mbedtls_time( NULL );
+#endif
+        ret = 0;
+    }
+
+    if( ret == 0 )
+        ret = ssl_ticket_publish_key( ctx, &key, NULL );
+
+    mbedtls_platform_zeroize( &key, sizeof( key ) );
+
+    return( ret );
 }
 
 /*
@@ -204,7 +714,9 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_ssl_ticket_context *ctx = p_ticket;
+    mbedtls_ssl_ticket_key_set *keys = NULL;
     mbedtls_ssl_ticket_key *key;
+    mbedtls_cipher_context_t *cipher = NULL;
     unsigned char *key_name = start;
     unsigned char *iv = start + TICKET_KEY_NAME_BYTES;
     unsigned char *state_len_bytes = iv + TICKET_IV_BYTES;
@@ -220,15 +732,13 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
      * in addition to session itself, that will be checked when writing it. */
     MBEDTLS_SSL_CHK_BUF_PTR( start, end, TICKET_MIN_LEN );
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+    if( ( ret = ssl_ticket_get_keys( ctx, &keys ) ) != 0 )
         return( ret );
-#endif
 
-    if( ( ret = ssl_ticket_update_keys( ctx ) ) != 0 )
+    if( ( ret = ssl_ticket_update_keys( ctx, &keys ) ) != 0 )
         goto cleanup;
 
-    key = &ctx->keys[ctx->active];
+    key = &keys->keys[0];
 
     *ticket_lifetime = ctx->ticket_lifetime;
 
@@ -249,7 +759,10 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
     state_len_bytes[1] = ( clear_len      ) & 0xff;
 
     /* Encrypt and authenticate */
-    if( ( ret = mbedtls_cipher_auth_encrypt_ext( &key->ctx,
+    if( ( ret = ssl_ticket_cipher_get( ctx, keys, 0, &cipher ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_cipher_auth_encrypt_ext( cipher,
                     iv, TICKET_IV_BYTES,
                     /* Additional data: key name, IV and length */
                     key_name, TICKET_ADD_DATA_LEN,
@@ -268,10 +781,14 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
     *tlen = TICKET_MIN_LEN + ciph_len - TICKET_AUTH_TAG_BYTES;
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
+    if( keys != NULL )
+    {
+        int put_ret = ssl_ticket_cipher_put( ctx, keys, 0, cipher );
+        if( put_ret == 0 )
+            put_ret = ssl_ticket_put_keys( ctx, keys );
+        if( put_ret != 0 )
+            return( put_ret );
+    }
 
     return( ret );
 }
@@ -280,14 +797,14 @@ cleanup:
  * Select key based on name
  */
 static mbedtls_ssl_ticket_key *ssl_ticket_select_key(
-        mbedtls_ssl_ticket_context *ctx,
+        mbedtls_ssl_ticket_key_set *keys,
         const unsigned char name[4] )
 {
-    unsigned char i;
+    size_t i;
 
-    for( i = 0; i < sizeof( ctx->keys ) / sizeof( *ctx->keys ); i++ )
-        if( memcmp( name, ctx->keys[i].name, 4 ) == 0 )
-            return( &ctx->keys[i] );
+    for( i = 0; i < keys->count; i++ )
+        if( memcmp( name, keys->keys[i].name, 4 ) == 0 )
+            return( &keys->keys[i] );
 
     return( NULL );
 }
@@ -302,7 +819,10 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_ssl_ticket_context *ctx = p_ticket;
+    mbedtls_ssl_ticket_key_set *keys = NULL;
     mbedtls_ssl_ticket_key *key;
+    mbedtls_cipher_context_t *cipher = NULL;
+    size_t key_index = 0;
     unsigned char *key_name = buf;
     unsigned char *iv = buf + TICKET_KEY_NAME_BYTES;
     unsigned char *enc_len_p = iv + TICKET_IV_BYTES;
@@ -315,12 +835,10 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     if( len < TICKET_MIN_LEN )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+    if( ( ret = ssl_ticket_get_keys( ctx, &keys ) ) != 0 )
         return( ret );
-#endif
 
-    if( ( ret = ssl_ticket_update_keys( ctx ) ) != 0 )
+    if( ( ret = ssl_ticket_update_keys( ctx, &keys ) ) != 0 )
         goto cleanup;
 
     enc_len = ( enc_len_p[0] << 8 ) | enc_len_p[1];
@@ -332,7 +850,7 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     }
 
     /* Select key */
-    if( ( key = ssl_ticket_select_key( ctx, key_name ) ) == NULL )
+    if( ( key = ssl_ticket_select_key( keys, key_name ) ) == NULL )
     {
         /* We can't know for sure but this is a likely option unless we're
          * under attack - this is only informative anyway */
@@ -341,7 +859,11 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     }
 
     /* Decrypt and authenticate */
-    if( ( ret = mbedtls_cipher_auth_decrypt_ext( &key->ctx,
+    key_index = key - keys->keys;
+    if( ( ret = ssl_ticket_cipher_get( ctx, keys, key_index, &cipher ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_cipher_auth_decrypt_ext( cipher,
                     iv, TICKET_IV_BYTES,
                     /* Additional data: key name, IV and length */
                     key_name, TICKET_ADD_DATA_LEN,
@@ -379,10 +901,14 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
 #endif
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
+    if( keys != NULL )
+    {
+        int put_ret = ssl_ticket_cipher_put( ctx, keys, key_index, cipher );
+        if( put_ret == 0 )
+            put_ret = ssl_ticket_put_keys( ctx, keys );
+        if( put_ret != 0 )
+            return( put_ret );
+    }
 
     return( ret );
 }
@@ -392,8 +918,12 @@ cleanup:
  */
 void mbedtls_ssl_ticket_free( mbedtls_ssl_ticket_context *ctx )
 {
-    mbedtls_cipher_free( &ctx->keys[0].ctx );
-    mbedtls_cipher_free( &ctx->keys[1].ctx );
+#if defined(MBEDTLS_THREADING_THREADS) && defined(MBEDTLS_HAVE_TIME)
+    mbedtls_ssl_ticket_stop_rotation( ctx );
+#endif
+
+    if( ctx->keys != NULL )
+        ssl_ticket_unref_keys( ctx->keys );
 
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_free( &ctx->mutex );
@@ -274,7 +274,8 @@ static void handle_buffer_resizing( mbedtls_ssl_context *ssl, int downsizing,
         iv_offset_in = ssl->in_iv - ssl->in_buf;
         len_offset_in = ssl->in_len - ssl->in_buf;
         if( downsizing ?
-            ssl->in_buf_len > in_buf_new_len && ssl->in_left < in_buf_new_len :
+            ssl->in_buf_len > in_buf_new_len &&
+            (size_t)( ssl->in_hdr - ssl->in_buf ) + ssl->in_left < in_buf_new_len :
             ssl->in_buf_len < in_buf_new_len )
         {
             if( resize_buffer( &ssl->in_buf, in_buf_new_len, &ssl->in_buf_len ) != 0 )
@@ -328,6 +329,249 @@ static void handle_buffer_resizing( mbedtls_ssl_context *ssl, int downsizing,
 }
 #endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+/*
+ * Buffers kept in a pool are linked through their first bytes
+ */
+typedef struct ssl_pool_node
+{
+    struct ssl_pool_node *next;
+    size_t len;
+}
+ssl_pool_node;
+
+static unsigned char *ssl_buffer_get( mbedtls_ssl_buffer_pool *pool,
+                                      size_t len )
+{
+    ssl_pool_node **prev;
+    ssl_pool_node *node = NULL;
+
+    if( pool == NULL )
+        return( mbedtls_calloc( 1, len ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( mbedtls_calloc( 1, len ) );
+#endif
+
+    for( prev = (ssl_pool_node **) &pool->free_list; *prev != NULL;
+         prev = &(*prev)->next )
+    {
+        if( (*prev)->len == len )
+        {
+            node = *prev;
+            *prev = node->next;
+            pool->free_count--;
+            break;
+        }
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &pool->mutex );
+#endif
+
+    if( node == NULL )
+        return( mbedtls_calloc( 1, len ) );
+
+    /* Buffers are zeroized when put in the pool, except for the link */
+    memset( node, 0, sizeof( ssl_pool_node ) );
+
+    return( (unsigned char *) node );
+}
+
+static void ssl_buffer_put( mbedtls_ssl_buffer_pool *pool,
+                            unsigned char *buf, size_t len )
+{
+    ssl_pool_node *node = (ssl_pool_node *) buf;
+
+    mbedtls_platform_zeroize( buf, len );
+
+    if( pool == NULL )
+    {
+        mbedtls_free( buf );
+        return;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+    {
+        mbedtls_free( buf );
+        return;
+    }
+#endif
+
+    if( pool->free_count < pool->max_free )
+    {
+        node->next = pool->free_list;
+        node->len = len;
+        pool->free_list = node;
+        pool->free_count++;
+        buf = NULL;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &pool->mutex );
+#endif
+
+    mbedtls_free( buf );
+}
+
+/*
+ * Take back the record buffers that were given to the pool, if any
+ */
+int mbedtls_ssl_buffers_acquire( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_buf_len = ssl->in_buf_len;
+    size_t out_buf_len = ssl->out_buf_len;
+#else
+    size_t in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN;
+    size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+#endif
+
+    if( ssl->in_buf == NULL )
+    {
+        ssl->in_buf = ssl_buffer_get( ssl->conf->buffer_pool, in_buf_len );
+        if( ssl->in_buf == NULL )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%" MBEDTLS_PRINTF_SIZET " bytes) failed", in_buf_len ) );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "input buffer taken from the pool" ) );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+            ssl->in_hdr = ssl->in_buf;
+        else
+#endif
+            ssl->in_hdr = ssl->in_buf + 8;
+        mbedtls_ssl_update_in_pointers( ssl );
+
+        memcpy( ssl->in_ctr, ssl->in_ctr_idle, 8 );
+    }
+
+    if( ssl->out_buf == NULL )
+    {
+        ssl->out_buf = ssl_buffer_get( ssl->conf->buffer_pool, out_buf_len );
+        if( ssl->out_buf == NULL )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%" MBEDTLS_PRINTF_SIZET " bytes) failed", out_buf_len ) );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "output buffer taken from the pool" ) );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+            ssl->out_hdr = ssl->out_buf;
+        else
+#endif
+            ssl->out_hdr = ssl->out_buf + 8;
+        mbedtls_ssl_update_out_pointers( ssl, ssl->transform_out );
+    }
+
+    return( 0 );
+}
+
+/*
+ * Give the record buffers to the pool if no data is pending in them
+ */
+void mbedtls_ssl_buffers_release_idle( mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_buffer_pool *pool = ssl->conf->buffer_pool;
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_buf_len = ssl->in_buf_len;
+    size_t out_buf_len = ssl->out_buf_len;
+#else
+    size_t in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN;
+    size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+#endif
+
+    if( pool == NULL )
+        return;
+
+    /* The handshake keeps state in the buffers between steps, except
+     * before it sends or receives its first message */
+    if( ssl->handshake != NULL && ssl->state != MBEDTLS_SSL_HELLO_REQUEST )
+        return;
+
+    if( ssl->in_buf != NULL &&
+        ssl->in_left == ssl->next_record_offset &&
+        mbedtls_ssl_check_pending( ssl ) == 0 )
+    {
+        /* For TLS, the incoming record counter lives in the buffer */
+        memcpy( ssl->in_ctr_idle, ssl->in_ctr, 8 );
+
+        ssl_buffer_put( pool, ssl->in_buf, in_buf_len );
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "input buffer given to the pool" ) );
+
+        ssl->in_buf = NULL;
+        ssl->in_left = 0;
+        ssl->next_record_offset = 0;
+
+        ssl->in_hdr = NULL;
+        ssl->in_ctr = NULL;
+        ssl->in_len = NULL;
+        ssl->in_iv = NULL;
+        ssl->in_msg = NULL;
+    }
+
+    if( ssl->out_buf != NULL && ssl->out_left == 0 )
+    {
+        ssl_buffer_put( pool, ssl->out_buf, out_buf_len );
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "output buffer given to the pool" ) );
+
+        ssl->out_buf = NULL;
+
+        ssl->out_hdr = NULL;
+        ssl->out_ctr = NULL;
+        ssl->out_len = NULL;
+        ssl->out_iv = NULL;
+        ssl->out_msg = NULL;
+    }
+}
+
+void mbedtls_ssl_buffer_pool_init( mbedtls_ssl_buffer_pool *pool )
+{
+    memset( pool, 0, sizeof( mbedtls_ssl_buffer_pool ) );
+
+    pool->max_free = MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &pool->mutex );
+#endif
+}
+
+void mbedtls_ssl_buffer_pool_set_max_free( mbedtls_ssl_buffer_pool *pool,
+                                           size_t max_free )
+{
+    pool->max_free = max_free;
+}
+
+void mbedtls_ssl_buffer_pool_free( mbedtls_ssl_buffer_pool *pool )
+{
+    ssl_pool_node *node, *next;
+
+    if( pool == NULL )
+        return;
+
+    for( node = pool->free_list; node != NULL; node = next )
+    {
+        next = node->next;
+        mbedtls_free( node );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &pool->mutex );
+#endif
+
+    mbedtls_platform_zeroize( pool, sizeof( mbedtls_ssl_buffer_pool ) );
+}
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 /*
  * Key material generation
  */
@@ -1391,6 +1635,15 @@ static int ssl_populate_transform( mbedtls_ssl_transform *transform,
         goto end;
     }
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( keylen <= sizeof( transform->key_enc ) )
+    {
+        memcpy( transform->key_enc, key1, keylen );
+        memcpy( transform->key_dec, key2, keylen );
+        transform->keylen = keylen;
+    }
+#endif /* MBEDTLS_SSL_KTLS */
+
 #if defined(MBEDTLS_CIPHER_MODE_CBC)
     if( cipher_info->mode == MBEDTLS_MODE_CBC )
     {
@@ -3858,7 +4111,11 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
     ssl->in_buf_len = in_buf_len;
 #endif
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    ssl->in_buf = ssl_buffer_get( conf->buffer_pool, in_buf_len );
+#else
     ssl->in_buf = mbedtls_calloc( 1, in_buf_len );
+#endif
     if( ssl->in_buf == NULL )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%" MBEDTLS_PRINTF_SIZET " bytes) failed", in_buf_len ) );
@@ -3869,7 +4126,11 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
     ssl->out_buf_len = out_buf_len;
 #endif
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    ssl->out_buf = ssl_buffer_get( conf->buffer_pool, out_buf_len );
+#else
     ssl->out_buf = mbedtls_calloc( 1, out_buf_len );
+#endif
     if( ssl->out_buf == NULL )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%" MBEDTLS_PRINTF_SIZET " bytes) failed", out_buf_len ) );
@@ -3886,6 +4147,10 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
     if( ( ret = ssl_handshake_init( ssl ) ) != 0 )
         goto error;
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
     return( 0 );
 
 error:
@@ -3939,6 +4204,11 @@ int mbedtls_ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     ((void) partial);
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( ( ret = mbedtls_ssl_buffers_acquire( ssl ) ) != 0 )
+        return( ret );
+#endif
+
     ssl->state = MBEDTLS_SSL_HELLO_REQUEST;
 
     /* Cancel any possibly running timer */
@@ -3959,8 +4229,8 @@ int mbedtls_ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
 
     ssl->in_msgtype = 0;
     ssl->in_msglen = 0;
-#if defined(MBEDTLS_SSL_PROTO_DTLS)
     ssl->next_record_offset = 0;
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
     ssl->in_epoch = 0;
 #endif
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
@@ -3975,10 +4245,14 @@ int mbedtls_ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     ssl->out_msgtype = 0;
     ssl->out_msglen = 0;
     ssl->out_left = 0;
+    mbedtls_ssl_out_queue_free( ssl );
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     if( ssl->split_done != MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED )
         ssl->split_done = 0;
 #endif
+#if defined(MBEDTLS_SSL_KTLS)
+    ssl->ktls = 0;
+#endif
 
     memset( ssl->cur_out_ctr, 0, sizeof( ssl->cur_out_ctr ) );
 
@@ -4042,6 +4316,10 @@ int mbedtls_ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     if( ( ret = ssl_handshake_init( ssl ) ) != 0 )
         return( ret );
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
     return( 0 );
 }
 
@@ -4140,6 +4418,12 @@ void mbedtls_ssl_set_bio( mbedtls_ssl_context *ssl,
     ssl->f_recv_timeout = f_recv_timeout;
 }
 
+void mbedtls_ssl_set_bio_vec( mbedtls_ssl_context *ssl,
+        mbedtls_ssl_send_vec_t *f_send_vec )
+{
+    ssl->f_send_vec     = f_send_vec;
+}
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 void mbedtls_ssl_set_mtu( mbedtls_ssl_context *ssl, uint16_t mtu )
 {
@@ -4175,6 +4459,17 @@ void mbedtls_ssl_conf_session_cache( mbedtls_ssl_config *conf,
     conf->f_get_cache = f_get_cache;
     conf->f_set_cache = f_set_cache;
 }
+
+#if defined(MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED)
+void mbedtls_ssl_conf_ecdhe_key_cb( mbedtls_ssl_config *conf,
+        int (*f_get_ecdhe_key)(void *, mbedtls_ecp_group_id,
+                               mbedtls_ecp_keypair *),
+        void *p_ecdhe_key )
+{
+    conf->f_get_ecdhe_key = f_get_ecdhe_key;
+    conf->p_ecdhe_key     = p_ecdhe_key;
+}
+#endif /* MBEDTLS_KEY_EXCHANGE_SOME_ECDHE_ENABLED */
 #endif /* MBEDTLS_SSL_SRV_C */
 
 #if defined(MBEDTLS_SSL_CLI_C)
@@ -4867,6 +5162,19 @@ void mbedtls_ssl_conf_cbc_record_splitting( mbedtls_ssl_config *conf, char split
 }
 #endif
 
+void mbedtls_ssl_conf_read_ahead( mbedtls_ssl_config *conf, char read_ahead )
+{
+    conf->read_ahead = read_ahead;
+}
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+void mbedtls_ssl_conf_buffer_pool( mbedtls_ssl_config *conf,
+                                   mbedtls_ssl_buffer_pool *pool )
+{
+    conf->buffer_pool = pool;
+}
+#endif
+
 void mbedtls_ssl_conf_legacy_renegotiation( mbedtls_ssl_config *conf, int allow_legacy )
 {
     conf->allow_legacy_renegotiation = allow_legacy;
@@ -5768,6 +6076,11 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( mbedtls_ssl_buffers_acquire( ssl ) != 0 )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+#endif
+
 #if defined(MBEDTLS_SSL_CLI_C)
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT )
         ret = mbedtls_ssl_handshake_client_step( ssl );
@@ -5777,6 +6090,10 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
         ret = mbedtls_ssl_handshake_server_step( ssl );
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffers_release_idle( ssl );
+#endif
+
     return( ret );
 }
 
@@ -5860,6 +6177,12 @@ int mbedtls_ssl_start_renegotiation( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> renegotiate" ) );
 
+#if defined(MBEDTLS_SSL_KTLS)
+    /* The transport only protects application data */
+    if( ssl->ktls != 0 )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
+
     if( ( ret = ssl_handshake_init( ssl ) ) != 0 )
         return( ret );
 
@@ -5901,6 +6224,16 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( ssl->ktls != 0 )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( mbedtls_ssl_buffers_acquire( ssl ) != 0 )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+#endif
+
 #if defined(MBEDTLS_SSL_SRV_C)
     /* On server, just send the request */
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_SERVER )
@@ -6733,7 +7066,18 @@ int mbedtls_ssl_context_load( mbedtls_ssl_context *context,
                               const unsigned char *buf,
                               size_t len )
 {
-    int ret = ssl_context_load( context, buf, len );
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    /* Loading sets up the record pointers for the restored transform */
+    if( ( ret = mbedtls_ssl_buffers_acquire( context ) ) != 0 )
+    {
+        mbedtls_ssl_free( context );
+        return( ret );
+    }
+#endif
+
+    ret = ssl_context_load( context, buf, len );
 
     if( ret != 0 )
         mbedtls_ssl_free( context );
@@ -6752,6 +7096,8 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> free" ) );
 
+    mbedtls_ssl_out_queue_free( ssl );
+
     if( ssl->out_buf != NULL )
     {
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
@@ -6760,8 +7106,12 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
         size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        ssl_buffer_put( ssl->conf->buffer_pool, ssl->out_buf, out_buf_len );
+#else
         mbedtls_platform_zeroize( ssl->out_buf, out_buf_len );
         mbedtls_free( ssl->out_buf );
+#endif
         ssl->out_buf = NULL;
     }
 
@@ -6773,8 +7123,12 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
         size_t in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN;
 #endif
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        ssl_buffer_put( ssl->conf->buffer_pool, ssl->in_buf, in_buf_len );
+#else
         mbedtls_platform_zeroize( ssl->in_buf, in_buf_len );
         mbedtls_free( ssl->in_buf );
+#endif
         ssl->in_buf = NULL;
     }
 
@@ -7180,6 +7534,10 @@ void mbedtls_ssl_sig_hash_set_const_hash( mbedtls_ssl_sig_hash_set_t *set,
 {
     set->rsa   = md_alg;
     set->ecdsa = md_alg;
+#if defined(MBEDTLS_SSL_ED25519_ENABLED)
+    /* Never implied by the absence of the extension (RFC 8422) */
+    set->ed25519 = 0;
+#endif
 }
 
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2) &&
@@ -112,6 +112,48 @@ void (*mbedtls_mutex_free)( mbedtls_threading_mutex_t * ) = threading_mutex_free
 int (*mbedtls_mutex_lock)( mbedtls_threading_mutex_t * ) = threading_mutex_lock_pthread;
 int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t * ) = threading_mutex_unlock_pthread;
 
+#if defined(MBEDTLS_THREADING_THREADS)
+static void *threading_thread_start_pthread( void *arg )
+{
+    mbedtls_threading_thread_t *thread = (mbedtls_threading_thread_t *) arg;
+
+    thread->func( thread->arg );
+
+    return( NULL );
+}
+
+static int threading_thread_create_pthread( mbedtls_threading_thread_t *thread,
+                                            void (*func)( void * ), void *arg )
+{
+    if( thread == NULL || func == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    thread->func = func;
+    thread->arg = arg;
+
+    if( pthread_create( &thread->thread, NULL,
+                        threading_thread_start_pthread, thread ) != 0 )
+        return( MBEDTLS_ERR_THREADING_THREAD_ERROR );
+
+    return( 0 );
+}
+
+static int threading_thread_join_pthread( mbedtls_threading_thread_t *thread )
+{
+    if( thread == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( pthread_join( thread->thread, NULL ) != 0 )
+        return( MBEDTLS_ERR_THREADING_THREAD_ERROR );
+
+    return( 0 );
+}
+
+int (*mbedtls_thread_create)( mbedtls_threading_thread_t *,
+                              void (*)( void * ), void * ) = threading_thread_create_pthread;
+int (*mbedtls_thread_join)( mbedtls_threading_thread_t * ) = threading_thread_join_pthread;
+#endif /* MBEDTLS_THREADING_THREADS */
+
 /*
  * With phtreads we can statically initialize mutexes
  */
@@ -152,6 +194,9 @@ void mbedtls_threading_set_alt( void (*mutex_init)( mbedtls_threading_mutex_t *
 #if defined(MBEDTLS_FS_IO)
     mbedtls_mutex_init( &mbedtls_threading_readdir_mutex );
 #endif
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    mbedtls_mutex_init( &mbedtls_threading_ecp_tables_mutex );
+#endif
 #if defined(THREADING_USE_GMTIME)
     mbedtls_mutex_init( &mbedtls_threading_gmtime_mutex );
 #endif
@@ -165,10 +210,45 @@ void mbedtls_threading_free_alt( void )
 #if defined(MBEDTLS_FS_IO)
     mbedtls_mutex_free( &mbedtls_threading_readdir_mutex );
 #endif
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    mbedtls_mutex_free( &mbedtls_threading_ecp_tables_mutex );
+#endif
 #if defined(THREADING_USE_GMTIME)
     mbedtls_mutex_free( &mbedtls_threading_gmtime_mutex );
 #endif
 }
+
+#if defined(MBEDTLS_THREADING_THREADS)
+static int threading_thread_create_fail( mbedtls_threading_thread_t *thread,
+                                         void (*func)( void * ), void *arg )
+{
+    ((void) thread );
+    ((void) func );
+    ((void) arg );
+    return( MBEDTLS_ERR_THREADING_THREAD_ERROR );
+}
+static int threading_thread_join_fail( mbedtls_threading_thread_t *thread )
+{
+    ((void) thread );
+    return( MBEDTLS_ERR_THREADING_THREAD_ERROR );
+}
+
+int (*mbedtls_thread_create)( mbedtls_threading_thread_t *,
+                              void (*)( void * ), void * ) = threading_thread_create_fail;
+int (*mbedtls_thread_join)( mbedtls_threading_thread_t * ) = threading_thread_join_fail;
+
+/*
+ * Set thread function pointers
+ */
+void mbedtls_threading_set_thread_alt( int (*thread_create)( mbedtls_threading_thread_t *,
+                                                             void (*)( void * ),
+                                                             void * ),
+                                       int (*thread_join)( mbedtls_threading_thread_t * ) )
+{
+    mbedtls_thread_create = thread_create;
+    mbedtls_thread_join = thread_join;
+}
+#endif /* MBEDTLS_THREADING_THREADS */
 #endif /* MBEDTLS_THREADING_ALT */
 
 /*
@@ -180,6 +260,9 @@ void mbedtls_threading_free_alt( void )
 #if defined(MBEDTLS_FS_IO)
 mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex MUTEX_INIT;
 #endif
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+mbedtls_threading_mutex_t mbedtls_threading_ecp_tables_mutex MUTEX_INIT;
+#endif
 #if defined(THREADING_USE_GMTIME)
 mbedtls_threading_mutex_t mbedtls_threading_gmtime_mutex MUTEX_INIT;
 #endif
@@ -357,6 +357,12 @@ static const char * const features[] = {
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     "MBEDTLS_ECP_RESTARTABLE",
 #endif /* MBEDTLS_ECP_RESTARTABLE */
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    "MBEDTLS_ECP_SHARED_TABLES",
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    "MBEDTLS_ECP_PUBKEY_TABLES",
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
 #if defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     "MBEDTLS_ECDH_LEGACY_CONTEXT",
 #endif /* MBEDTLS_ECDH_LEGACY_CONTEXT */
@@ -456,6 +462,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_RSA_NO_CRT)
     "MBEDTLS_RSA_NO_CRT",
 #endif /* MBEDTLS_RSA_NO_CRT */
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS)
+    "MBEDTLS_RSA_PRIVATE_THREADS",
+#endif /* MBEDTLS_RSA_PRIVATE_THREADS */
 #if defined(MBEDTLS_SELF_TEST)
     "MBEDTLS_SELF_TEST",
 #endif /* MBEDTLS_SELF_TEST */
@@ -558,6 +567,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_SSL_EXPORT_KEYS)
     "MBEDTLS_SSL_EXPORT_KEYS",
 #endif /* MBEDTLS_SSL_EXPORT_KEYS */
+#if defined(MBEDTLS_SSL_KTLS)
+    "MBEDTLS_SSL_KTLS",
+#endif /* MBEDTLS_SSL_KTLS */
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     "MBEDTLS_SSL_SERVER_NAME_INDICATION",
 #endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
@@ -570,6 +582,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
     "MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH",
 #endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    "MBEDTLS_SSL_BUFFER_POOL",
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
 #if defined(MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN)
     "MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN",
 #endif /* MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN */
@@ -585,6 +600,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_THREADING_PTHREAD)
     "MBEDTLS_THREADING_PTHREAD",
 #endif /* MBEDTLS_THREADING_PTHREAD */
+#if defined(MBEDTLS_THREADING_THREADS)
+    "MBEDTLS_THREADING_THREADS",
+#endif /* MBEDTLS_THREADING_THREADS */
 #if defined(MBEDTLS_USE_PSA_CRYPTO)
     "MBEDTLS_USE_PSA_CRYPTO",
 #endif /* MBEDTLS_USE_PSA_CRYPTO */
@@ -687,6 +705,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_ECP_C)
     "MBEDTLS_ECP_C",
 #endif /* MBEDTLS_ECP_C */
+#if defined(MBEDTLS_ED25519_C)
+    "MBEDTLS_ED25519_C",
+#endif /* MBEDTLS_ED25519_C */
 #if defined(MBEDTLS_ENTROPY_C)
     "MBEDTLS_ENTROPY_C",
 #endif /* MBEDTLS_ENTROPY_C */
@@ -789,9 +810,15 @@ static const char * const features[] = {
 #if defined(MBEDTLS_SSL_CACHE_C)
     "MBEDTLS_SSL_CACHE_C",
 #endif /* MBEDTLS_SSL_CACHE_C */
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    "MBEDTLS_SSL_CACHE_SHM_C",
+#endif /* MBEDTLS_SSL_CACHE_SHM_C */
 #if defined(MBEDTLS_SSL_COOKIE_C)
     "MBEDTLS_SSL_COOKIE_C",
 #endif /* MBEDTLS_SSL_COOKIE_C */
+#if defined(MBEDTLS_SSL_KEY_POOL_C)
+    "MBEDTLS_SSL_KEY_POOL_C",
+#endif /* MBEDTLS_SSL_KEY_POOL_C */
 #if defined(MBEDTLS_SSL_TICKET_C)
     "MBEDTLS_SSL_TICKET_C",
 #endif /* MBEDTLS_SSL_TICKET_C */
@@ -693,6 +693,10 @@ int mbedtls_x509_get_sig_alg( const mbedtls_x509_buf *sig_oid, const mbedtls_x50
         if( ( sig_params->tag != MBEDTLS_ASN1_NULL && sig_params->tag != 0 ) ||
               sig_params->len != 0 )
         return( MBEDTLS_ERR_X509_INVALID_ALG );
+
+        /* RFC 8410 requires them to be absent for Ed25519 */
+        if( *pk_alg == MBEDTLS_PK_ED25519 && sig_params->tag != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_ALG );
     }
 
     return( 0 );
@@ -159,10 +159,17 @@ const mbedtls_x509_crt_profile mbedtls_x509_crt_profile_suiteb =
 /*
  * Check md_alg against profile
  * Return 0 if md_alg is acceptable for this profile, -1 otherwise
+ *
+ * Ed25519 hashes with SHA-512 internally and has no separate md_alg, so
+ * only the profile's pk_alg setting applies to it.
  */
 static int x509_profile_check_md_alg( const mbedtls_x509_crt_profile *profile,
-                                      mbedtls_md_type_t md_alg )
+                                      mbedtls_md_type_t md_alg,
+                                      mbedtls_pk_type_t pk_alg )
 {
+    if( pk_alg == MBEDTLS_PK_ED25519 )
+        return( 0 );
+
     if( md_alg == MBEDTLS_MD_NONE )
         return( -1 );
 
@@ -224,6 +231,12 @@ static int x509_profile_check_key( const mbedtls_x509_crt_profile *profile,
     }
 #endif
 
+#if defined(MBEDTLS_ED25519_C)
+    /* A single key size, at the 128-bit security level */
+    if( pk_alg == MBEDTLS_PK_ED25519 )
+        return( 0 );
+#endif
+
     return( -1 );
 }
 
@@ -2345,6 +2358,8 @@ static int x509_crt_verifycrl( mbedtls_x509_crt *crt, mbedtls_x509_crt *ca,
     int flags = 0;
     unsigned char hash[MBEDTLS_MD_MAX_SIZE];
     const mbedtls_md_info_t *md_info;
+    const unsigned char *signed_data;
+    size_t signed_len;
 
     if( ca == NULL )
         return( flags );
@@ -2373,25 +2388,39 @@ static int x509_crt_verifycrl( mbedtls_x509_crt *crt, mbedtls_x509_crt *ca,
         /*
          * Check if CRL is correctly signed by the trusted CA
          */
-        if( x509_profile_check_md_alg( profile, crl_list->sig_md ) != 0 )
+        if( x509_profile_check_md_alg( profile, crl_list->sig_md,
+                                       crl_list->sig_pk ) != 0 )
             flags |= MBEDTLS_X509_BADCRL_BAD_MD;
 
         if( x509_profile_check_pk_alg( profile, crl_list->sig_pk ) != 0 )
             flags |= MBEDTLS_X509_BADCRL_BAD_PK;
 
-        md_info = mbedtls_md_info_from_type( crl_list->sig_md );
-        if( mbedtls_md( md_info, crl_list->tbs.p, crl_list->tbs.len, hash ) != 0 )
+        if( crl_list->sig_pk == MBEDTLS_PK_ED25519 )
         {
-            /* Note: this can't happen except after an internal error */
-            flags |= MBEDTLS_X509_BADCRL_NOT_TRUSTED;
-            break;
+            /* Ed25519 signs the TBS data itself */
+            signed_data = crl_list->tbs.p;
+            signed_len = crl_list->tbs.len;
+        }
+        else
+        {
+            md_info = mbedtls_md_info_from_type( crl_list->sig_md );
+            if( mbedtls_md( md_info, crl_list->tbs.p, crl_list->tbs.len,
+                            hash ) != 0 )
+            {
+                /* Note: this can't happen except after an internal error */
+                flags |= MBEDTLS_X509_BADCRL_NOT_TRUSTED;
+                break;
+            }
+
+            signed_data = hash;
+            signed_len = mbedtls_md_get_size( md_info );
         }
 
         if( x509_profile_check_key( profile, &ca->pk ) != 0 )
             flags |= MBEDTLS_X509_BADCERT_BAD_KEY;
 
         if( mbedtls_pk_verify_ext( crl_list->sig_pk, crl_list->sig_opts, &ca->pk,
-                           crl_list->sig_md, hash, mbedtls_md_get_size( md_info ),
+                           crl_list->sig_md, signed_data, signed_len,
                            crl_list->sig.p, crl_list->sig.len ) != 0 )
         {
             flags |= MBEDTLS_X509_BADCRL_NOT_TRUSTED;
@@ -2434,6 +2463,22 @@ static int x509_crt_check_signature( const mbedtls_x509_crt *child,
     size_t hash_len;
 #if !defined(MBEDTLS_USE_PSA_CRYPTO)
     const mbedtls_md_info_t *md_info;
+#endif
+
+#if defined(MBEDTLS_ED25519_C)
+    /* Ed25519 signs the TBS data itself rather than a hash of it */
+    if( child->sig_pk == MBEDTLS_PK_ED25519 )
+    {
+        if( ! mbedtls_pk_can_do( &parent->pk, child->sig_pk ) )
+            return( -1 );
+
+        return( mbedtls_pk_verify_ext( child->sig_pk, child->sig_opts,
+                    &parent->pk, MBEDTLS_MD_NONE, child->tbs.p, child->tbs.len,
+                    child->sig.p, child->sig.len ) );
+    }
+#endif /* MBEDTLS_ED25519_C */
+
+#if !defined(MBEDTLS_USE_PSA_CRYPTO)
     md_info = mbedtls_md_info_from_type( child->sig_md );
     hash_len = mbedtls_md_get_size( md_info );
 
@@ -2878,7 +2923,8 @@ static int x509_crt_verify_chain(
             return( 0 );
 
         /* Check signature algorithm: MD & PK algs */
-        if( x509_profile_check_md_alg( profile, child->sig_md ) != 0 )
+        if( x509_profile_check_md_alg( profile, child->sig_md,
+                                       child->sig_pk ) != 0 )
             *flags |= MBEDTLS_X509_BADCERT_BAD_MD;
 
         if( x509_profile_check_pk_alg( profile, child->sig_pk ) != 0 )
@@ -50,6 +50,10 @@ int main( void )
 #define DFL_NBIO                0
 #define DFL_EVENT               0
 #define DFL_READ_TIMEOUT        0
+#define DFL_READ_AHEAD          -1
+#define DFL_SEND_VEC            0
+#define DFL_KTLS                0
+#define DFL_BUFFER_POOL         0
 #define DFL_MAX_RESEND          0
 #define DFL_CA_FILE             ""
 #define DFL_CA_PATH             ""
@@ -282,6 +286,22 @@ int main( void )
 #define USAGE_CURVES ""
 #endif
 
+#if defined(MBEDTLS_SSL_KTLS)
+#define USAGE_KTLS \
+    "    ktls=0/1            default: 0 (records protected in user space)\n" \
+    "                        1: offload to the kernel after the handshake\n"
+#else
+#define USAGE_KTLS ""
+#endif /* MBEDTLS_SSL_KTLS */
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+#define USAGE_BUFFER_POOL \
+    "    buffer_pool=0/1     default: 0 (keep buffers for the whole connection)\n" \
+    "                        1: give them back to a pool when idle\n"
+#else
+#define USAGE_BUFFER_POOL ""
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 #define USAGE_DTLS \
     "    dtls=%%d             default: 0 (TLS)\n"                           \
@@ -376,6 +396,10 @@ int main( void )
     "    event=%%d            default: 0 (loop)\n"                            \
     "                        options: 1 (level-triggered, implies nbio=1),\n" \
     "    read_timeout=%%d     default: 0 ms (no timeout)\n"        \
+    "    read_ahead=0/1      default: (library default: off)\n"    \
+    "    send_vec=0/1        default: 0 (send each record separately)\n" \
+    USAGE_KTLS                                              \
+    USAGE_BUFFER_POOL                                       \
     "    max_resend=%%d       default: 0 (no resend on timeout)\n" \
     "    skip_close_notify=%%d default: 0 (send close_notify)\n" \
     "\n"                                                    \
@@ -450,6 +474,10 @@ struct options
     int nbio;                   /* should I/O be blocking?                  */
     int event;                  /* loop or event-driven IO? level or edge triggered? */
     uint32_t read_timeout;      /* timeout on mbedtls_ssl_read() in milliseconds     */
+    int read_ahead;             /* read past the current record (TLS)?      */
+    int send_vec;               /* send handshake flights with writev()?   */
+    int ktls;                   /* offload records to the kernel?           */
+    int buffer_pool;            /* release buffers of idle connections?     */
     int max_resend;             /* DTLS times to resend on read timeout     */
     const char *request_page;   /* page on server to request                */
     int request_size;           /* pad request with header to requested size */
@@ -689,6 +717,9 @@ int main( int argc, char *argv[] )
     rng_context_t rng;
     mbedtls_ssl_context ssl;
     mbedtls_ssl_config conf;
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool buffer_pool;
+#endif
     mbedtls_ssl_session saved_session;
     unsigned char *session_data = NULL;
     size_t session_data_len = 0;
@@ -744,6 +775,9 @@ int main( int argc, char *argv[] )
     mbedtls_net_init( &server_fd );
     mbedtls_ssl_init( &ssl );
     mbedtls_ssl_config_init( &conf );
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool_init( &buffer_pool );
+#endif
     memset( &saved_session, 0, sizeof( mbedtls_ssl_session ) );
     rng_init( &rng );
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
@@ -806,6 +840,10 @@ int main( int argc, char *argv[] )
     opt.event               = DFL_EVENT;
     opt.context_crt_cb      = DFL_CONTEXT_CRT_CB;
     opt.read_timeout        = DFL_READ_TIMEOUT;
+    opt.read_ahead          = DFL_READ_AHEAD;
+    opt.send_vec            = DFL_SEND_VEC;
+    opt.ktls                = DFL_KTLS;
+    opt.buffer_pool         = DFL_BUFFER_POOL;
     opt.max_resend          = DFL_MAX_RESEND;
     opt.request_page        = DFL_REQUEST_PAGE;
     opt.request_size        = DFL_REQUEST_SIZE;
@@ -915,6 +953,34 @@ int main( int argc, char *argv[] )
         }
         else if( strcmp( p, "read_timeout" ) == 0 )
             opt.read_timeout = atoi( q );
+        else if( strcmp( p, "read_ahead" ) == 0 )
+        {
+            opt.read_ahead = atoi( q );
+            if( opt.read_ahead < 0 || opt.read_ahead > 1 )
+                goto usage;
+        }
+        else if( strcmp( p, "send_vec" ) == 0 )
+        {
+            opt.send_vec = atoi( q );
+            if( opt.send_vec < 0 || opt.send_vec > 1 )
+                goto usage;
+        }
+#if defined(MBEDTLS_SSL_KTLS)
+        else if( strcmp( p, "ktls" ) == 0 )
+        {
+            opt.ktls = atoi( q );
+            if( opt.ktls < 0 || opt.ktls > 1 )
+                goto usage;
+        }
+#endif
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        else if( strcmp( p, "buffer_pool" ) == 0 )
+        {
+            opt.buffer_pool = atoi( q );
+            if( opt.buffer_pool < 0 || opt.buffer_pool > 1 )
+                goto usage;
+        }
+#endif
         else if( strcmp( p, "max_resend" ) == 0 )
         {
             opt.max_resend = atoi( q );
@@ -1893,6 +1959,16 @@ int main( int argc, char *argv[] )
 
     mbedtls_ssl_conf_read_timeout( &conf, opt.read_timeout );
 
+    if( opt.read_ahead != DFL_READ_AHEAD )
+        mbedtls_ssl_conf_read_ahead( &conf, opt.read_ahead
+                                     ? MBEDTLS_SSL_READ_AHEAD_ENABLED
+                                     : MBEDTLS_SSL_READ_AHEAD_DISABLED );
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( opt.buffer_pool != 0 )
+        mbedtls_ssl_conf_buffer_pool( &conf, &buffer_pool );
+#endif
+
 #if defined(MBEDTLS_SSL_SESSION_TICKETS)
     mbedtls_ssl_conf_session_tickets( &conf, opt.tickets );
 #endif
@@ -2032,8 +2108,13 @@ int main( int argc, char *argv[] )
 
     io_ctx.ssl = &ssl;
     io_ctx.net = &server_fd;
+#if defined(MBEDTLS_SSL_KTLS)
+    io_ctx.ktls_rx = 0;
+#endif
     mbedtls_ssl_set_bio( &ssl, &io_ctx, send_cb, recv_cb,
                          opt.nbio == 0 ? recv_timeout_cb : NULL );
+    if( opt.send_vec != 0 )
+        mbedtls_ssl_set_bio_vec( &ssl, send_vec_cb );
 
 #if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
     if( opt.transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
@@ -2154,6 +2235,16 @@ int main( int argc, char *argv[] )
     }
 #endif
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( opt.ktls != 0 )
+    {
+        int offloaded = ktls_offload( &io_ctx );
+        mbedtls_printf( "    [ Kernel TLS offload: tx %s, rx %s ]\n",
+                        ( offloaded & MBEDTLS_SSL_KTLS_TX ) ? "on" : "off",
+                        ( offloaded & MBEDTLS_SSL_KTLS_RX ) ? "on" : "off" );
+    }
+#endif
+
 #if defined(MBEDTLS_SSL_EXPORT_KEYS)
     if( opt.eap_tls != 0  )
     {
@@ -2689,6 +2780,10 @@ send_request:
             goto exit;
         }
 
+#if defined(MBEDTLS_SSL_KTLS)
+        io_ctx.ktls_rx = 0;
+#endif
+
         while( ( ret = mbedtls_ssl_handshake( &ssl ) ) != 0 )
         {
             if( ret != MBEDTLS_ERR_SSL_WANT_READ &&
@@ -2925,6 +3020,10 @@ reconnect:
             goto exit;
         }
 
+#if defined(MBEDTLS_SSL_KTLS)
+        io_ctx.ktls_rx = 0;
+#endif
+
         if( opt.reco_mode == 1 )
         {
             if( ( ret = mbedtls_ssl_session_load( &saved_session,
@@ -3030,6 +3129,9 @@ exit:
     mbedtls_ssl_session_free( &saved_session );
     mbedtls_ssl_free( &ssl );
     mbedtls_ssl_config_free( &conf );
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool_free( &buffer_pool );
+#endif
     rng_free( &rng );
     if( session_data != NULL )
         mbedtls_platform_zeroize( session_data, session_data_len );
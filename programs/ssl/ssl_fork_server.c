@@ -70,6 +70,9 @@ int main( void )
 #include "mbedtls/ssl.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/timing.h"
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+#include "mbedtls/ssl_cache_shm.h"
+#endif
 
 #include <string.h>
 #include <signal.h>
@@ -85,6 +88,13 @@ int main( void )
 
 #define DEBUG_LEVEL 0
 
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+/* Session cache shared by the processes handling the clients */
+#define CACHE_FILE      "ssl_fork_server.cache"
+#define CACHE_SLOTS     1024
+#define CACHE_SLOT_SIZE 512
+#endif
+
 
 static void my_debug( void *ctx, int level,
                       const char *file, int line,
@@ -110,6 +120,9 @@ int main( void )
     mbedtls_ssl_config conf;
     mbedtls_x509_crt srvcert;
     mbedtls_pk_context pkey;
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_context cache;
+#endif
 
     mbedtls_net_init( &listen_fd );
     mbedtls_net_init( &client_fd );
@@ -119,6 +132,9 @@ int main( void )
     mbedtls_pk_init( &pkey );
     mbedtls_x509_crt_init( &srvcert );
     mbedtls_ctr_drbg_init( &ctr_drbg );
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_init( &cache );
+#endif
 
     signal( SIGCHLD, SIG_IGN );
 
@@ -200,6 +216,25 @@ int main( void )
         goto exit;
     }
 
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    /* Set up before forking, so that every child resumes the sessions
+     * established by the others. Start from a new file: one left by an
+     * earlier run may have another geometry, and its workers may still be
+     * using it. */
+    (void) remove( CACHE_FILE );
+
+    if( ( ret = mbedtls_ssl_cache_shm_setup( &cache, CACHE_FILE, CACHE_SLOTS,
+                                             CACHE_SLOT_SIZE ) ) != 0 )
+    {
+        mbedtls_printf( " failed!  mbedtls_ssl_cache_shm_setup returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_ssl_conf_session_cache( &conf, &cache,
+                                    mbedtls_ssl_cache_shm_get,
+                                    mbedtls_ssl_cache_shm_set );
+#endif
+
     mbedtls_printf( " ok\n" );
 
     /*
@@ -407,6 +442,9 @@ exit:
     mbedtls_pk_free( &pkey );
     mbedtls_ssl_free( &ssl );
     mbedtls_ssl_config_free( &conf );
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_free( &cache );
+#endif
     mbedtls_ctr_drbg_free( &ctr_drbg );
     mbedtls_entropy_free( &entropy );
 
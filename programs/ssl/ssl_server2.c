@@ -74,6 +74,10 @@ int main( void )
 #define DFL_NBIO                0
 #define DFL_EVENT               0
 #define DFL_READ_TIMEOUT        0
+#define DFL_READ_AHEAD          -1
+#define DFL_SEND_VEC            0
+#define DFL_KTLS                0
+#define DFL_BUFFER_POOL         0
 #define DFL_CA_FILE             ""
 #define DFL_CA_PATH             ""
 #define DFL_CRT_FILE            ""
@@ -371,6 +375,22 @@ int main( void )
 #define USAGE_BADMAC_LIMIT ""
 #endif
 
+#if defined(MBEDTLS_SSL_KTLS)
+#define USAGE_KTLS \
+    "    ktls=0/1            default: 0 (records protected in user space)\n" \
+    "                        1: offload to the kernel after the handshake\n"
+#else
+#define USAGE_KTLS ""
+#endif /* MBEDTLS_SSL_KTLS */
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+#define USAGE_BUFFER_POOL \
+    "    buffer_pool=0/1     default: 0 (keep buffers for the whole connection)\n" \
+    "                        1: give them back to a pool when idle\n"
+#else
+#define USAGE_BUFFER_POOL ""
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 #define USAGE_DTLS \
     "    dtls=%%d             default: 0 (TLS)\n"                           \
@@ -461,6 +481,10 @@ int main( void )
     "    event=%%d            default: 0 (loop)\n"                            \
     "                        options: 1 (level-triggered, implies nbio=1),\n" \
     "    read_timeout=%%d     default: 0 ms (no timeout)\n"    \
+    "    read_ahead=0/1      default: (library default: off)\n"    \
+    "    send_vec=0/1        default: 0 (send each record separately)\n" \
+    USAGE_KTLS                                              \
+    USAGE_BUFFER_POOL                                       \
     "\n"                                                    \
     USAGE_DTLS                                              \
     USAGE_SRTP                                              \
@@ -545,6 +569,10 @@ struct options
     int nbio;                   /* should I/O be blocking?                  */
     int event;                  /* loop or event-driven IO? level or edge triggered? */
     uint32_t read_timeout;      /* timeout on mbedtls_ssl_read() in milliseconds    */
+    int read_ahead;             /* read past the current record (TLS)?      */
+    int send_vec;               /* send handshake flights with writev()?   */
+    int ktls;                   /* offload records to the kernel?           */
+    int buffer_pool;            /* release buffers of idle connections?     */
     int response_size;          /* pad response with header to requested size */
     uint16_t buffer_size;       /* IO buffer size */
     const char *ca_file;        /* the file with the CA certificate(s)      */
@@ -1285,6 +1313,9 @@ int main( int argc, char *argv[] )
     rng_context_t rng;
     mbedtls_ssl_context ssl;
     mbedtls_ssl_config conf;
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool buffer_pool;
+#endif
 #if defined(MBEDTLS_TIMING_C)
     mbedtls_timing_delay_context timer;
 #endif
@@ -1380,6 +1411,9 @@ int main( int argc, char *argv[] )
     mbedtls_net_init( &listen_fd );
     mbedtls_ssl_init( &ssl );
     mbedtls_ssl_config_init( &conf );
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool_init( &buffer_pool );
+#endif
     rng_init( &rng );
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     mbedtls_x509_crt_init( &cacert );
@@ -1464,6 +1498,10 @@ int main( int argc, char *argv[] )
     opt.cid_val             = DFL_CID_VALUE;
     opt.cid_val_renego      = DFL_CID_VALUE_RENEGO;
     opt.read_timeout        = DFL_READ_TIMEOUT;
+    opt.read_ahead          = DFL_READ_AHEAD;
+    opt.send_vec            = DFL_SEND_VEC;
+    opt.ktls                = DFL_KTLS;
+    opt.buffer_pool         = DFL_BUFFER_POOL;
     opt.ca_file             = DFL_CA_FILE;
     opt.ca_path             = DFL_CA_PATH;
     opt.crt_file            = DFL_CRT_FILE;
@@ -1573,6 +1611,34 @@ int main( int argc, char *argv[] )
         }
         else if( strcmp( p, "read_timeout" ) == 0 )
             opt.read_timeout = atoi( q );
+        else if( strcmp( p, "read_ahead" ) == 0 )
+        {
+            opt.read_ahead = atoi( q );
+            if( opt.read_ahead < 0 || opt.read_ahead > 1 )
+                goto usage;
+        }
+        else if( strcmp( p, "send_vec" ) == 0 )
+        {
+            opt.send_vec = atoi( q );
+            if( opt.send_vec < 0 || opt.send_vec > 1 )
+                goto usage;
+        }
+#if defined(MBEDTLS_SSL_KTLS)
+        else if( strcmp( p, "ktls" ) == 0 )
+        {
+            opt.ktls = atoi( q );
+            if( opt.ktls < 0 || opt.ktls > 1 )
+                goto usage;
+        }
+#endif
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+        else if( strcmp( p, "buffer_pool" ) == 0 )
+        {
+            opt.buffer_pool = atoi( q );
+            if( opt.buffer_pool < 0 || opt.buffer_pool > 1 )
+                goto usage;
+        }
+#endif
         else if( strcmp( p, "buffer_size" ) == 0 )
         {
             opt.buffer_size = atoi( q );
@@ -3022,8 +3088,13 @@ int main( int argc, char *argv[] )
 
     io_ctx.ssl = &ssl;
     io_ctx.net = &client_fd;
+#if defined(MBEDTLS_SSL_KTLS)
+    io_ctx.ktls_rx = 0;
+#endif
     mbedtls_ssl_set_bio( &ssl, &io_ctx, send_cb, recv_cb,
                          opt.nbio == 0 ? recv_timeout_cb : NULL );
+    if( opt.send_vec != 0 )
+        mbedtls_ssl_set_bio_vec( &ssl, send_vec_cb );
 
 #if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
     if( opt.transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
@@ -3080,6 +3151,9 @@ reset:
     mbedtls_net_free( &client_fd );
 
     mbedtls_ssl_session_reset( &ssl );
+#if defined(MBEDTLS_SSL_KTLS)
+    io_ctx.ktls_rx = 0;
+#endif
 
     /*
      * 3. Wait until a client connects
@@ -3117,6 +3191,16 @@ reset:
 
     mbedtls_ssl_conf_read_timeout( &conf, opt.read_timeout );
 
+    if( opt.read_ahead != DFL_READ_AHEAD )
+        mbedtls_ssl_conf_read_ahead( &conf, opt.read_ahead
+                                     ? MBEDTLS_SSL_READ_AHEAD_ENABLED
+                                     : MBEDTLS_SSL_READ_AHEAD_DISABLED );
+
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( opt.buffer_pool != 0 )
+        mbedtls_ssl_conf_buffer_pool( &conf, &buffer_pool );
+#endif
+
 #if defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY)
     if( opt.transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
     {
@@ -3235,6 +3319,16 @@ handshake:
     }
 #endif
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( opt.ktls != 0 )
+    {
+        int offloaded = ktls_offload( &io_ctx );
+        mbedtls_printf( "    [ Kernel TLS offload: tx %s, rx %s ]\n",
+                        ( offloaded & MBEDTLS_SSL_KTLS_TX ) ? "on" : "off",
+                        ( offloaded & MBEDTLS_SSL_KTLS_RX ) ? "on" : "off" );
+    }
+#endif
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     /*
      * 5. Verify the client certificate
@@ -3982,6 +4076,9 @@ exit:
 
     mbedtls_ssl_free( &ssl );
     mbedtls_ssl_config_free( &conf );
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    mbedtls_ssl_buffer_pool_free( &buffer_pool );
+#endif
     rng_free( &rng );
 
 #if defined(MBEDTLS_SSL_CACHE_C)
@@ -228,6 +228,11 @@ int recv_cb( void *ctx, unsigned char *buf, size_t len )
     size_t recv_len;
     int ret;
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( io_ctx->ktls_rx != 0 )
+        return( mbedtls_net_ktls_recv( io_ctx->net, buf, len ) );
+#endif
+
     if( opt.nbio == 2 )
         ret = delayed_recv( io_ctx->net, buf, len );
     else
@@ -257,6 +262,11 @@ int recv_timeout_cb( void *ctx, unsigned char *buf, size_t len,
     int ret;
     size_t recv_len;
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( io_ctx->ktls_rx != 0 )
+        return( mbedtls_net_ktls_recv( io_ctx->net, buf, len ) );
+#endif
+
     ret = mbedtls_net_recv_timeout( io_ctx->net, buf, len, timeout );
     if( ret < 0 )
         return( ret );
@@ -286,6 +296,50 @@ int send_cb( void *ctx, unsigned char const *buf, size_t len )
     return( mbedtls_net_send( io_ctx->net, buf, len ) );
 }
 
+int send_vec_cb( void *ctx, const mbedtls_ssl_iovec *iov, size_t iovcnt )
+{
+    io_ctx_t *io_ctx = (io_ctx_t*) ctx;
+
+    /* delayed_send() may send a prefix of the data, so the first buffer
+     * is enough */
+    if( opt.nbio == 2 )
+        return( delayed_send( io_ctx->net, iov[0].base, iov[0].len ) );
+
+    return( mbedtls_net_send_vec( io_ctx->net, iov, iovcnt ) );
+}
+
+#if defined(MBEDTLS_SSL_KTLS)
+/*
+ * Hand the record protection of each direction over to the kernel, if it
+ * supports it. Returns the directions that were offloaded.
+ */
+int ktls_offload( io_ctx_t *io_ctx )
+{
+    static const int directions[2] = { MBEDTLS_SSL_KTLS_TX,
+                                       MBEDTLS_SSL_KTLS_RX };
+    mbedtls_ssl_record_keys keys;
+    int offloaded = 0;
+    int i;
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( mbedtls_ssl_export_record_keys( io_ctx->ssl, directions[i],
+                                            &keys ) == 0 &&
+            mbedtls_net_ktls_enable( io_ctx->net, directions[i],
+                                     &keys ) == 0 &&
+            mbedtls_ssl_set_ktls( io_ctx->ssl, directions[i] ) == 0 )
+        {
+            offloaded |= directions[i];
+        }
+    }
+
+    mbedtls_platform_zeroize( &keys, sizeof( keys ) );
+    io_ctx->ktls_rx = ( offloaded & MBEDTLS_SSL_KTLS_RX ) != 0;
+
+    return( offloaded );
+}
+#endif /* MBEDTLS_SSL_KTLS */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 int ssl_sig_hashes_for_test[] = {
 #if defined(MBEDTLS_SHA512_C)
@@ -132,6 +132,7 @@ typedef struct
 {
     mbedtls_ssl_context *ssl;
     mbedtls_net_context *net;
+    int ktls_rx;                /* kernel decrypts the records we receive */
 } io_ctx_t;
 
 void my_debug( void *ctx, int level,
@@ -71,6 +71,7 @@ int main( void )
 #include "mbedtls/rsa.h"
 #include "mbedtls/dhm.h"
 #include "mbedtls/ecdsa.h"
+#include "mbedtls/ed25519.h"
 #include "mbedtls/ecdh.h"
 
 #include "mbedtls/error.h"
@@ -101,7 +102,7 @@ int main( void )
     "aes_cbc, aes_gcm, aes_ccm, aes_xts, chachapoly,\n"                 \
     "aes_cmac, des3_cmac, poly1305\n"                                   \
     "ctr_drbg, hmac_drbg\n"                                     \
-    "rsa, dhm, ecdsa, ecdh.\n"
+    "rsa, dhm, ecdsa, ed25519, ecdh.\n"
 
 #if defined(MBEDTLS_ERROR_C)
 #define PRINT_ERROR                                                     \
@@ -275,7 +276,7 @@ typedef struct {
          aria, camellia, blowfish, chacha20,
          poly1305,
          ctr_drbg, hmac_drbg,
-         rsa, dhm, ecdsa, ecdh;
+         rsa, dhm, ecdsa, ed25519, ecdh;
 } todo_list;
 
 
@@ -351,6 +352,8 @@ int main( int argc, char *argv[] )
                 todo.dhm = 1;
             else if( strcmp( argv[i], "ecdsa" ) == 0 )
                 todo.ecdsa = 1;
+            else if( strcmp( argv[i], "ed25519" ) == 0 )
+                todo.ed25519 = 1;
             else if( strcmp( argv[i], "ecdh" ) == 0 )
                 todo.ecdh = 1;
             else
@@ -882,6 +885,28 @@ int main( int argc, char *argv[] )
     }
 #endif
 
+#if defined(MBEDTLS_ED25519_C)
+    if( todo.ed25519 )
+    {
+        mbedtls_ed25519_context ed25519;
+
+        memset( buf, 0x2A, sizeof( buf ) );
+        mbedtls_ed25519_init( &ed25519 );
+
+        if( mbedtls_ed25519_genkey( &ed25519, myrand, NULL ) != 0 )
+            mbedtls_exit( 1 );
+
+        TIME_PUBLIC( "Ed25519", "sign",
+                ret = mbedtls_ed25519_sign( &ed25519, buf, 32, tmp ) );
+
+        TIME_PUBLIC( "Ed25519", "verify",
+                ret = mbedtls_ed25519_verify( &ed25519, buf, 32,
+                                              tmp, MBEDTLS_ED25519_SIG_SIZE ) );
+
+        mbedtls_ed25519_free( &ed25519 );
+    }
+#endif
+
 #if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     if( todo.ecdh )
     {
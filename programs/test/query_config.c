@@ -90,6 +90,7 @@
 #include "mbedtls/sha512.h"
 #include "mbedtls/ssl.h"
 #include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_cache_shm.h"
 #include "mbedtls/ssl_ciphersuites.h"
 #include "mbedtls/ssl_cookie.h"
 #include "mbedtls/ssl_internal.h"
@@ -1009,6 +1010,22 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECP_RESTARTABLE */
 
+#if defined(MBEDTLS_ECP_SHARED_TABLES)
+    if( strcmp( "MBEDTLS_ECP_SHARED_TABLES", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_SHARED_TABLES );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_SHARED_TABLES */
+
+#if defined(MBEDTLS_ECP_PUBKEY_TABLES)
+    if( strcmp( "MBEDTLS_ECP_PUBKEY_TABLES", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_PUBKEY_TABLES );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_PUBKEY_TABLES */
+
 #if defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     if( strcmp( "MBEDTLS_ECDH_LEGACY_CONTEXT", config ) == 0 )
     {
@@ -1273,6 +1290,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_RSA_NO_CRT */
 
+#if defined(MBEDTLS_RSA_PRIVATE_THREADS)
+    if( strcmp( "MBEDTLS_RSA_PRIVATE_THREADS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_RSA_PRIVATE_THREADS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_RSA_PRIVATE_THREADS */
+
 #if defined(MBEDTLS_SELF_TEST)
     if( strcmp( "MBEDTLS_SELF_TEST", config ) == 0 )
     {
@@ -1545,6 +1570,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_EXPORT_KEYS */
 
+#if defined(MBEDTLS_SSL_KTLS)
+    if( strcmp( "MBEDTLS_SSL_KTLS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_KTLS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_KTLS */
+
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     if( strcmp( "MBEDTLS_SSL_SERVER_NAME_INDICATION", config ) == 0 )
     {
@@ -1577,6 +1610,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL)
+    if( strcmp( "MBEDTLS_SSL_BUFFER_POOL", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_BUFFER_POOL );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_BUFFER_POOL */
+
 #if defined(MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN)
     if( strcmp( "MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN", config ) == 0 )
     {
@@ -1617,6 +1658,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_THREADING_PTHREAD */
 
+#if defined(MBEDTLS_THREADING_THREADS)
+    if( strcmp( "MBEDTLS_THREADING_THREADS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_THREADING_THREADS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_THREADING_THREADS */
+
 #if defined(MBEDTLS_USE_PSA_CRYPTO)
     if( strcmp( "MBEDTLS_USE_PSA_CRYPTO", config ) == 0 )
     {
@@ -1889,6 +1938,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECP_C */
 
+#if defined(MBEDTLS_ED25519_C)
+    if( strcmp( "MBEDTLS_ED25519_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ED25519_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ED25519_C */
+
 #if defined(MBEDTLS_ENTROPY_C)
     if( strcmp( "MBEDTLS_ENTROPY_C", config ) == 0 )
     {
@@ -2161,6 +2218,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_CACHE_C */
 
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    if( strcmp( "MBEDTLS_SSL_CACHE_SHM_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_CACHE_SHM_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_CACHE_SHM_C */
+
 #if defined(MBEDTLS_SSL_COOKIE_C)
     if( strcmp( "MBEDTLS_SSL_COOKIE_C", config ) == 0 )
     {
@@ -2169,6 +2234,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_COOKIE_C */
 
+#if defined(MBEDTLS_SSL_KEY_POOL_C)
+    if( strcmp( "MBEDTLS_SSL_KEY_POOL_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_KEY_POOL_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_KEY_POOL_C */
+
 #if defined(MBEDTLS_SSL_TICKET_C)
     if( strcmp( "MBEDTLS_SSL_TICKET_C", config ) == 0 )
     {
@@ -2401,6 +2474,22 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECP_FIXED_POINT_OPTIM */
 
+#if defined(MBEDTLS_RSA_GEN_KEY_THREADS)
+    if( strcmp( "MBEDTLS_RSA_GEN_KEY_THREADS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_RSA_GEN_KEY_THREADS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_RSA_GEN_KEY_THREADS */
+
+#if defined(MBEDTLS_RSA_BLINDING_POOL_SIZE)
+    if( strcmp( "MBEDTLS_RSA_BLINDING_POOL_SIZE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_RSA_BLINDING_POOL_SIZE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_RSA_BLINDING_POOL_SIZE */
+
 #if defined(MBEDTLS_ENTROPY_MAX_SOURCES)
     if( strcmp( "MBEDTLS_ENTROPY_MAX_SOURCES", config ) == 0 )
     {
@@ -2657,6 +2746,46 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES */
 
+#if defined(MBEDTLS_SSL_CACHE_SHARDS)
+    if( strcmp( "MBEDTLS_SSL_CACHE_SHARDS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_CACHE_SHARDS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_CACHE_SHARDS */
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT)
+    if( strcmp( "MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT */
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_MUTEXES)
+    if( strcmp( "MBEDTLS_SSL_CACHE_SHM_MUTEXES", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_CACHE_SHM_MUTEXES );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_CACHE_SHM_MUTEXES */
+
+#if defined(MBEDTLS_SSL_TICKET_MAX_KEYS)
+    if( strcmp( "MBEDTLS_SSL_TICKET_MAX_KEYS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_TICKET_MAX_KEYS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_TICKET_MAX_KEYS */
+
+#if defined(MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE)
+    if( strcmp( "MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_TICKET_CIPHER_POOL_SIZE */
+
 #if defined(MBEDTLS_SSL_MAX_CONTENT_LEN)
     if( strcmp( "MBEDTLS_SSL_MAX_CONTENT_LEN", config ) == 0 )
     {
@@ -2721,6 +2850,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_DTLS_MAX_BUFFERING */
 
+#if defined(MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE)
+    if( strcmp( "MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_BUFFER_POOL_DEFAULT_MAX_FREE */
+
 #if defined(MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME)
     if( strcmp( "MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME", config ) == 0 )
     {
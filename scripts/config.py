@@ -251,8 +251,11 @@ EXCLUDE_FROM_BAREMETAL = frozenset([
     'MBEDTLS_PSA_CRYPTO_SE_C', # requires a filesystem and PSA_CRYPTO_STORAGE_C
     'MBEDTLS_PSA_CRYPTO_STORAGE_C', # requires a filesystem
     'MBEDTLS_PSA_ITS_FILE_C', # requires a filesystem
+    'MBEDTLS_RSA_PRIVATE_THREADS', # requires a threading interface
+    'MBEDTLS_SSL_CACHE_SHM_C', # requires mmap() and POSIX record locks
     'MBEDTLS_THREADING_C', # requires a threading interface
     'MBEDTLS_THREADING_PTHREAD', # requires pthread
+    'MBEDTLS_THREADING_THREADS', # requires a threading interface
     'MBEDTLS_TIMING_C', # requires a clock
 ])
 
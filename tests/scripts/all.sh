@@ -922,6 +922,35 @@ component_test_rsa_no_crt () {
     if_build_succeeded tests/context-info.sh
 }
 
+component_test_rsa_blinding_pool () {
+    msg "build: Default + RSA_BLINDING_POOL_SIZE + THREADING_THREADS (ASan build)" # ~ 6 min
+    scripts/config.py set MBEDTLS_RSA_BLINDING_POOL_SIZE 4
+    scripts/config.py set MBEDTLS_THREADING_C
+    scripts/config.py set MBEDTLS_THREADING_PTHREAD
+    scripts/config.py set MBEDTLS_THREADING_THREADS
+    CC=gcc cmake -D CMAKE_BUILD_TYPE:String=Asan -D LINK_WITH_PTHREAD=ON .
+    make
+
+    msg "test: RSA_BLINDING_POOL_SIZE - main suites (inc. selftests) (ASan build)" # ~ 50s
+    make test
+
+    msg "test: RSA_BLINDING_POOL_SIZE - RSA-related part of ssl-opt.sh (ASan build)" # ~ 5s
+    if_build_succeeded tests/ssl-opt.sh -f RSA
+}
+
+component_test_rsa_gen_key_threads () {
+    msg "build: Default + RSA_GEN_KEY_THREADS + THREADING_THREADS (ASan build)" # ~ 6 min
+    scripts/config.py set MBEDTLS_RSA_GEN_KEY_THREADS 4
+    scripts/config.py set MBEDTLS_THREADING_C
+    scripts/config.py set MBEDTLS_THREADING_PTHREAD
+    scripts/config.py set MBEDTLS_THREADING_THREADS
+    CC=gcc cmake -D CMAKE_BUILD_TYPE:String=Asan -D LINK_WITH_PTHREAD=ON .
+    make
+
+    msg "test: RSA_GEN_KEY_THREADS - main suites (inc. selftests) (ASan build)" # ~ 50s
+    make test
+}
+
 component_test_no_ctr_drbg_classic () {
     msg "build: Full minus CTR_DRBG, classic crypto in TLS"
     scripts/config.py full
@@ -2720,6 +2720,183 @@ run_test    "CBC Record splitting: TLS 1.0, splitting, nbio" \
             -s "Read from client: 1 bytes read" \
             -s "122 bytes read"
 
+# Tests for read-ahead
+
+run_test    "Read-ahead: basic handshake" \
+            "$P_SRV read_ahead=1" \
+            "$P_CLI read_ahead=1" \
+            0 \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned" \
+            -c "Read from server: .* bytes read"
+
+run_test    "Read-ahead: TLS 1.0 split records" \
+            "$P_SRV read_ahead=1" \
+            "$P_CLI force_ciphersuite=TLS-RSA-WITH-AES-128-CBC-SHA \
+             request_size=123 force_version=tls1" \
+            0 \
+            -S "Read from client: 123 bytes read" \
+            -s "Read from client: 1 bytes read" \
+            -s "122 bytes read"
+
+run_test    "Read-ahead: TLS 1.0 split records, event-driven" \
+            "$P_SRV read_ahead=1 event=1" \
+            "$P_CLI force_ciphersuite=TLS-RSA-WITH-AES-128-CBC-SHA \
+             request_size=123 force_version=tls1" \
+            0 \
+            -S "Read from client: 123 bytes read" \
+            -s "Read from client: 1 bytes read" \
+            -s "122 bytes read"
+
+requires_config_enabled MBEDTLS_SSL_RENEGOTIATION
+run_test    "Read-ahead: renegotiation" \
+            "$P_SRV debug_level=3 read_ahead=1 exchanges=2 renegotiation=1" \
+            "$P_CLI debug_level=3 read_ahead=1 exchanges=2 renegotiation=1 \
+             renegotiate=1" \
+            0 \
+            -c "=> renegotiate" \
+            -s "=> renegotiate" \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned"
+
+# Tests for vectored sends
+
+run_test    "Vectored send: basic handshake" \
+            "$P_SRV debug_level=2 send_vec=1" \
+            "$P_CLI debug_level=2 send_vec=1" \
+            0 \
+            -s "record queued, 3 record(s) pending" \
+            -s "f_send_vec() returned" \
+            -c "record queued, 3 record(s) pending" \
+            -c "f_send_vec() returned" \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned"
+
+run_test    "Vectored send: non-blocking with delays" \
+            "$P_SRV nbio=2 send_vec=1" \
+            "$P_CLI nbio=2 send_vec=1" \
+            0 \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned" \
+            -c "Read from server: .* bytes read"
+
+run_test    "Vectored send: session resumption" \
+            "$P_SRV debug_level=3 send_vec=1 tickets=0" \
+            "$P_CLI debug_level=3 send_vec=1 tickets=0 reconnect=1" \
+            0 \
+            -s "session successfully restored from cache" \
+            -c "a session has been resumed" \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned"
+
+requires_config_enabled MBEDTLS_SSL_RENEGOTIATION
+run_test    "Vectored send: renegotiation" \
+            "$P_SRV debug_level=3 send_vec=1 exchanges=2 renegotiation=1" \
+            "$P_CLI debug_level=3 send_vec=1 exchanges=2 renegotiation=1 \
+             renegotiate=1" \
+            0 \
+            -c "=> renegotiate" \
+            -s "=> renegotiate" \
+            -S "mbedtls_ssl_handshake returned" \
+            -C "mbedtls_ssl_handshake returned"
+
+requires_config_enabled MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+run_test    "Vectored send: write longer than the fragment length" \
+            "$P_SRV debug_level=3 send_vec=1 response_size=4096" \
+            "$P_CLI max_frag_len=512" \
+            0 \
+            -s "Maximum output fragment length is 512" \
+            -s "record queued, 7 record(s) pending" \
+            -s "4096 bytes written in 1 fragments" \
+            -C "mbedtls_ssl_read returned"
+
+requires_config_enabled MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+run_test    "Vectored send: write longer than the fragment length, nbio" \
+            "$P_SRV nbio=2 send_vec=1 response_size=4096" \
+            "$P_CLI nbio=2 max_frag_len=512" \
+            0 \
+            -s "4096 bytes written in 1 fragments" \
+            -C "mbedtls_ssl_read returned"
+
+# Tests for kernel TLS offload
+# The kernel may lack the "tls" ULP, in which case the connection must keep
+# working with the record layer in user space.
+
+requires_config_enabled MBEDTLS_SSL_KTLS
+run_test    "kTLS: offload or fall back, AES-128-GCM" \
+            "$P_SRV ktls=1" \
+            "$P_CLI ktls=1 force_ciphersuite=TLS-ECDHE-RSA-WITH-AES-128-GCM-SHA256" \
+            0 \
+            -s "Kernel TLS offload: tx" \
+            -c "Kernel TLS offload: tx" \
+            -s "Read from client: .* bytes read" \
+            -c "Read from server: .* bytes read"
+
+requires_config_enabled MBEDTLS_SSL_KTLS
+run_test    "kTLS: CBC suite stays in user space" \
+            "$P_SRV ktls=1" \
+            "$P_CLI ktls=1 force_ciphersuite=TLS-ECDHE-RSA-WITH-AES-128-CBC-SHA256" \
+            0 \
+            -s "Kernel TLS offload: tx off, rx off" \
+            -c "Kernel TLS offload: tx off, rx off" \
+            -c "Read from server: .* bytes read"
+
+# Tests for the shared record-buffer pool
+
+requires_config_enabled MBEDTLS_SSL_BUFFER_POOL
+run_test    "Buffer pool: basic" \
+            "$P_SRV debug_level=2 buffer_pool=1" \
+            "$P_CLI debug_level=2 buffer_pool=1" \
+            0 \
+            -s "input buffer given to the pool" \
+            -s "input buffer taken from the pool" \
+            -c "input buffer given to the pool" \
+            -c "output buffer taken from the pool" \
+            -s "bytes read" \
+            -c "bytes read"
+
+requires_config_enabled MBEDTLS_SSL_BUFFER_POOL
+run_test    "Buffer pool: non-blocking I/O" \
+            "$P_SRV debug_level=2 buffer_pool=1 nbio=2" \
+            "$P_CLI debug_level=2 buffer_pool=1 nbio=2" \
+            0 \
+            -s "input buffer given to the pool" \
+            -c "input buffer given to the pool" \
+            -s "bytes read" \
+            -c "bytes read"
+
+requires_config_enabled MBEDTLS_SSL_BUFFER_POOL
+requires_config_enabled MBEDTLS_SSL_RENEGOTIATION
+run_test    "Buffer pool: renegotiation" \
+            "$P_SRV debug_level=2 buffer_pool=1 exchanges=2 renegotiation=1" \
+            "$P_CLI debug_level=2 buffer_pool=1 exchanges=2 renegotiation=1 renegotiate=1" \
+            0 \
+            -c "=> renegotiate" \
+            -s "=> renegotiate" \
+            -s "input buffer given to the pool" \
+            -c "input buffer given to the pool" \
+            -s "bytes read" \
+            -c "bytes read"
+
+requires_config_enabled MBEDTLS_SSL_BUFFER_POOL
+run_test    "Buffer pool: session resumption" \
+            "$P_SRV debug_level=3 buffer_pool=1 tickets=0" \
+            "$P_CLI debug_level=3 buffer_pool=1 tickets=0 reconnect=1" \
+            0 \
+            -c "a session has been resumed" \
+            -s "a session has been resumed" \
+            -s "input buffer given to the pool" \
+            -c "bytes read"
+
+requires_config_enabled MBEDTLS_SSL_BUFFER_POOL
+run_test    "Buffer pool: large application data" \
+            "$P_SRV debug_level=2 buffer_pool=1" \
+            "$P_CLI debug_level=2 buffer_pool=1 request_size=16384" \
+            0 \
+            -s "input buffer given to the pool" \
+            -s "16384 bytes read" \
+            -c "bytes read"
+
 # Tests for Session Tickets
 
 run_test    "Session resume using tickets: basic" \
@@ -5210,6 +5387,57 @@ run_test    "ALPN: both, no common" \
             -S "Application Layer Protocol is 1234"
 
 
+# Tests for Ed25519 server certificates (RFC 8422)
+# ed25519-self.crt is issued to "Ed25519 Test", so the name check fails
+
+requires_config_enabled MBEDTLS_ED25519_C
+requires_config_enabled MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+requires_config_enabled MBEDTLS_SSL_PROTO_TLS1_2
+run_test    "Ed25519: ECDHE-ECDSA with an Ed25519 certificate" \
+            "$P_SRV debug_level=3 crt_file=data_files/ed25519-self.crt \
+             key_file=data_files/ed25519.key" \
+            "$P_CLI debug_level=3 ca_file=data_files/ed25519-self.crt \
+             auth_mode=optional \
+             force_ciphersuite=TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256" \
+            0 \
+            -s "signature_algorithm ext: ed25519" \
+            -S "certificate mismatch" \
+            -c "Server used ed25519" \
+            -C "bad server key exchange message" \
+            -C "mbedtls_pk_verify() returned" \
+            -C "is not correctly signed by the trusted CA" \
+            -c "does not match with the expected CN" \
+            -c "Ciphersuite is TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256"
+
+requires_config_enabled MBEDTLS_ED25519_C
+requires_config_enabled MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+requires_config_enabled MBEDTLS_SSL_PROTO_TLS1_2
+requires_config_enabled MBEDTLS_SSL_KEEP_PEER_CERTIFICATE
+run_test    "Ed25519: ECDHE-ECDSA with an Ed25519 certificate, reconnect" \
+            "$P_SRV debug_level=3 crt_file=data_files/ed25519-self.crt \
+             key_file=data_files/ed25519.key" \
+            "$P_CLI debug_level=3 ca_file=data_files/ed25519-self.crt \
+             auth_mode=optional reconnect=1 \
+             force_ciphersuite=TLS-ECDHE-ECDSA-WITH-AES-256-GCM-SHA384" \
+            0 \
+            -s "signature_algorithm ext: ed25519" \
+            -c "Server used ed25519" \
+            -c "a session has been resumed" \
+            -c "Ciphersuite is TLS-ECDHE-ECDSA-WITH-AES-256-GCM-SHA384"
+
+requires_config_enabled MBEDTLS_ED25519_C
+requires_config_enabled MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+requires_config_enabled MBEDTLS_SSL_PROTO_TLS1_1
+run_test    "Ed25519: no signature_algorithms before TLS 1.2 -> fail" \
+            "$P_SRV debug_level=3 crt_file=data_files/ed25519-self.crt \
+             key_file=data_files/ed25519.key" \
+            "$P_CLI debug_level=3 force_version=tls1_1 \
+             force_ciphersuite=TLS-ECDHE-ECDSA-WITH-AES-128-CBC-SHA" \
+            1 \
+            -S "signature_algorithm ext: ed25519" \
+            -s "certificate mismatch: key type" \
+            -C "Server used ed25519"
+
 # Tests for keyUsage in leaf certificates, part 1:
 # server-side certificate/suite selection
 